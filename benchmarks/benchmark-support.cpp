@@ -0,0 +1,33 @@
+/*
+Substitutos mínimos para o que o plugin-main.cpp fornece ao plugin, para que
+as fontes do plugin possam ser ligadas ao executável de benchmarks sem o OBS.
+*/
+
+#include <obs-module.h>
+
+#include "plugin-support.h"
+
+OBS_DECLARE_MODULE()
+
+class NightbotDock;
+NightbotDock *g_dock_widget = nullptr;
+
+const char *get_obs_text(const char *key)
+{
+	return key;
+}
+
+void obs_log_info(const char *format, ...)
+{
+	(void)format;
+}
+
+void obs_log_warning(const char *format, ...)
+{
+	(void)format;
+}
+
+void obs_log_error(const char *format, ...)
+{
+	(void)format;
+}
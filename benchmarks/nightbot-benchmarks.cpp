@@ -0,0 +1,251 @@
+#include <benchmark/benchmark.h>
+
+#include <QApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include "SettingsManager.h"
+#include "fair-queue.h"
+#include "nightbot-api.h"
+#include "nightbot-dock.h"
+#include "nightbot-session.h"
+#include "now-playing-format.h"
+#include "queue-eta.h"
+#include "request-history.h"
+#include "song-queue.h"
+
+#include <algorithm>
+#include <vector>
+
+// Monta uma resposta de GET /1/song_requests/queue com a música atual e `count` pedidos.
+static QByteArray MakeQueuePayload(int count, int idOffset = 0)
+{
+	auto makeSong = [](int index, int position) {
+		QJsonObject track;
+		track["title"] = QStringLiteral("Synthetic Song %1 (Official Video)").arg(index);
+		track["artist"] = QStringLiteral("Artist %1").arg(index % 97);
+		track["duration"] = 120 + (index % 300);
+		track["provider"] = "youtube";
+		track["providerId"] = QStringLiteral("vid%1").arg(index, 8, 10, QLatin1Char('0'));
+
+		QJsonObject user;
+		user["displayName"] = QStringLiteral("viewer_%1").arg(index % 211);
+		user["name"] = QStringLiteral("viewer_%1").arg(index % 211);
+
+		QJsonObject song;
+		song["_id"] = QStringLiteral("song-%1").arg(index);
+		song["_position"] = position;
+		song["track"] = track;
+		song["user"] = user;
+		return song;
+	};
+
+	QJsonArray queue;
+	for (int i = 1; i <= count; ++i)
+		queue.append(makeSong(idOffset + i, i));
+
+	QJsonObject root;
+	root["_requestsEnabled"] = true;
+	root["_currentSong"] = makeSong(idOffset, 0);
+	root["queue"] = queue;
+	return QJsonDocument(root).toJson(QJsonDocument::Compact);
+}
+
+static QList<SongItem> MakeQueue(int count, int idOffset = 0)
+{
+	SongQueueParseResult result;
+	ParseSongQueue(MakeQueuePayload(count, idOffset), "Playlist", result);
+	return result.queue;
+}
+
+static void BM_ParseSongQueue(benchmark::State &state)
+{
+	const QByteArray payload = MakeQueuePayload(static_cast<int>(state.range(0)));
+
+	for (auto _ : state) {
+		SongQueueParseResult result;
+		bool ok = ParseSongQueue(payload, "Playlist", result);
+		benchmark::DoNotOptimize(ok);
+		benchmark::DoNotOptimize(result.queue.size());
+	}
+
+	state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * payload.size());
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_ParseSongQueue)->RangeMultiplier(10)->Range(10, 10000)->Unit(benchmark::kMicrosecond);
+
+static void BM_SortSongQueue(benchmark::State &state)
+{
+	QList<SongItem> shuffled = MakeQueue(static_cast<int>(state.range(0)));
+	std::reverse(shuffled.begin(), shuffled.end());
+
+	for (auto _ : state) {
+		QList<SongItem> queue = shuffled;
+		queue.detach();
+		SortSongQueue(queue);
+		benchmark::DoNotOptimize(queue.data());
+	}
+
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_SortSongQueue)->RangeMultiplier(10)->Range(10, 10000)->Unit(benchmark::kMicrosecond);
+
+static void BM_DiffSongQueue_Unchanged(benchmark::State &state)
+{
+	const QList<SongItem> previous = MakeQueue(static_cast<int>(state.range(0)));
+	const QList<SongItem> current = previous;
+
+	for (auto _ : state) {
+		SongQueueDiff diff = DiffSongQueue(previous, current);
+		benchmark::DoNotOptimize(diff.moved);
+	}
+
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_DiffSongQueue_Unchanged)->RangeMultiplier(10)->Range(10, 10000)->Unit(benchmark::kMicrosecond);
+
+static void BM_DiffSongQueue_Advanced(benchmark::State &state)
+{
+	// A fila andou uma música e chegou um pedido novo no fim.
+	const QList<SongItem> previous = MakeQueue(static_cast<int>(state.range(0)));
+	const QList<SongItem> current = MakeQueue(static_cast<int>(state.range(0)), 1);
+
+	for (auto _ : state) {
+		SongQueueDiff diff = DiffSongQueue(previous, current);
+		benchmark::DoNotOptimize(diff.added.size());
+	}
+
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_DiffSongQueue_Advanced)->RangeMultiplier(10)->Range(10, 10000)->Unit(benchmark::kMicrosecond);
+
+static void BM_RenderNowPlaying(benchmark::State &state)
+{
+	NowPlayingFormat format;
+	format.Compile("Now Playing: {music} - {artist} | requested by {user} ({time})");
+	const SongItem song = MakeQueue(1).first();
+
+	for (auto _ : state) {
+		QString text = format.Render(song);
+		benchmark::DoNotOptimize(text.data());
+	}
+}
+BENCHMARK(BM_RenderNowPlaying);
+
+static void BM_CompileNowPlayingFormat(benchmark::State &state)
+{
+	const QString pattern = "Now Playing: {music} - {artist} | requested by {user} ({time})";
+
+	for (auto _ : state) {
+		NowPlayingFormat format;
+		format.Compile(pattern);
+		benchmark::DoNotOptimize(&format);
+	}
+}
+BENCHMARK(BM_CompileNowPlayingFormat);
+
+static void BM_QueueEtaAdvance(benchmark::State &state)
+{
+	// Cada passo: a fila anda uma música e chega um pedido novo no fim, o caso de toda troca de música.
+	const int count = static_cast<int>(state.range(0));
+	std::vector<QList<SongItem>> steps;
+	for (int offset = 0; offset < 16; ++offset)
+		steps.push_back(MakeQueue(count, offset));
+
+	QueueEta eta;
+	eta.Update(steps[0], 0);
+	size_t next = 1;
+	for (auto _ : state) {
+		if (next == steps.size()) {
+			state.PauseTiming();
+			eta.Update(steps[0], 0);
+			next = 1;
+			state.ResumeTiming();
+		}
+		const size_t changedFrom = eta.Update(steps[next++], 0);
+		benchmark::DoNotOptimize(changedFrom);
+		benchmark::DoNotOptimize(eta.TotalRemainingSeconds(0));
+	}
+
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_QueueEtaAdvance)->RangeMultiplier(10)->Range(10, 10000)->Unit(benchmark::kMicrosecond);
+
+static void BM_FairQueuePlan(benchmark::State &state)
+{
+	// Uma leitura com um pedido novo no fim: ordem alvo e plano de promoções para as próximas 10.
+	const QList<SongItem> queue = MakeQueue(static_cast<int>(state.range(0)));
+	QStringList waiting;
+	for (const SongItem &item : queue) {
+		if (item.position != 0)
+			waiting << item.id;
+	}
+
+	for (auto _ : state) {
+		const QStringList plan = FairQueue::PlanPromotions(waiting, FairQueue::TargetOrder(queue), 10);
+		benchmark::DoNotOptimize(plan.size());
+	}
+
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_FairQueuePlan)->RangeMultiplier(10)->Range(10, 10000)->Unit(benchmark::kMicrosecond);
+
+// Índice com `range(0)` entradas no formato das músicas vistas na fila.
+static void BM_HistorySuggest(benchmark::State &state)
+{
+	HistoryIndex index;
+	const int count = static_cast<int>(state.range(0));
+	for (int i = 0; i < count; ++i)
+		index.Add(QStringLiteral("https://youtu.be/vid%1").arg(i, 8, 10, QLatin1Char('0')),
+			  QStringLiteral("Synthetic Song %1 (Official Video) - Artist %2").arg(i).arg(i % 997), 0, i);
+
+	// Prefixo curto, texto no meio e um erro de digitação.
+	const QString queries[] = {"sy", "song 4242", "synthtic song 99"};
+	size_t next = 0;
+	for (auto _ : state) {
+		auto result = index.Suggest(queries[next++ % 3], 8);
+		benchmark::DoNotOptimize(result.data());
+	}
+}
+BENCHMARK(BM_HistorySuggest)->RangeMultiplier(10)->Range(1000, 100000)->Unit(benchmark::kMicrosecond);
+
+static void BM_DockUpdateSongQueue(benchmark::State &state)
+{
+	// Alterna entre duas filas diferentes para que cada iteração reconstrua a tabela.
+	const QList<SongItem> queues[2] = {
+		MakeQueue(static_cast<int>(state.range(0))),
+		MakeQueue(static_cast<int>(state.range(0)), 1),
+	};
+
+	NightbotDock dock;
+	dock.resize(480, 640);
+	size_t index = 0;
+
+	for (auto _ : state) {
+		// Mesmo caminho do plugin: o sinal da API entrega a fila ao dock.
+		emit NightbotAPI::get().songQueueFetched(queues[index++ & 1]);
+		QApplication::processEvents();
+	}
+
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_DockUpdateSongQueue)->RangeMultiplier(10)->Range(10, 1000)->Unit(benchmark::kMillisecond);
+
+int main(int argc, char **argv)
+{
+	if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+		qputenv("QT_QPA_PLATFORM", "offscreen");
+
+	QApplication app(argc, argv);
+	SettingsManager::get().Load();
+	SessionManager::get().Load();
+
+	benchmark::Initialize(&argc, argv);
+	if (benchmark::ReportUnrecognizedArguments(argc, argv))
+		return 1;
+
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+	return 0;
+}
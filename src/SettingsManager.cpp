@@ -1,11 +1,32 @@
 #include "SettingsManager.h"
 #include <obs-module.h>
 #include "plugin-support.h"
+#include "trace-recorder.h"
+#include "ui-stall-detector.h"
+
+#include <QTimer>
+#include <QThreadPool>
 
 static const char *SETTINGS_FILE_NAME = "settings.json";
 
+static const char *DEFAULT_API_BASE_URL = "https://api.nightbot.tv";
+static const char *DEFAULT_BACKEND_BASE_URL = "https://nightbot-obs.areaz12server.net.br";
+
+// Janela em que várias alterações seguidas são agrupadas em uma única gravação.
+static const int SAVE_COALESCE_MS = 750;
+
 static SettingsManager *s_instance = nullptr;
 
+// Permite apontar o plugin para outro servidor (ex.: o mock local) sem mexer no settings.json.
+static std::string ResolveBaseUrl(const char *envName, const char *configured, const char *fallback)
+{
+	QByteArray env = qgetenv(envName);
+	std::string url = !env.isEmpty() ? env.toStdString() : ((configured && *configured) ? configured : fallback);
+	while (!url.empty() && url.back() == '/')
+		url.pop_back();
+	return url;
+}
+
 SettingsManager &SettingsManager::get()
 {
 	if (!s_instance)
@@ -24,15 +45,40 @@ void FreeSettingsManager()
 SettingsManager::~SettingsManager()
 {
 	if (settings) {
-		Save();
+		Flush();
+		obs_log_info("[Nightbot SR/Settings] Config written %llu time(s) this session.",
+			     (unsigned long long)writeCount.load());
 		obs_data_release(settings);
 		settings = nullptr;
 	}
+
+	delete flushTimer;
+	flushTimer = nullptr;
+	delete saveThread;
+	saveThread = nullptr;
 }
 
 void SettingsManager::Load()
 {
-    this->settings = obs_data_create_from_json_file(obs_module_config_path(SETTINGS_FILE_NAME));
+	char *config_path_c = obs_module_config_path(SETTINGS_FILE_NAME);
+	configPath = config_path_c ? config_path_c : "";
+	bfree(config_path_c);
+
+	if (!flushTimer) {
+		flushTimer = new QTimer();
+		flushTimer->setSingleShot(true);
+		flushTimer->setInterval(SAVE_COALESCE_MS);
+		QObject::connect(flushTimer, &QTimer::timeout, [this]() { FlushAsync(); });
+	}
+
+	if (!saveThread) {
+		// Uma única thread mantém as gravações em ordem.
+		saveThread = new QThreadPool();
+		saveThread->setMaxThreadCount(1);
+	}
+
+	std::unique_lock<std::mutex> lock(settingsMutex);
+	this->settings = configPath.empty() ? nullptr : obs_data_create_from_json_file_safe(configPath.c_str(), "bak");
 
 	if (!settings) {
         obs_log_info("[Nightbot SR/Settings] No config found. Creating new one...");
@@ -48,6 +94,24 @@ void SettingsManager::Load()
 		obs_data_set_bool(settings, Setting::NowPlayingToFileEnabled, false);
 		obs_data_set_string(settings, Setting::NowPlayingToFilePath, "");
 	}
+
+	// Chaves adicionadas depois da primeira versão recebem valores padrão.
+	obs_data_set_default_int(settings, Setting::PollIdleMultiplier, 3);
+	obs_data_set_default_bool(settings, Setting::PollPauseWhenHidden, true);
+	obs_data_set_default_int(settings, Setting::MetricsPort, 0);
+	obs_data_set_default_int(settings, Setting::UiStallThresholdMs, 4);
+	obs_data_set_default_bool(settings, Setting::NetworkDebugLog, false);
+	obs_data_set_default_bool(settings, Setting::ModerationEnabled, false);
+	obs_data_set_default_bool(settings, Setting::ModerationAutoDelete, false);
+	obs_data_set_default_int(settings, Setting::ModerationMaxDuration, 0);
+	obs_data_set_default_int(settings, Setting::ModerationMaxPerUser, 0);
+	obs_data_set_default_bool(settings, Setting::ModerationBlockDuplicates, false);
+	obs_data_set_default_int(settings, Setting::ModerationCooldown, 0);
+	obs_data_set_default_bool(settings, Setting::FairQueueEnabled, false);
+	obs_data_set_default_int(settings, Setting::FairQueueWindow, 5);
+	lock.unlock();
+
+	PublishSnapshot();
 }
 
 void SettingsManager::Save()
@@ -57,33 +121,152 @@ void SettingsManager::Save()
 		return;
     }
 
-    const char *config_path_c = obs_module_config_path(SETTINGS_FILE_NAME);
-	if (!config_path_c) {
+	dirty = true;
+
+	if (!flushTimer)
+		return;
+
+	// Pode ser chamado de qualquer thread (ex.: renovação de token no pool da API);
+	// o timer vive na thread da UI.
+	QMetaObject::invokeMethod(flushTimer, [this]() {
+		if (!flushTimer->isActive())
+			flushTimer->start();
+	});
+}
+
+void SettingsManager::Flush()
+{
+	if (flushTimer)
+		flushTimer->stop();
+	if (saveThread)
+		saveThread->waitForDone();
+
+	if (!settings || !dirty.exchange(false))
+		return;
+
+	UI_SLOT_SCOPE("SettingsManager::Flush");
+	obs_data_t *snapshot = CloneSettings();
+	WriteToDisk(snapshot);
+	obs_data_release(snapshot);
+}
+
+uint64_t SettingsManager::GetWriteCount() const
+{
+	return writeCount.load();
+}
+
+std::shared_ptr<const SettingsSnapshot> SettingsManager::GetSnapshot() const
+{
+	return std::atomic_load(&snapshot);
+}
+
+void SettingsManager::PublishSnapshot()
+{
+	TRACE_SCOPE("PublishSnapshot", "settings");
+	UI_SLOT_SCOPE("SettingsManager::PublishSnapshot");
+	auto next = std::make_shared<SettingsSnapshot>();
+	{
+		std::lock_guard<std::mutex> lock(settingsMutex);
+		if (!settings)
+			return;
+
+		const char *format = obs_data_get_string(settings, Setting::NowPlayingFormat);
+
+		next->version = std::atomic_load(&snapshot)->version + 1;
+		next->userName = obs_data_get_string(settings, Setting::UserName);
+		next->autoRefreshEnabled = obs_data_get_bool(settings, Setting::AutoRefreshEnabled);
+		next->autoRefreshInterval = static_cast<int>(obs_data_get_int(settings, Setting::AutoRefreshInterval));
+		next->nowPlayingSource = obs_data_get_string(settings, Setting::NowPlayingSource);
+		next->nowPlayingFormat = (format && *format) ? QString::fromUtf8(format)
+							     : QStringLiteral("Now Playing: {music} - {artist}");
+		next->nowPlayingToFileEnabled = obs_data_get_bool(settings, Setting::NowPlayingToFileEnabled);
+		next->nowPlayingToFilePath = QString::fromUtf8(obs_data_get_string(settings, Setting::NowPlayingToFilePath));
+		next->pollIdleMultiplier = static_cast<int>(obs_data_get_int(settings, Setting::PollIdleMultiplier));
+		next->pollPauseWhenHidden = obs_data_get_bool(settings, Setting::PollPauseWhenHidden);
+		next->apiBaseUrl = ResolveBaseUrl("NIGHTBOT_SR_API_BASE_URL",
+						  obs_data_get_string(settings, Setting::ApiBaseUrl), DEFAULT_API_BASE_URL);
+		next->backendBaseUrl = ResolveBaseUrl("NIGHTBOT_SR_BACKEND_BASE_URL",
+						      obs_data_get_string(settings, Setting::BackendBaseUrl),
+						      DEFAULT_BACKEND_BASE_URL);
+		next->pushUrl = ResolveBaseUrl("NIGHTBOT_SR_PUSH_URL", obs_data_get_string(settings, Setting::PushUrl), "");
+		next->metricsPort = static_cast<int>(obs_data_get_int(settings, Setting::MetricsPort));
+		next->uiStallThresholdMs = static_cast<int>(obs_data_get_int(settings, Setting::UiStallThresholdMs));
+		next->networkDebugLog = obs_data_get_bool(settings, Setting::NetworkDebugLog);
+
+		ModerationSettings &moderation = next->moderation;
+		moderation.enabled = obs_data_get_bool(settings, Setting::ModerationEnabled);
+		moderation.autoDelete = obs_data_get_bool(settings, Setting::ModerationAutoDelete);
+		moderation.bannedWords =
+			QString::fromUtf8(obs_data_get_string(settings, Setting::ModerationBannedWords));
+		moderation.bannedArtists =
+			QString::fromUtf8(obs_data_get_string(settings, Setting::ModerationBannedArtists));
+		moderation.maxDuration = static_cast<int>(obs_data_get_int(settings, Setting::ModerationMaxDuration));
+		moderation.maxPerUser = static_cast<int>(obs_data_get_int(settings, Setting::ModerationMaxPerUser));
+		moderation.blockDuplicates = obs_data_get_bool(settings, Setting::ModerationBlockDuplicates);
+		moderation.cooldownMinutes = static_cast<int>(obs_data_get_int(settings, Setting::ModerationCooldown));
+		next->fairQueue.enabled = obs_data_get_bool(settings, Setting::FairQueueEnabled);
+		next->fairQueue.window = static_cast<int>(obs_data_get_int(settings, Setting::FairQueueWindow));
+
+		std::atomic_store(&snapshot, std::shared_ptr<const SettingsSnapshot>(std::move(next)));
+	}
+
+	emit snapshotChanged();
+}
+
+void SettingsManager::FlushAsync()
+{
+	UI_SLOT_SCOPE("SettingsManager::FlushAsync");
+	if (!settings || !dirty.exchange(false))
+		return;
+
+	obs_data_t *snapshot = CloneSettings();
+	saveThread->start([this, snapshot]() {
+		WriteToDisk(snapshot);
+		obs_data_release(snapshot);
+	});
+}
+
+obs_data_t *SettingsManager::CloneSettings()
+{
+	std::lock_guard<std::mutex> lock(settingsMutex);
+	obs_data_t *snapshot = obs_data_create();
+	obs_data_apply(snapshot, settings);
+	return snapshot;
+}
+
+void SettingsManager::WriteToDisk(obs_data_t *data)
+{
+	TRACE_SCOPE("WriteSettings", "io");
+	if (configPath.empty()) {
 		obs_log_error("[Nightbot SR/Settings] Could not get config path for saving.");
 		return;
 	}
 
-    QString path = QString::fromUtf8(config_path_c);
+    QString path = QString::fromStdString(configPath);
 	QFileInfo info(path);
 	QDir dir = info.dir();
 
 	if (!dir.exists())
 		dir.mkpath(".");
 
-	if (obs_data_save_json(settings, config_path_c)) {
-		obs_log_info("[Nightbot SR/Settings] Config saved to: %s", config_path_c);
+	// Grava em um arquivo temporário e renomeia, para nunca deixar um settings.json pela metade.
+	if (obs_data_save_json_safe(data, configPath.c_str(), "tmp", "bak")) {
+		writeCount++;
+		obs_log_info("[Nightbot SR/Settings] Config saved to: %s", configPath.c_str());
 	} else {
-		obs_log_warning("[Nightbot SR/Settings] Failed to save config to: %s", config_path_c);
+		obs_log_warning("[Nightbot SR/Settings] Failed to save config to: %s", configPath.c_str());
 	}
 }
 
 void SettingsManager::SetAccessToken(const std::string &token)
 {
+	std::lock_guard<std::mutex> lock(settingsMutex);
 	obs_data_set_string(settings, Setting::AccessToken, token.c_str());
 }
 
 std::string SettingsManager::GetAccessToken()
 {
+	std::lock_guard<std::mutex> lock(settingsMutex);
 	if (!settings)
 		return "";
 
@@ -93,11 +276,13 @@ std::string SettingsManager::GetAccessToken()
 
 void SettingsManager::SetRefreshToken(const std::string &token)
 {
+	std::lock_guard<std::mutex> lock(settingsMutex);
 	obs_data_set_string(settings, Setting::RefreshToken, token.c_str());
 }
 
 std::string SettingsManager::GetRefreshToken()
 {
+	std::lock_guard<std::mutex> lock(settingsMutex);
 	if (!settings)
 		return "";
 
@@ -107,96 +292,275 @@ std::string SettingsManager::GetRefreshToken()
 
 void SettingsManager::SetUserName(const std::string &name)
 {
-	obs_data_set_string(settings, Setting::UserName, name.c_str());
+	{
+		std::lock_guard<std::mutex> lock(settingsMutex);
+		obs_data_set_string(settings, Setting::UserName, name.c_str());
+	}
+	PublishSnapshot();
 	Save();
 }
 
 std::string SettingsManager::GetNightUserName()
 {
-	if (!settings)
-		return "";
-
-	const char *value = obs_data_get_string(settings, Setting::UserName);
-	return (value) ? value : "";
+	return GetSnapshot()->userName;
 }
 
 bool SettingsManager::GetAutoRefreshEnabled()
 {
-	return obs_data_get_bool(settings, Setting::AutoRefreshEnabled);
+	return GetSnapshot()->autoRefreshEnabled;
 }
 
 void SettingsManager::SetAutoRefreshInterval(int interval)
 {
-	obs_data_set_int(settings, Setting::AutoRefreshInterval, interval);
+	{
+		std::lock_guard<std::mutex> lock(settingsMutex);
+		obs_data_set_int(settings, Setting::AutoRefreshInterval, interval);
+	}
+	PublishSnapshot();
 	Save();
 }
 
 int SettingsManager::GetAutoRefreshInterval()
 {
-	return static_cast<int>(obs_data_get_int(settings, Setting::AutoRefreshInterval));
+	return GetSnapshot()->autoRefreshInterval;
 }
 
 void SettingsManager::SetAutoRefreshEnabled(bool enabled)
 {
-	obs_data_set_bool(settings, Setting::AutoRefreshEnabled, enabled);
+	{
+		std::lock_guard<std::mutex> lock(settingsMutex);
+		obs_data_set_bool(settings, Setting::AutoRefreshEnabled, enabled);
+	}
+	PublishSnapshot();
 	Save();
 }
 
 void SettingsManager::SetNowPlayingSource(const std::string &sourceName)
 {
-	obs_data_set_string(settings, Setting::NowPlayingSource, sourceName.c_str());
+	{
+		std::lock_guard<std::mutex> lock(settingsMutex);
+		obs_data_set_string(settings, Setting::NowPlayingSource, sourceName.c_str());
+	}
+	PublishSnapshot();
 	Save();
 }
 
 std::string SettingsManager::GetNowPlayingSource()
 {
-	const char *value =
-		obs_data_get_string(settings, Setting::NowPlayingSource);
-	return (value) ? value : "";
+	return GetSnapshot()->nowPlayingSource;
 }
 
 void SettingsManager::SetNowPlayingFormat(const std::string &format)
 {
-	obs_data_set_string(settings, Setting::NowPlayingFormat, format.c_str());
+	{
+		std::lock_guard<std::mutex> lock(settingsMutex);
+		obs_data_set_string(settings, Setting::NowPlayingFormat, format.c_str());
+	}
+	PublishSnapshot();
 	Save();
 }
 
 std::string SettingsManager::GetNowPlayingFormat()
 {
-	const char *value =
-		obs_data_get_string(settings, Setting::NowPlayingFormat);
-	return (value && *value) ? value : "Now Playing: {music} - {artist}";
+	return GetSnapshot()->nowPlayingFormat.toStdString();
 }
 
 void SettingsManager::SetNowPlayingToFileEnabled(bool enabled)
 {
-	obs_data_set_bool(settings, Setting::NowPlayingToFileEnabled, enabled);
+	{
+		std::lock_guard<std::mutex> lock(settingsMutex);
+		obs_data_set_bool(settings, Setting::NowPlayingToFileEnabled, enabled);
+	}
+	PublishSnapshot();
 	Save();
 }
 
 bool SettingsManager::GetNowPlayingToFileEnabled()
 {
-	return obs_data_get_bool(settings, Setting::NowPlayingToFileEnabled);
+	return GetSnapshot()->nowPlayingToFileEnabled;
 }
 
 void SettingsManager::SetNowPlayingToFilePath(const std::string &path)
 {
-	obs_data_set_string(settings, Setting::NowPlayingToFilePath, path.c_str());
+	{
+		std::lock_guard<std::mutex> lock(settingsMutex);
+		obs_data_set_string(settings, Setting::NowPlayingToFilePath, path.c_str());
+	}
+	PublishSnapshot();
 	Save();
 }
 
 std::string SettingsManager::GetNowPlayingToFilePath()
 {
-	const char *value = obs_data_get_string(settings, Setting::NowPlayingToFilePath);
+	return GetSnapshot()->nowPlayingToFilePath.toStdString();
+}
+
+void SettingsManager::SetPollIdleMultiplier(int multiplier)
+{
+	{
+		std::lock_guard<std::mutex> lock(settingsMutex);
+		obs_data_set_int(settings, Setting::PollIdleMultiplier, multiplier);
+	}
+	PublishSnapshot();
+	Save();
+}
+
+int SettingsManager::GetPollIdleMultiplier()
+{
+	return GetSnapshot()->pollIdleMultiplier;
+}
+
+void SettingsManager::SetPollPauseWhenHidden(bool enabled)
+{
+	{
+		std::lock_guard<std::mutex> lock(settingsMutex);
+		obs_data_set_bool(settings, Setting::PollPauseWhenHidden, enabled);
+	}
+	PublishSnapshot();
+	Save();
+}
+
+bool SettingsManager::GetPollPauseWhenHidden()
+{
+	return GetSnapshot()->pollPauseWhenHidden;
+}
+
+void SettingsManager::SetApiBaseUrl(const std::string &url)
+{
+	{
+		std::lock_guard<std::mutex> lock(settingsMutex);
+		obs_data_set_string(settings, Setting::ApiBaseUrl, url.c_str());
+	}
+	PublishSnapshot();
+	Save();
+}
+
+std::string SettingsManager::GetApiBaseUrl()
+{
+	return GetSnapshot()->apiBaseUrl;
+}
+
+void SettingsManager::SetBackendBaseUrl(const std::string &url)
+{
+	{
+		std::lock_guard<std::mutex> lock(settingsMutex);
+		obs_data_set_string(settings, Setting::BackendBaseUrl, url.c_str());
+	}
+	PublishSnapshot();
+	Save();
+}
+
+std::string SettingsManager::GetBackendBaseUrl()
+{
+	return GetSnapshot()->backendBaseUrl;
+}
+
+void SettingsManager::SetMetricsPort(int port)
+{
+	{
+		std::lock_guard<std::mutex> lock(settingsMutex);
+		obs_data_set_int(settings, Setting::MetricsPort, port);
+	}
+	PublishSnapshot();
+	Save();
+}
+
+int SettingsManager::GetMetricsPort()
+{
+	return GetSnapshot()->metricsPort;
+}
+
+void SettingsManager::SetUiStallThresholdMs(int thresholdMs)
+{
+	{
+		std::lock_guard<std::mutex> lock(settingsMutex);
+		obs_data_set_int(settings, Setting::UiStallThresholdMs, thresholdMs);
+	}
+	PublishSnapshot();
+	Save();
+}
+
+int SettingsManager::GetUiStallThresholdMs()
+{
+	return GetSnapshot()->uiStallThresholdMs;
+}
+
+void SettingsManager::SetNetworkDebugLog(bool enabled)
+{
+	{
+		std::lock_guard<std::mutex> lock(settingsMutex);
+		obs_data_set_bool(settings, Setting::NetworkDebugLog, enabled);
+	}
+	PublishSnapshot();
+	Save();
+}
+
+void SettingsManager::SetModeration(const ModerationSettings &moderation)
+{
+	{
+		std::lock_guard<std::mutex> lock(settingsMutex);
+		obs_data_set_bool(settings, Setting::ModerationEnabled, moderation.enabled);
+		obs_data_set_bool(settings, Setting::ModerationAutoDelete, moderation.autoDelete);
+		obs_data_set_string(settings, Setting::ModerationBannedWords,
+				    moderation.bannedWords.toUtf8().constData());
+		obs_data_set_string(settings, Setting::ModerationBannedArtists,
+				    moderation.bannedArtists.toUtf8().constData());
+		obs_data_set_int(settings, Setting::ModerationMaxDuration, moderation.maxDuration);
+		obs_data_set_int(settings, Setting::ModerationMaxPerUser, moderation.maxPerUser);
+		obs_data_set_bool(settings, Setting::ModerationBlockDuplicates, moderation.blockDuplicates);
+		obs_data_set_int(settings, Setting::ModerationCooldown, moderation.cooldownMinutes);
+	}
+	PublishSnapshot();
+	Save();
+}
+
+void SettingsManager::SetFairQueue(const FairQueueSettings &fairQueue)
+{
+	{
+		std::lock_guard<std::mutex> lock(settingsMutex);
+		obs_data_set_bool(settings, Setting::FairQueueEnabled, fairQueue.enabled);
+		obs_data_set_int(settings, Setting::FairQueueWindow, fairQueue.window);
+	}
+	PublishSnapshot();
+	Save();
+}
+
+obs_data_array_t *SettingsManager::GetExtraSessions() const
+{
+	std::lock_guard<std::mutex> lock(settingsMutex);
+	return settings ? obs_data_get_array(settings, Setting::ExtraSessions) : nullptr;
+}
+
+void SettingsManager::SetExtraSessions(obs_data_array_t *sessions)
+{
+	std::lock_guard<std::mutex> lock(settingsMutex);
+	obs_data_set_array(settings, Setting::ExtraSessions, sessions);
+}
+
+std::string SettingsManager::GetActiveSession()
+{
+	std::lock_guard<std::mutex> lock(settingsMutex);
+	if (!settings)
+		return "";
+
+	const char *value = obs_data_get_string(settings, Setting::ActiveSession);
 	return (value) ? value : "";
 }
 
+void SettingsManager::SetActiveSession(const std::string &id)
+{
+	std::lock_guard<std::mutex> lock(settingsMutex);
+	obs_data_set_string(settings, Setting::ActiveSession, id.c_str());
+}
+
 obs_data_array_t *SettingsManager::GetHotkeyData(const char *key) const
 {
+	std::lock_guard<std::mutex> lock(settingsMutex);
 	return obs_data_get_array(settings, key);
 }
 
 void SettingsManager::SetHotkeyData(const char *key, obs_data_array_t *hotkeyArray)
 {
+	std::lock_guard<std::mutex> lock(settingsMutex);
 	obs_data_set_array(settings, key, hotkeyArray);
 }
@@ -1,13 +1,21 @@
 #ifndef SETTINGS_MANAGER_H
 #define SETTINGS_MANAGER_H
 
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <obs.h>
 
+#include <QObject>
 #include <QString>
 #include <QFileInfo>
 #include <QDir>
 
+class QTimer;
+class QThreadPool;
+
 namespace Setting {
 	inline const char *AccessToken = "access_token";
 	inline const char *RefreshToken = "refresh_token";
@@ -18,14 +26,113 @@ namespace Setting {
 	inline const char *NowPlayingFormat = "now_playing_format";
 	inline const char *NowPlayingToFileEnabled = "now_playing_to_file_enabled";
 	inline const char *NowPlayingToFilePath = "now_playing_to_file_path";
+	inline const char *PollIdleMultiplier = "poll_idle_multiplier";
+	inline const char *PollPauseWhenHidden = "poll_pause_when_hidden";
+	inline const char *ApiBaseUrl = "api_base_url";
+	inline const char *BackendBaseUrl = "backend_base_url";
+	inline const char *MetricsPort = "metrics_port";
+	inline const char *UiStallThresholdMs = "ui_stall_threshold_ms";
+	inline const char *NetworkDebugLog = "network_debug_log";
+	inline const char *PushUrl = "push_url";
+	inline const char *ExtraSessions = "extra_sessions";
+	inline const char *ActiveSession = "active_session";
+	inline const char *ModerationEnabled = "moderation_enabled";
+	inline const char *ModerationAutoDelete = "moderation_auto_delete";
+	inline const char *ModerationBannedWords = "moderation_banned_words";
+	inline const char *ModerationBannedArtists = "moderation_banned_artists";
+	inline const char *ModerationMaxDuration = "moderation_max_duration";
+	inline const char *ModerationMaxPerUser = "moderation_max_per_user";
+	inline const char *ModerationBlockDuplicates = "moderation_block_duplicates";
+	inline const char *ModerationCooldown = "moderation_cooldown";
+	inline const char *FairQueueEnabled = "fair_queue_enabled";
+	inline const char *FairQueueWindow = "fair_queue_window";
 } // namespace Setting
 
-class SettingsManager {
+// Regras aplicadas a cada pedido novo na fila (ver ModerationEngine).
+struct ModerationSettings {
+	bool enabled = false;
+	// Apaga da fila; sem isso o pedido só fica marcado no dock.
+	bool autoDelete = false;
+	// Uma palavra ou expressão por linha; casam palavras inteiras, sem diferenciar acentos.
+	QString bannedWords;
+	QString bannedArtists;
+	// Segundos; 0 = sem limite.
+	int maxDuration = 0;
+	// Pedidos de uma mesma pessoa na fila; 0 = sem limite.
+	int maxPerUser = 0;
+	bool blockDuplicates = false;
+	// Minutos depois de tocar em que a música não pode ser pedida de novo; 0 = desligado.
+	int cooldownMinutes = 0;
+
+	bool operator==(const ModerationSettings &other) const
+	{
+		return enabled == other.enabled && autoDelete == other.autoDelete && bannedWords == other.bannedWords &&
+		       bannedArtists == other.bannedArtists && maxDuration == other.maxDuration &&
+		       maxPerUser == other.maxPerUser && blockDuplicates == other.blockDuplicates &&
+		       cooldownMinutes == other.cooldownMinutes;
+	}
+	bool operator!=(const ModerationSettings &other) const { return !(*this == other); }
+};
+
+// Reordenação automática da fila em rodízio entre quem pediu (ver FairQueue).
+struct FairQueueSettings {
+	bool enabled = false;
+	// Quantas das próximas músicas são mantidas na ordem justa; limita as promoções por leitura.
+	int window = 5;
+
+	bool operator==(const FairQueueSettings &other) const
+	{
+		return enabled == other.enabled && window == other.window;
+	}
+	bool operator!=(const FairQueueSettings &other) const { return !(*this == other); }
+};
+
+// Cópia imutável e tipada das configurações lidas em caminhos quentes.
+// Uma nova instância é publicada a cada alteração; quem a lê nunca trava nem aloca.
+struct SettingsSnapshot {
+	uint64_t version = 0;
+	std::string userName;
+	bool autoRefreshEnabled = true;
+	int autoRefreshInterval = 5;
+	std::string nowPlayingSource;
+	QString nowPlayingFormat;
+	bool nowPlayingToFileEnabled = false;
+	QString nowPlayingToFilePath;
+	int pollIdleMultiplier = 3;
+	bool pollPauseWhenHidden = true;
+	// Já resolvidos (variável de ambiente > settings.json > padrão), sem "/" no final.
+	std::string apiBaseUrl;
+	std::string backendBaseUrl;
+	// Endpoint SSE de avisos de mudança na fila; vazio = só polling.
+	std::string pushUrl;
+	// Porta do endpoint /metrics em 127.0.0.1; 0 = desligado.
+	int metricsPort = 0;
+	// Slots do plugin na thread da UI acima disso vão para o log; 0 = não registrar.
+	int uiStallThresholdMs = 4;
+	// Uma linha no log do OBS por requisição à API (método, caminho, status, tempo).
+	bool networkDebugLog = false;
+	ModerationSettings moderation;
+	FairQueueSettings fairQueue;
+};
+
+class SettingsManager : public QObject {
+	Q_OBJECT
+
 public:
 	static SettingsManager &get();
 	~SettingsManager();
 	void Load();
+
+	// Marca as configurações como alteradas. A gravação em disco é feita
+	// depois de uma pequena janela, fora da thread da UI.
 	void Save();
+	// Grava imediatamente (e de forma síncrona) se houver alterações pendentes.
+	// Deve ser chamado na thread da UI.
+	void Flush();
+	uint64_t GetWriteCount() const;
+
+	// Pode ser chamado de qualquer thread.
+	std::shared_ptr<const SettingsSnapshot> GetSnapshot() const;
 
 	void SetAccessToken(const std::string &token);
 	std::string GetAccessToken();
@@ -45,6 +152,28 @@ public:
 	bool GetNowPlayingToFileEnabled();
 	void SetNowPlayingToFilePath(const std::string &path);
 	std::string GetNowPlayingToFilePath();
+	void SetPollIdleMultiplier(int multiplier);
+	int GetPollIdleMultiplier();
+	void SetPollPauseWhenHidden(bool enabled);
+	bool GetPollPauseWhenHidden();
+	void SetApiBaseUrl(const std::string &url);
+	std::string GetApiBaseUrl();
+	void SetBackendBaseUrl(const std::string &url);
+	std::string GetBackendBaseUrl();
+	void SetMetricsPort(int port);
+	int GetMetricsPort();
+	void SetUiStallThresholdMs(int thresholdMs);
+	int GetUiStallThresholdMs();
+	void SetNetworkDebugLog(bool enabled);
+	// Todas as regras de uma vez: a aba de moderação grava o conjunto inteiro.
+	void SetModeration(const ModerationSettings &moderation);
+	void SetFairQueue(const FairQueueSettings &fairQueue);
+
+	// Contas além da principal: [{id, user_name, access_token, refresh_token}]. Quem chama libera o array.
+	obs_data_array_t *GetExtraSessions() const;
+	void SetExtraSessions(obs_data_array_t *sessions);
+	std::string GetActiveSession();
+	void SetActiveSession(const std::string &id);
 
 	void SetHotkeyData(const char *key, obs_data_array_t *hotkeyArray);
 	obs_data_array_t *GetHotkeyData(const char *key) const;
@@ -52,10 +181,28 @@ public:
 	SettingsManager(SettingsManager const &) = delete;
 	void operator=(SettingsManager const &) = delete;
 
+signals:
+	// Emitido depois que um novo SettingsSnapshot é publicado.
+	void snapshotChanged();
+
 private:
 	SettingsManager() = default;
 
+	void PublishSnapshot();
+
+	void FlushAsync();
+	obs_data_t *CloneSettings();
+	void WriteToDisk(obs_data_t *data);
+
 	obs_data_t *settings = nullptr;
+	mutable std::mutex settingsMutex;
+	std::string configPath;
+	std::shared_ptr<const SettingsSnapshot> snapshot = std::make_shared<SettingsSnapshot>();
+
+	std::atomic<bool> dirty{false};
+	std::atomic<uint64_t> writeCount{0};
+	QTimer *flushTimer = nullptr;
+	QThreadPool *saveThread = nullptr;
 };
 
 #endif // SETTINGS_MANAGER_H
@@ -0,0 +1,248 @@
+#include "api-scheduler.h"
+#include "trace-recorder.h"
+#include "plugin-support.h"
+
+#include <util/platform.h>
+
+#include <QStringList>
+#include <QThread>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+ApiRateLimit::ApiRateLimit(double ratePerSecond, double burst)
+	: ratePerSecond(ratePerSecond),
+	  burst(burst),
+	  tokens(burst)
+{
+}
+
+bool ApiRateLimit::Ready(uint64_t nowNs, uint64_t &readyAtNs)
+{
+	if (nowNs < blockedUntilNs) {
+		readyAtNs = blockedUntilNs;
+		return false;
+	}
+
+	if (lastRefillNs != 0 && nowNs > lastRefillNs)
+		tokens = std::min(burst, tokens + static_cast<double>(nowNs - lastRefillNs) / 1e9 * ratePerSecond);
+	lastRefillNs = nowNs;
+
+	if (tokens >= 1.0)
+		return true;
+
+	readyAtNs = nowNs + static_cast<uint64_t>((1.0 - tokens) / ratePerSecond * 1e9);
+	return false;
+}
+
+void ApiRateLimit::Take()
+{
+	tokens -= 1.0;
+}
+
+ApiScheduler &ApiScheduler::get()
+{
+	static ApiScheduler instance;
+	return instance;
+}
+
+const char *ApiScheduler::LaneName(Lane lane)
+{
+	return lane == Lane::Interactive ? "interactive" : "background";
+}
+
+const ApiScheduler::LaneStats &ApiScheduler::Stats(Lane lane) const
+{
+	return lane == Lane::Interactive ? interactiveStats : backgroundStats;
+}
+
+ApiScheduler::LaneStats &ApiScheduler::MutableStats(Lane lane)
+{
+	return lane == Lane::Interactive ? interactiveStats : backgroundStats;
+}
+
+void ApiScheduler::Submit(Lane lane, const char *name, std::function<void()> task, bool coalesce,
+			  std::shared_ptr<ApiRateLimit> limit)
+{
+	LaneStats &stats = MutableStats(lane);
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (stopping)
+			return;
+		if (workers.empty())
+			StartWorkers();
+
+		stats.submitted.fetch_add(1, std::memory_order_relaxed);
+		std::deque<Task> &queue = lane == Lane::Interactive ? interactive : background;
+
+		// A tarefa na fila ainda não começou: basta trocar o que ela vai executar.
+		// Mantém o horário original para o aging e a espera medida continuarem corretos.
+		if (coalesce) {
+			auto it = std::find_if(queue.begin(), queue.end(), [name, &limit](const Task &queued) {
+				return queued.limit == limit && std::strcmp(queued.name, name) == 0;
+			});
+			if (it != queue.end()) {
+				it->run = std::move(task);
+				stats.coalesced.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+		}
+
+		const uint64_t traceQueuedNs = TraceRecorder::Enabled() ? TraceRecorder::NowNs() : 0;
+		queue.push_back({name, lane, os_gettime_ns(), traceQueuedNs, std::move(limit), std::move(task)});
+		stats.queued.fetch_add(1, std::memory_order_relaxed);
+	}
+	wake.notify_one();
+}
+
+void ApiScheduler::StartWorkers()
+{
+	for (int i = 0; i < WORKER_COUNT; i++) {
+		QThread *worker = QThread::create([this]() { WorkerLoop(); });
+		worker->setObjectName("Nightbot API");
+		worker->start();
+		workers.push_back(worker);
+	}
+}
+
+void ApiScheduler::Throttle(const std::shared_ptr<ApiRateLimit> &limit, int delayMs)
+{
+	if (!limit)
+		return;
+
+	std::lock_guard<std::mutex> lock(mutex);
+	const uint64_t until = os_gettime_ns() + static_cast<uint64_t>(delayMs) * 1000000;
+	limit->blockedUntilNs = std::max(limit->blockedUntilNs, until);
+}
+
+bool ApiScheduler::TakeNextTask(uint64_t nowNs, Task &task, uint64_t &wakeAtNs)
+{
+	wakeAtNs = UINT64_MAX;
+	auto findReady = [nowNs, &wakeAtNs](std::deque<Task> &queue) {
+		for (auto it = queue.begin(); it != queue.end(); ++it) {
+			uint64_t readyAtNs = UINT64_MAX;
+			if (!it->limit || it->limit->Ready(nowNs, readyAtNs))
+				return it;
+			wakeAtNs = std::min(wakeAtNs, readyAtNs);
+		}
+		return queue.end();
+	};
+
+	auto backgroundIt = backgroundRunning < WORKER_COUNT - RESERVED_INTERACTIVE ? findReady(background)
+										  : background.end();
+	auto interactiveIt = findReady(interactive);
+	const bool hasBackground = backgroundIt != background.end();
+	const bool hasInteractive = interactiveIt != interactive.end();
+	if (!hasBackground && !hasInteractive)
+		return false;
+
+	const bool backgroundAged = hasBackground && nowNs - backgroundIt->queuedNs >= BACKGROUND_AGING_NS;
+	const bool pickBackground = hasBackground && (!hasInteractive || backgroundAged);
+	std::deque<Task> &queue = pickBackground ? background : interactive;
+	auto it = pickBackground ? backgroundIt : interactiveIt;
+
+	task = std::move(*it);
+	queue.erase(it);
+	if (task.limit)
+		task.limit->Take();
+	if (task.lane == Lane::Background)
+		backgroundRunning++;
+	return true;
+}
+
+void ApiScheduler::WorkerLoop()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	for (;;) {
+		if (stopping)
+			return;
+
+		const uint64_t startNs = os_gettime_ns();
+		Task task;
+		uint64_t wakeAtNs;
+		if (!TakeNextTask(startNs, task, wakeAtNs)) {
+			if (wakeAtNs == UINT64_MAX)
+				wake.wait(lock);
+			else
+				wake.wait_for(lock, std::chrono::nanoseconds(wakeAtNs - startNs));
+			continue;
+		}
+		LaneStats &stats = MutableStats(task.lane);
+		stats.queued.fetch_sub(1, std::memory_order_relaxed);
+		stats.running.fetch_add(1, std::memory_order_relaxed);
+		lock.unlock();
+
+		const uint64_t waitUs = (startNs - task.queuedNs) / 1000;
+		stats.waitUs.Record(waitUs);
+		stats.waitUsSum.fetch_add(waitUs, std::memory_order_relaxed);
+		if (task.traceQueuedNs && TraceRecorder::Enabled())
+			TraceRecorder::get().Async(task.name,
+						   task.lane == Lane::Interactive ? "wait.interactive" : "wait.background",
+						   task.traceQueuedNs, TraceRecorder::NowNs());
+		{
+			TRACE_SCOPE(task.name, "api");
+			task.run();
+		}
+		task.run = nullptr;
+
+		stats.running.fetch_sub(1, std::memory_order_relaxed);
+		stats.completed.fetch_add(1, std::memory_order_relaxed);
+
+		lock.lock();
+		if (task.lane == Lane::Background) {
+			backgroundRunning--;
+			// Uma vaga de background abriu: acorda quem estava esperando por ela.
+			if (!background.empty())
+				wake.notify_all();
+		}
+	}
+}
+
+void ApiScheduler::Shutdown()
+{
+	std::vector<QThread *> joining;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (stopping)
+			return;
+		stopping = true;
+		interactiveStats.queued.store(0, std::memory_order_relaxed);
+		backgroundStats.queued.store(0, std::memory_order_relaxed);
+		interactive.clear();
+		background.clear();
+		joining.swap(workers);
+	}
+	wake.notify_all();
+
+	if (joining.empty())
+		return;
+
+	obs_log_info("[Nightbot SR/API] Waiting for threads to finish...");
+	for (QThread *worker : joining) {
+		worker->wait();
+		delete worker;
+	}
+	obs_log_info("[Nightbot SR/API] Threads finished.");
+}
+
+QString ApiScheduler::Report() const
+{
+	QStringList lines;
+	for (Lane lane : {Lane::Interactive, Lane::Background}) {
+		const LaneStats &stats = Stats(lane);
+		QString line = QString("  %1: %2 tasks (%3 coalesced), %4 queued, %5 running")
+				       .arg(QString::fromLatin1(LaneName(lane)), -11)
+				       .arg(stats.submitted.load(std::memory_order_relaxed))
+				       .arg(stats.coalesced.load(std::memory_order_relaxed))
+				       .arg(stats.queued.load(std::memory_order_relaxed))
+				       .arg(stats.running.load(std::memory_order_relaxed));
+		if (stats.waitUs.Count() > 0)
+			line += QString(", wait p50 %1 ms  p95 %2 ms  p99 %3 ms")
+					.arg(static_cast<double>(stats.waitUs.Percentile(50)) / 1000.0, 0, 'f', 2)
+					.arg(static_cast<double>(stats.waitUs.Percentile(95)) / 1000.0, 0, 'f', 2)
+					.arg(static_cast<double>(stats.waitUs.Percentile(99)) / 1000.0, 0, 'f', 2);
+		lines << line;
+	}
+	return lines.join('\n') + '\n';
+}
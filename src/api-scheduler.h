@@ -0,0 +1,115 @@
+#ifndef API_SCHEDULER_H
+#define API_SCHEDULER_H
+
+#include "transport-stats.h"
+
+#include <QString>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class QThread;
+
+// Token bucket de uma conta do Nightbot. Todas as tarefas da conta, nas duas faixas,
+// gastam do mesmo balde; só o ApiScheduler lê e altera, sob o mutex dele.
+class ApiRateLimit {
+public:
+	ApiRateLimit(double ratePerSecond, double burst);
+
+private:
+	friend class ApiScheduler;
+
+	// Se não houver ficha agora, devolve em readyAtNs quando haverá.
+	bool Ready(uint64_t nowNs, uint64_t &readyAtNs);
+	void Take();
+
+	double ratePerSecond;
+	double burst;
+	double tokens;
+	uint64_t lastRefillNs = 0;
+	// Depois de um 429 a conta inteira espera, independentemente das fichas.
+	uint64_t blockedUntilNs = 0;
+};
+
+// Executor das chamadas à API com duas faixas:
+//  - Interactive: comandos do usuário (hotkeys, botões do dock, volume).
+//  - Background: consultas periódicas e leituras que ninguém está esperando.
+// Uma parte das threads nunca pega tarefas de background, então um comando não fica
+// atrás de consultas travadas numa rede lenta. Tarefas de background que esperam demais
+// passam na frente das interativas (aging), para não morrerem de fome.
+// Cada tarefa pode levar o limite da conta que a enviou: uma conta sem fichas não segura
+// a fila das outras, o scheduler pula para a próxima tarefa pronta.
+class ApiScheduler {
+public:
+	enum class Lane { Interactive, Background };
+
+	static constexpr int WORKER_COUNT = 4;
+	static constexpr int RESERVED_INTERACTIVE = 1;
+	static constexpr uint64_t BACKGROUND_AGING_NS = 2000ull * 1000 * 1000;
+
+	struct LaneStats {
+		LatencyHistogram waitUs;
+		std::atomic<uint64_t> waitUsSum{0};
+		std::atomic<uint64_t> submitted{0};
+		std::atomic<uint64_t> coalesced{0};
+		std::atomic<uint64_t> completed{0};
+		std::atomic<int64_t> queued{0};
+		std::atomic<int64_t> running{0};
+	};
+
+	static ApiScheduler &get();
+
+	// "name" precisa ser literal (vai para o trace). Com "coalesce", uma tarefa de mesmo nome
+	// e mesma conta que ainda esteja na fila da faixa é substituída em vez de enfileirar outra.
+	void Submit(Lane lane, const char *name, std::function<void()> task, bool coalesce = false,
+		    std::shared_ptr<ApiRateLimit> limit = nullptr);
+	// Suspende as tarefas da conta por um tempo (resposta 429).
+	void Throttle(const std::shared_ptr<ApiRateLimit> &limit, int delayMs);
+	// Descarta o que está na fila e espera as tarefas em execução terminarem.
+	void Shutdown();
+
+	const LaneStats &Stats(Lane lane) const;
+	static const char *LaneName(Lane lane);
+	QString Report() const;
+
+	ApiScheduler(const ApiScheduler &) = delete;
+	ApiScheduler &operator=(const ApiScheduler &) = delete;
+
+private:
+	ApiScheduler() = default;
+
+	struct Task {
+		const char *name;
+		Lane lane;
+		uint64_t queuedNs;
+		// Relógio do TraceRecorder; 0 quando o trace estava desligado no envio.
+		uint64_t traceQueuedNs;
+		std::shared_ptr<ApiRateLimit> limit;
+		std::function<void()> run;
+	};
+
+	void StartWorkers();
+	void WorkerLoop();
+	// Escolhe a próxima tarefa pronta; sem nenhuma, wakeAtNs diz quando uma conta terá fichas.
+	bool TakeNextTask(uint64_t nowNs, Task &task, uint64_t &wakeAtNs);
+	LaneStats &MutableStats(Lane lane);
+
+	mutable std::mutex mutex;
+	std::condition_variable wake;
+	std::deque<Task> interactive;
+	std::deque<Task> background;
+	int backgroundRunning = 0;
+	bool stopping = false;
+	std::vector<QThread *> workers;
+
+	LaneStats interactiveStats;
+	LaneStats backgroundStats;
+};
+
+#endif // API_SCHEDULER_H
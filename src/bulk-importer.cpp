@@ -0,0 +1,245 @@
+#include "bulk-importer.h"
+#include "nightbot-api.h"
+#include "nightbot-session.h"
+#include "request-history.h"
+#include "plugin-support.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QTimer>
+
+#include <vector>
+
+// Um arquivo maior que isso quase certamente não é uma lista de músicas.
+static const int IMPORT_MAX_ITEMS = 1000;
+
+// Primeira coluna de uma linha CSV, com suporte a aspas ("a, b" e "" como aspas literais).
+static QString FirstCsvField(const QString &line)
+{
+	if (!line.startsWith('"'))
+		return line.section(',', 0, 0);
+
+	QString field;
+	for (qsizetype i = 1; i < line.size(); ++i) {
+		const QChar c = line.at(i);
+		if (c != '"') {
+			field += c;
+		} else if (i + 1 < line.size() && line.at(i + 1) == '"') {
+			field += '"';
+			++i;
+		} else {
+			break;
+		}
+	}
+	return field;
+}
+
+BulkImporter &BulkImporter::get()
+{
+	static BulkImporter instance;
+	return instance;
+}
+
+BulkImporter::BulkImporter() : QObject(nullptr), progressTimer(new QTimer(this))
+{
+	progressTimer->setInterval(PROGRESS_INTERVAL_MS);
+	connect(progressTimer, &QTimer::timeout, this, [this]() {
+		if (dirty.exchange(false))
+			emit progressChanged();
+	});
+}
+
+QStringList BulkImporter::ParseFile(const QString &path, QString *error)
+{
+	QFile file(path);
+	if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+		if (error)
+			*error = file.errorString();
+		return {};
+	}
+
+	const bool csv = QFileInfo(path).suffix().compare("csv", Qt::CaseInsensitive) == 0;
+	QStringList queries;
+	QTextStream in(&file);
+	while (!in.atEnd() && queries.size() < IMPORT_MAX_ITEMS) {
+		QString line = in.readLine().trimmed();
+		if (csv)
+			line = FirstCsvField(line).trimmed();
+		if (!line.isEmpty() && !line.startsWith('#'))
+			queries << line;
+	}
+
+	if (!in.atEnd())
+		obs_log_warning("[Nightbot SR/Import] '%s' has more than %d entries; the rest was ignored.",
+				path.toUtf8().constData(), IMPORT_MAX_ITEMS);
+	return queries;
+}
+
+bool BulkImporter::Start(const QStringList &queries)
+{
+	auto target = SessionManager::get().Active();
+	if (queries.isEmpty() || !target->IsAuthenticated())
+		return false;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (running || inFlight > 0)
+			return false;
+
+		items.clear();
+		for (const QString &query : queries)
+			items.append({query});
+		nextIndex = 0;
+		running = true;
+		session = target;
+	}
+
+	obs_log_info("[Nightbot SR/Import] Importing %d song(s) into account %s.", static_cast<int>(queries.size()),
+		     target->Id().c_str());
+	dirty = true;
+	progressTimer->start();
+	Pump();
+	return true;
+}
+
+void BulkImporter::Cancel()
+{
+	bool idle;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (!running)
+			return;
+		running = false;
+		idle = inFlight == 0;
+	}
+
+	obs_log_info("[Nightbot SR/Import] Import cancelled; waiting for requests already sent.");
+	dirty = true;
+	if (idle) {
+		progressTimer->stop();
+		emit progressChanged();
+		emit finished();
+	}
+}
+
+void BulkImporter::Resume(bool retryFailed)
+{
+	bool hasPending = false;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (running || inFlight > 0)
+			return;
+
+		for (Item &item : items) {
+			if (retryFailed && item.state == ItemState::Failed) {
+				item.state = ItemState::Pending;
+				item.error.clear();
+			}
+			hasPending = hasPending || item.state == ItemState::Pending;
+		}
+		nextIndex = 0;
+		running = hasPending;
+	}
+
+	if (!hasPending)
+		return;
+
+	obs_log_info("[Nightbot SR/Import] Resuming import.");
+	dirty = true;
+	progressTimer->start();
+	Pump();
+}
+
+void BulkImporter::Pump()
+{
+	std::vector<std::pair<qsizetype, QString>> launching;
+	std::shared_ptr<NightbotSession> target;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (!running)
+			return;
+
+		while (inFlight < IMPORT_CONCURRENCY && nextIndex < items.size()) {
+			Item &item = items[nextIndex];
+			if (item.state == ItemState::Pending) {
+				item.state = ItemState::InFlight;
+				inFlight++;
+				launching.emplace_back(nextIndex, item.query);
+			}
+			nextIndex++;
+		}
+		target = session;
+	}
+
+	for (const auto &[index, query] : launching)
+		NightbotAPI::get().AddSongFor(target, query, [this, index = index](bool success, const QString &error) {
+			OnItemDone(index, success, error);
+		});
+}
+
+void BulkImporter::OnItemDone(qsizetype index, bool success, const QString &error)
+{
+	bool done;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		Item &item = items[index];
+		item.state = success ? ItemState::Added : ItemState::Failed;
+		item.error = error;
+		inFlight--;
+		done = inFlight == 0 && (!running || nextIndex >= items.size());
+		if (done)
+			running = false;
+		if (!success)
+			obs_log_warning("[Nightbot SR/Import] '%s' failed: %s", item.query.toUtf8().constData(),
+					error.toUtf8().constData());
+		else
+			RequestHistory::get().RecordQuery(item.query);
+	}
+	dirty = true;
+
+	if (!done) {
+		Pump();
+		return;
+	}
+
+	QMetaObject::invokeMethod(
+		this,
+		[this]() {
+			progressTimer->stop();
+			dirty = false;
+			const Progress progress = GetProgress();
+			obs_log_info("[Nightbot SR/Import] Import stopped: %d added, %d failed, %d not sent.",
+				     progress.added, progress.failed, progress.pending);
+			emit progressChanged();
+			emit finished();
+		},
+		Qt::QueuedConnection);
+}
+
+BulkImporter::Progress BulkImporter::GetProgress() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	Progress progress;
+	progress.total = static_cast<int>(items.size());
+	progress.running = running || inFlight > 0;
+	for (const Item &item : items) {
+		if (item.state == ItemState::Added)
+			progress.added++;
+		else if (item.state == ItemState::Failed)
+			progress.failed++;
+		else if (item.state == ItemState::Pending)
+			progress.pending++;
+	}
+	return progress;
+}
+
+QList<BulkImporter::Item> BulkImporter::FailedItems() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	QList<Item> failed;
+	for (const Item &item : items)
+		if (item.state == ItemState::Failed)
+			failed.append(item);
+	return failed;
+}
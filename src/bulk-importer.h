@@ -0,0 +1,79 @@
+#ifndef BULK_IMPORTER_H
+#define BULK_IMPORTER_H
+
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+class NightbotSession;
+class QTimer;
+
+// Importa uma lista de músicas (URLs ou buscas) para a fila da conta ativa no momento do início.
+// No máximo IMPORT_CONCURRENCY pedidos ficam no ApiScheduler; o limite de requisições da conta
+// vale como para qualquer outra chamada. A UI recebe progressChanged no máximo a cada
+// PROGRESS_INTERVAL_MS, nunca um sinal por item.
+class BulkImporter : public QObject {
+	Q_OBJECT
+
+public:
+	static constexpr int IMPORT_CONCURRENCY = 2;
+	static constexpr int PROGRESS_INTERVAL_MS = 250;
+
+	enum class ItemState { Pending, InFlight, Added, Failed };
+
+	struct Item {
+		QString query;
+		ItemState state = ItemState::Pending;
+		QString error;
+	};
+
+	struct Progress {
+		int total = 0;
+		int added = 0;
+		int failed = 0;
+		int pending = 0;
+		bool running = false;
+	};
+
+	static BulkImporter &get();
+
+	// Uma busca por linha; em .csv vale a primeira coluna. Linhas vazias e começando com '#' são ignoradas.
+	static QStringList ParseFile(const QString &path, QString *error);
+
+	// Começa uma importação nova. Ignorado enquanto outra estiver rodando.
+	bool Start(const QStringList &queries);
+	// Para de enviar itens novos; os que já estão na API terminam normalmente.
+	void Cancel();
+	// Continua de onde parou. Com retryFailed, os itens que falharam voltam para a fila.
+	void Resume(bool retryFailed);
+
+	Progress GetProgress() const;
+	QList<Item> FailedItems() const;
+
+signals:
+	void progressChanged();
+	void finished();
+
+private:
+	BulkImporter();
+
+	void Pump();
+	void OnItemDone(qsizetype index, bool success, const QString &error);
+
+	mutable std::mutex mutex;
+	QList<Item> items;
+	qsizetype nextIndex = 0;
+	int inFlight = 0;
+	bool running = false;
+	std::shared_ptr<NightbotSession> session;
+
+	QTimer *progressTimer;
+	std::atomic<bool> dirty{false};
+};
+
+#endif // BULK_IMPORTER_H
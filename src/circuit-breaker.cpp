@@ -0,0 +1,170 @@
+#include "circuit-breaker.h"
+#include "plugin-log.h"
+
+#include <util/platform.h>
+
+#include <QRandomGenerator>
+#include <QStringList>
+
+#include <algorithm>
+#include <cctype>
+
+static const char *StateName(CircuitState state)
+{
+	switch (state) {
+	case CircuitState::Open:
+		return "open";
+	case CircuitState::HalfOpen:
+		return "half-open";
+	default:
+		return "closed";
+	}
+}
+
+CircuitBreakers &CircuitBreakers::get()
+{
+	static CircuitBreakers instance;
+	return instance;
+}
+
+std::string CircuitBreakers::HostOf(const std::string &url)
+{
+	const size_t scheme = url.find("://");
+	const size_t start = scheme == std::string::npos ? 0 : scheme + 3;
+	const size_t end = url.find_first_of("/?#", start);
+	std::string host = url.substr(start, end == std::string::npos ? std::string::npos : end - start);
+	// Credenciais na URL não fazem parte do host.
+	const size_t at = host.rfind('@');
+	if (at != std::string::npos)
+		host.erase(0, at + 1);
+	std::transform(host.begin(), host.end(), host.begin(),
+		       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+	return host;
+}
+
+void CircuitBreakers::Open(const std::string &host, Breaker &breaker, uint64_t nowNs)
+{
+	const int jitterMs = QRandomGenerator::global()->bounded(static_cast<int>(breaker.openForNs / 4 / 1000000) + 1);
+	breaker.state = CircuitState::Open;
+	breaker.openUntilNs = nowNs + breaker.openForNs + static_cast<uint64_t>(jitterMs) * 1000000;
+	breaker.opens++;
+	PLUGIN_LOG(LogCategory::Http, LogLevel::Warning,
+		   "%s failed %u time(s) in a row; holding its requests for %.1f s before a test request.",
+		   host.c_str(), breaker.failures, static_cast<double>(breaker.openUntilNs - nowNs) / 1e9);
+}
+
+bool CircuitBreakers::Allow(const std::string &host, bool &probe)
+{
+	probe = false;
+	if (host.empty())
+		return true;
+
+	bool changed = false;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		auto it = breakers.find(host);
+		if (it == breakers.end() || it->second.state == CircuitState::Closed)
+			return true;
+
+		Breaker &breaker = it->second;
+		if (breaker.state == CircuitState::Open && os_gettime_ns() >= breaker.openUntilNs) {
+			breaker.state = CircuitState::HalfOpen;
+			changed = true;
+		}
+		if (breaker.state == CircuitState::HalfOpen && !breaker.probeInFlight) {
+			breaker.probeInFlight = true;
+			probe = true;
+		} else {
+			breaker.rejected++;
+		}
+	}
+
+	if (changed)
+		emit stateChanged(QString::fromStdString(host));
+	return probe;
+}
+
+void CircuitBreakers::Record(const std::string &host, bool probe, bool success)
+{
+	if (host.empty())
+		return;
+
+	bool changed = false;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (success) {
+			auto it = breakers.find(host);
+			if (it == breakers.end())
+				return;
+			Breaker &breaker = it->second;
+			breaker.failures = 0;
+			// Qualquer resposta do servidor fecha, mesmo a de uma requisição que saiu antes de abrir.
+			if (breaker.state != CircuitState::Closed) {
+				breaker.state = CircuitState::Closed;
+				breaker.probeInFlight = false;
+				breaker.openForNs = BASE_OPEN_NS;
+				changed = true;
+				PLUGIN_LOG(LogCategory::Http, LogLevel::Info,
+					   "%s is reachable again; resuming requests.", host.c_str());
+			}
+		} else {
+			Breaker &breaker = breakers[host];
+			breaker.failures++;
+			if (probe && breaker.state == CircuitState::HalfOpen) {
+				breaker.probeInFlight = false;
+				breaker.openForNs = std::min(breaker.openForNs * 2, MAX_OPEN_NS);
+				Open(host, breaker, os_gettime_ns());
+				changed = true;
+			} else if (breaker.state == CircuitState::Closed && breaker.failures >= FAILURE_THRESHOLD) {
+				Open(host, breaker, os_gettime_ns());
+				changed = true;
+			}
+		}
+	}
+
+	if (changed)
+		emit stateChanged(QString::fromStdString(host));
+}
+
+CircuitState CircuitBreakers::State(const std::string &host) const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	auto it = breakers.find(host);
+	return it == breakers.end() ? CircuitState::Closed : it->second.state;
+}
+
+std::vector<CircuitBreakers::HostStatus> CircuitBreakers::Status() const
+{
+	const uint64_t nowNs = os_gettime_ns();
+	std::vector<HostStatus> result;
+	std::lock_guard<std::mutex> lock(mutex);
+	result.reserve(breakers.size());
+	for (const auto &[host, breaker] : breakers) {
+		HostStatus status;
+		status.host = host;
+		status.state = breaker.state;
+		if (breaker.state == CircuitState::Open && breaker.openUntilNs > nowNs)
+			status.retryInNs = breaker.openUntilNs - nowNs;
+		status.failures = breaker.failures;
+		status.opens = breaker.opens;
+		status.rejected = breaker.rejected;
+		result.push_back(status);
+	}
+	return result;
+}
+
+QString CircuitBreakers::Report() const
+{
+	QStringList lines;
+	for (const HostStatus &status : Status()) {
+		QString line = QString("  %1: %2").arg(QString::fromStdString(status.host), StateName(status.state));
+		if (status.retryInNs > 0)
+			line += QString(" (test in %1 s)").arg(static_cast<double>(status.retryInNs) / 1e9, 0, 'f', 1);
+		line += QString(", %1 failure(s) in a row, opened %2 time(s), %3 request(s) failed fast")
+				.arg(status.failures)
+				.arg(static_cast<qulonglong>(status.opens))
+				.arg(static_cast<qulonglong>(status.rejected));
+		lines << line;
+	}
+	return lines.isEmpty() ? QString() : lines.join('\n') + '\n';
+}
@@ -0,0 +1,82 @@
+#ifndef CIRCUIT_BREAKER_H
+#define CIRCUIT_BREAKER_H
+
+#include <QObject>
+#include <QString>
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+enum class CircuitState { Closed, Open, HalfOpen };
+
+// Disjuntor por host, na frente do transporte HTTP.
+//
+//  - Fechado: tudo passa. FAILURE_THRESHOLD falhas seguidas (erro de rede ou 5xx) abrem o circuito.
+//  - Aberto: as requisições falham na hora, sem tocar a rede, até o fim da espera.
+//  - Meio aberto: passa uma única requisição de teste; as outras continuam falhando na hora.
+//    Se ela der certo, fecha; se falhar, abre de novo com o dobro da espera (até MAX_OPEN_NS).
+// 4xx não conta (inclusive 401 e 429): o servidor respondeu, e o 429 tem o próprio controle.
+// A espera tem um sorteio de até 25%, para os plugins de todo mundo não testarem juntos.
+class CircuitBreakers : public QObject {
+	Q_OBJECT
+
+public:
+	static constexpr uint32_t FAILURE_THRESHOLD = 5;
+	static constexpr uint64_t BASE_OPEN_NS = 5ull * 1000 * 1000 * 1000;
+	static constexpr uint64_t MAX_OPEN_NS = 60ull * 1000 * 1000 * 1000;
+
+	struct HostStatus {
+		std::string host;
+		CircuitState state = CircuitState::Closed;
+		// Até o próximo teste, com o circuito aberto.
+		uint64_t retryInNs = 0;
+		uint32_t failures = 0;
+		uint64_t opens = 0;
+		uint64_t rejected = 0;
+	};
+
+	static CircuitBreakers &get();
+
+	// "host[:porta]" em minúsculas; vazio se a URL não tiver host.
+	static std::string HostOf(const std::string &url);
+
+	// false: falhar sem fazer a requisição. Com probe = true, esta é a requisição de teste
+	// do meio aberto, e o resultado dela tem que voltar em Record.
+	bool Allow(const std::string &host, bool &probe);
+	void Record(const std::string &host, bool probe, bool success);
+
+	CircuitState State(const std::string &host) const;
+	std::vector<HostStatus> Status() const;
+	QString Report() const;
+
+	CircuitBreakers(CircuitBreakers const &) = delete;
+	void operator=(CircuitBreakers const &) = delete;
+
+signals:
+	// Emitido na thread da requisição; quem estiver na UI recebe pela fila.
+	void stateChanged(const QString &host);
+
+private:
+	CircuitBreakers() = default;
+
+	struct Breaker {
+		CircuitState state = CircuitState::Closed;
+		uint32_t failures = 0;
+		uint64_t openUntilNs = 0;
+		uint64_t openForNs = BASE_OPEN_NS;
+		bool probeInFlight = false;
+		uint64_t opens = 0;
+		uint64_t rejected = 0;
+	};
+
+	// Com o mutex travado.
+	void Open(const std::string &host, Breaker &breaker, uint64_t nowNs);
+
+	mutable std::mutex mutex;
+	std::map<std::string, Breaker> breakers;
+};
+
+#endif // CIRCUIT_BREAKER_H
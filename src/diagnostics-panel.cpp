@@ -0,0 +1,241 @@
+#include "diagnostics-panel.h"
+#include "transport-stats.h"
+#include "trace-recorder.h"
+#include "plugin-metrics.h"
+#include "ui-stall-detector.h"
+#include "api-scheduler.h"
+#include "play-history.h"
+#include "plugin-log.h"
+#include "circuit-breaker.h"
+#include "SettingsManager.h"
+#include "plugin-support.h"
+
+#include <QApplication>
+#include <QCheckBox>
+#include <QClipboard>
+#include <QDateTime>
+#include <QFileDialog>
+#include <QFontDatabase>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QPlainTextEdit>
+#include <QPushButton>
+#include <QScrollBar>
+#include <QSpinBox>
+#include <QTimer>
+#include <QVBoxLayout>
+
+// Atualiza o relatório só enquanto a aba está visível.
+static const int DIAGNOSTICS_REFRESH_MS = 2000;
+
+DiagnosticsPanel::DiagnosticsPanel(QWidget *parent) : QWidget(parent)
+{
+	QVBoxLayout *layout = new QVBoxLayout(this);
+
+	reportView = new QPlainTextEdit();
+	reportView->setReadOnly(true);
+	reportView->setLineWrapMode(QPlainTextEdit::NoWrap);
+	reportView->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+	layout->addWidget(reportView);
+
+	QPushButton *refreshButton = new QPushButton(get_obs_text("Nightbot.Diagnostics.Refresh"));
+	QPushButton *copyButton = new QPushButton(get_obs_text("Nightbot.Diagnostics.Copy"));
+	QPushButton *resetButton = new QPushButton(get_obs_text("Nightbot.Diagnostics.Reset"));
+
+	QHBoxLayout *buttonLayout = new QHBoxLayout();
+	buttonLayout->addWidget(refreshButton);
+	buttonLayout->addWidget(resetButton);
+	buttonLayout->addStretch();
+	buttonLayout->addWidget(copyButton);
+	layout->addLayout(buttonLayout);
+
+	traceButton = new QPushButton();
+	saveTraceButton = new QPushButton(get_obs_text("Nightbot.Diagnostics.Trace.Save"));
+	traceStatusLabel = new QLabel();
+
+	QHBoxLayout *traceLayout = new QHBoxLayout();
+	traceLayout->addWidget(traceButton);
+	traceLayout->addWidget(saveTraceButton);
+	traceLayout->addWidget(traceStatusLabel, 1);
+	layout->addLayout(traceLayout);
+
+	QLabel *metricsPortLabel = new QLabel(get_obs_text("Nightbot.Diagnostics.MetricsPort"));
+	metricsPortLabel->setToolTip(get_obs_text("Nightbot.Diagnostics.MetricsPort.Tooltip"));
+	metricsPortSpinBox = new QSpinBox();
+	metricsPortSpinBox->setRange(0, 65535);
+	metricsPortSpinBox->setSpecialValueText(get_obs_text("Nightbot.Diagnostics.MetricsPort.Off"));
+	metricsPortSpinBox->setValue(SettingsManager::get().GetSnapshot()->metricsPort);
+
+	QHBoxLayout *metricsLayout = new QHBoxLayout();
+	metricsLayout->addWidget(metricsPortLabel);
+	metricsLayout->addWidget(metricsPortSpinBox);
+	metricsLayout->addSpacing(12);
+
+	QLabel *stallThresholdLabel = new QLabel(get_obs_text("Nightbot.Diagnostics.StallThreshold"));
+	stallThresholdLabel->setToolTip(get_obs_text("Nightbot.Diagnostics.StallThreshold.Tooltip"));
+	stallThresholdSpinBox = new QSpinBox();
+	stallThresholdSpinBox->setRange(0, 1000);
+	stallThresholdSpinBox->setSuffix(" ms");
+	stallThresholdSpinBox->setSpecialValueText(get_obs_text("Nightbot.Diagnostics.StallThreshold.Off"));
+	stallThresholdSpinBox->setValue(SettingsManager::get().GetSnapshot()->uiStallThresholdMs);
+	metricsLayout->addWidget(stallThresholdLabel);
+	metricsLayout->addWidget(stallThresholdSpinBox);
+	metricsLayout->addStretch();
+	layout->addLayout(metricsLayout);
+
+	networkDebugLogCheckBox = new QCheckBox(get_obs_text("Nightbot.Diagnostics.NetworkDebugLog"));
+	networkDebugLogCheckBox->setToolTip(get_obs_text("Nightbot.Diagnostics.NetworkDebugLog.Tooltip"));
+	networkDebugLogCheckBox->setChecked(SettingsManager::get().GetSnapshot()->networkDebugLog);
+	layout->addWidget(networkDebugLogCheckBox);
+
+	refreshTimer = new QTimer(this);
+	refreshTimer->setInterval(DIAGNOSTICS_REFRESH_MS);
+
+	connect(refreshTimer, &QTimer::timeout, this, &DiagnosticsPanel::onRefresh);
+	connect(refreshButton, &QPushButton::clicked, this, &DiagnosticsPanel::onRefresh);
+	connect(copyButton, &QPushButton::clicked, this, &DiagnosticsPanel::onCopy);
+	connect(resetButton, &QPushButton::clicked, this, &DiagnosticsPanel::onReset);
+	connect(traceButton, &QPushButton::clicked, this, &DiagnosticsPanel::onTraceToggled);
+	connect(saveTraceButton, &QPushButton::clicked, this, &DiagnosticsPanel::onSaveTrace);
+	// Só grava quando o usuário termina de digitar, para não abrir portas intermediárias.
+	metricsPortSpinBox->setKeyboardTracking(false);
+	connect(metricsPortSpinBox, QOverload<int>::of(&QSpinBox::valueChanged), this,
+		&DiagnosticsPanel::onMetricsPortChanged);
+	stallThresholdSpinBox->setKeyboardTracking(false);
+	connect(stallThresholdSpinBox, QOverload<int>::of(&QSpinBox::valueChanged), this,
+		&DiagnosticsPanel::onStallThresholdChanged);
+	connect(networkDebugLogCheckBox, &QCheckBox::toggled, this, &DiagnosticsPanel::onNetworkDebugLogToggled);
+
+	UpdateTraceControls();
+}
+
+QString DiagnosticsPanel::BuildReport() const
+{
+	QString report = QString("%1 %2 - %3\n\n")
+				 .arg(QString::fromUtf8(PLUGIN_NAME), QString::fromUtf8(PLUGIN_VERSION),
+				      QDateTime::currentDateTime().toString(Qt::ISODate));
+
+	PluginMetrics &metrics = PluginMetrics::get();
+	report += "[Plugin]\n";
+	report += QString("  queue length %1, poll interval %2 s, retries %3, token refreshes %4 (%5 failed)\n")
+			  .arg(metrics.queueLength.load())
+			  .arg(static_cast<double>(metrics.pollIntervalMs.load()) / 1000.0)
+			  .arg(metrics.requestRetries.load())
+			  .arg(metrics.tokenRefreshes.load())
+			  .arg(metrics.tokenRefreshFailures.load());
+	if (metrics.uiUpdateUs.Count() > 0)
+		report += QString("  dock update p50 %1 ms  p95 %2 ms  p99 %3 ms\n")
+				  .arg(static_cast<double>(metrics.uiUpdateUs.Percentile(50)) / 1000.0, 0, 'f', 2)
+				  .arg(static_cast<double>(metrics.uiUpdateUs.Percentile(95)) / 1000.0, 0, 'f', 2)
+				  .arg(static_cast<double>(metrics.uiUpdateUs.Percentile(99)) / 1000.0, 0, 'f', 2);
+	report += "\n";
+
+	report += "[API lanes]\n";
+	report += ApiScheduler::get().Report();
+	report += "\n";
+
+	report += "[Play history]\n";
+	report += PlayHistory::get().Report();
+	report += "\n";
+
+	report += "[UI thread]\n";
+	report += UiStallDetector::get().Report();
+	report += "\n";
+
+	report += "[Circuit breakers]\n";
+	const QString circuits = CircuitBreakers::get().Report();
+	report += circuits.isEmpty() ? QString(get_obs_text("Nightbot.Diagnostics.Empty")) + "\n" : circuits;
+	report += "\n";
+
+	report += "[Log]\n";
+	report += PluginLog::get().Report();
+	report += "\n";
+
+	report += "[HTTP]\n";
+	QString http = TransportStats::get().Report();
+	report += http.isEmpty() ? QString(get_obs_text("Nightbot.Diagnostics.Empty")) + "\n" : http;
+
+	return report;
+}
+
+void DiagnosticsPanel::showEvent(QShowEvent *event)
+{
+	QWidget::showEvent(event);
+	onRefresh();
+	refreshTimer->start();
+}
+
+void DiagnosticsPanel::hideEvent(QHideEvent *event)
+{
+	QWidget::hideEvent(event);
+	refreshTimer->stop();
+}
+
+void DiagnosticsPanel::onRefresh()
+{
+	UI_SLOT_SCOPE("DiagnosticsPanel::onRefresh");
+	// Mantém a posição de rolagem entre atualizações.
+	int scroll = reportView->verticalScrollBar()->value();
+	reportView->setPlainText(BuildReport());
+	reportView->verticalScrollBar()->setValue(scroll);
+	UpdateTraceControls();
+}
+
+void DiagnosticsPanel::onCopy()
+{
+	UI_SLOT_SCOPE("DiagnosticsPanel::onCopy");
+	QApplication::clipboard()->setText(BuildReport());
+}
+
+void DiagnosticsPanel::onReset()
+{
+	UI_SLOT_SCOPE("DiagnosticsPanel::onReset");
+	TransportStats::get().Reset();
+	onRefresh();
+}
+
+void DiagnosticsPanel::UpdateTraceControls()
+{
+	const bool recording = TraceRecorder::Enabled();
+	const size_t events = TraceRecorder::get().EventCount();
+
+	traceButton->setText(get_obs_text(recording ? "Nightbot.Diagnostics.Trace.Stop" : "Nightbot.Diagnostics.Trace.Start"));
+	saveTraceButton->setEnabled(events > 0);
+	traceStatusLabel->setText(QString(get_obs_text("Nightbot.Diagnostics.Trace.Events")).arg(events));
+}
+
+void DiagnosticsPanel::onTraceToggled()
+{
+	UI_SLOT_SCOPE("DiagnosticsPanel::onTraceToggled");
+	if (TraceRecorder::Enabled())
+		TraceRecorder::get().Stop();
+	else
+		TraceRecorder::get().Start();
+	UpdateTraceControls();
+}
+
+void DiagnosticsPanel::onSaveTrace()
+{
+	QString path = QFileDialog::getSaveFileName(this, get_obs_text("Nightbot.Diagnostics.Trace.Save"),
+						    "nightbot-trace.json", "Trace (*.json)");
+	if (!path.isEmpty())
+		TraceRecorder::get().Save(path);
+}
+
+void DiagnosticsPanel::onMetricsPortChanged(int port)
+{
+	UI_SLOT_SCOPE("DiagnosticsPanel::onMetricsPortChanged");
+	SettingsManager::get().SetMetricsPort(port);
+}
+
+void DiagnosticsPanel::onStallThresholdChanged(int thresholdMs)
+{
+	UI_SLOT_SCOPE("DiagnosticsPanel::onStallThresholdChanged");
+	SettingsManager::get().SetUiStallThresholdMs(thresholdMs);
+}
+
+void DiagnosticsPanel::onNetworkDebugLogToggled(bool enabled)
+{
+	UI_SLOT_SCOPE("DiagnosticsPanel::onNetworkDebugLogToggled");
+	SettingsManager::get().SetNetworkDebugLog(enabled);
+}
@@ -0,0 +1,50 @@
+#ifndef DIAGNOSTICS_PANEL_H
+#define DIAGNOSTICS_PANEL_H
+
+#include <QWidget>
+
+class QCheckBox;
+class QLabel;
+class QPlainTextEdit;
+class QPushButton;
+class QSpinBox;
+class QTimer;
+
+// Aba "Diagnóstico" das configurações: relatório em texto das métricas internas,
+// pronto para ser copiado em um issue.
+class DiagnosticsPanel : public QWidget {
+	Q_OBJECT
+
+public:
+	explicit DiagnosticsPanel(QWidget *parent = nullptr);
+
+	QString BuildReport() const;
+
+protected:
+	void showEvent(QShowEvent *event) override;
+	void hideEvent(QHideEvent *event) override;
+
+private slots:
+	void onRefresh();
+	void onCopy();
+	void onReset();
+	void onTraceToggled();
+	void onSaveTrace();
+	void onMetricsPortChanged(int port);
+	void onStallThresholdChanged(int thresholdMs);
+	void onNetworkDebugLogToggled(bool enabled);
+
+private:
+	void UpdateTraceControls();
+
+	QPlainTextEdit *reportView;
+	QPushButton *traceButton;
+	QPushButton *saveTraceButton;
+	QLabel *traceStatusLabel;
+	QSpinBox *metricsPortSpinBox;
+	QSpinBox *stallThresholdSpinBox;
+	QCheckBox *networkDebugLogCheckBox;
+	QTimer *refreshTimer;
+};
+
+#endif // DIAGNOSTICS_PANEL_H
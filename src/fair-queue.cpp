@@ -0,0 +1,101 @@
+#include "fair-queue.h"
+#include "plugin-support.h"
+
+#include <QHash>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+QStringList FairQueue::TargetOrder(const QList<SongItem> &queue)
+{
+	// (rodada, posição atual): a ordenação estável por rodada é o rodízio, e dentro de uma
+	// rodada vale a ordem em que as músicas chegaram.
+	QHash<QString, int> turns;
+	std::vector<std::pair<int, qsizetype>> keyed;
+	keyed.reserve(static_cast<size_t>(queue.size()));
+	for (qsizetype i = 0; i < queue.size(); ++i) {
+		const SongItem &item = queue.at(i);
+		int &turn = turns[item.user.toLower()];
+		if (item.position != 0)
+			keyed.emplace_back(turn, i);
+		++turn;
+	}
+	std::stable_sort(keyed.begin(), keyed.end(),
+			 [](const auto &a, const auto &b) { return a.first < b.first; });
+
+	QStringList order;
+	order.reserve(static_cast<qsizetype>(keyed.size()));
+	for (const auto &entry : keyed)
+		order << queue.at(entry.second).id;
+	return order;
+}
+
+QStringList FairQueue::PlanPromotions(const QStringList &waiting, const QStringList &target, int window)
+{
+	const qsizetype count = std::min<qsizetype>(std::max(0, window), target.size());
+	if (count == 0 || waiting.size() != target.size())
+		return {};
+
+	QHash<QString, qsizetype> position;
+	position.reserve(waiting.size());
+	for (qsizetype i = 0; i < waiting.size(); ++i)
+		position.insert(waiting.at(i), i);
+	QHash<QString, qsizetype> inWindow;
+	inWindow.reserve(count);
+	for (qsizetype i = 0; i < count; ++i)
+		inWindow.insert(target.at(i), i);
+
+	// Depois de promover target[0..p), a espera é target[0..p) seguida do resto na ordem atual.
+	// O resto precisa começar com target[p..count): nada de fora do trecho pode estar antes do
+	// último dele, e target[p..count) tem que já estar em ordem crescente de posição.
+	const qsizetype last = position.value(target.at(count - 1), -1);
+	if (last < 0)
+		return {};
+	for (qsizetype i = 0; i < last; ++i) {
+		if (!inWindow.contains(waiting.at(i)))
+			return target.mid(0, count);
+	}
+
+	qsizetype keep = count - 1;
+	while (keep > 0 && position.value(target.at(keep - 1)) < position.value(target.at(keep)))
+		--keep;
+	return target.mid(0, keep);
+}
+
+QStringList FairQueue::Plan(const QList<SongItem> &queue, const SongQueueDiff &diff, const FairQueueSettings &settings)
+{
+	if (!settings.enabled) {
+		lastPlan.clear();
+		lastSettings = settings;
+		return {};
+	}
+	// A ordem só muda quando algo entra, sai ou é movido (ou quando as regras mudam).
+	if (diff.IsEmpty() && settings == lastSettings)
+		return {};
+	lastSettings = settings;
+
+	QStringList waiting;
+	waiting.reserve(queue.size());
+	for (const SongItem &item : queue) {
+		if (item.position != 0)
+			waiting << item.id;
+	}
+
+	const QStringList plan = PlanPromotions(waiting, TargetOrder(queue), settings.window);
+	if (plan.isEmpty()) {
+		lastPlan.clear();
+		return {};
+	}
+	// O último plano não pegou: repetir só gastaria requisições brigando com quem reordenou.
+	if (plan == lastPlan) {
+		obs_log_info("[Nightbot SR/FairQueue] Queue still differs after promoting %d song(s); not retrying.",
+			     static_cast<int>(plan.size()));
+		return {};
+	}
+
+	lastPlan = plan;
+	obs_log_info("[Nightbot SR/FairQueue] Promoting %d of %d waiting song(s) to restore round-robin order.",
+		     static_cast<int>(plan.size()), static_cast<int>(waiting.size()));
+	return plan;
+}
@@ -0,0 +1,42 @@
+#ifndef FAIR_QUEUE_H
+#define FAIR_QUEUE_H
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+#include "SettingsManager.h"
+#include "song-queue.h"
+
+// Ordem justa da fila: rodízio entre quem pediu, na ordem em que cada pessoa pediu pela primeira vez.
+//
+// A API só sabe colocar uma música no topo da espera (promote), e cada promoção é uma requisição
+// que conta no limite da API. Por isso o plano é o menor conjunto de promoções que deixa as
+// próximas "window" músicas na ordem alvo: as que já estão na ordem certa no fim desse trecho
+// ficam onde estão, só as da frente são promovidas.
+class FairQueue {
+public:
+	// Ids a promover, na ordem em que devem terminar na fila (RunBatch já envia do último para o
+	// primeiro). Vazio se nada mudou, se a fila já está justa ou se o mesmo plano acabou de ser
+	// enviado sem efeito (alguém desfez a ordem, ou a API recusou).
+	QStringList Plan(const QList<SongItem> &queue, const SongQueueDiff &diff, const FairQueueSettings &settings);
+	// Esquece o último plano e as regras vistas: a próxima leitura é planejada inteira (troca de conta).
+	void Reset()
+	{
+		lastPlan.clear();
+		lastSettings = FairQueueSettings();
+	}
+
+	// Ids das músicas em espera (sem a que está tocando) na ordem justa. Quem está com uma música
+	// tocando já teve a vez dela nesta rodada.
+	static QStringList TargetOrder(const QList<SongItem> &queue);
+	// Menor lista de promoções para "waiting" começar com as primeiras "window" músicas de "target".
+	// As duas listas devem ter os mesmos ids. O(n).
+	static QStringList PlanPromotions(const QStringList &waiting, const QStringList &target, int window);
+
+private:
+	QStringList lastPlan;
+	FairQueueSettings lastSettings;
+};
+
+#endif // FAIR_QUEUE_H
@@ -0,0 +1,440 @@
+#include "http-transport.h"
+#include "transport-stats.h"
+#include "trace-recorder.h"
+#include "plugin-log.h"
+#include "circuit-breaker.h"
+#include "plugin-support.h"
+
+#include <curl/curl.h>
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QFile>
+#include <QHash>
+#include <QRegularExpression>
+#include <QString>
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+// 'NBTR'
+static const quint32 TRANSPORT_RECORD_MAGIC = 0x4E425452;
+static const quint16 TRANSPORT_RECORD_VERSION = 1;
+
+static std::once_flag g_curlInitFlag;
+static std::atomic<bool> g_curlInitialized(false);
+
+// Cache de conexões, DNS e sessões TLS compartilhado entre os handles: cada
+// requisição usa um easy handle novo, mas reaproveita a conexão da anterior.
+static CURLSH *g_curlShare = nullptr;
+static std::mutex g_curlShareLocks[CURL_LOCK_DATA_LAST];
+
+static void transport_share_lock(CURL *, curl_lock_data data, curl_lock_access, void *)
+{
+	g_curlShareLocks[data].lock();
+}
+
+static void transport_share_unlock(CURL *, curl_lock_data data, void *)
+{
+	g_curlShareLocks[data].unlock();
+}
+
+// Inicializa o libcurl sob demanda: no FINISHED_LOADING do OBS ou na primeira
+// requisição, o que vier primeiro. Fica fora do caminho crítico do obs_module_load.
+void EnsureNightbotNetwork()
+{
+	std::call_once(g_curlInitFlag, []() {
+		curl_global_init(CURL_GLOBAL_ALL);
+
+		g_curlShare = curl_share_init();
+		if (g_curlShare) {
+			curl_share_setopt(g_curlShare, CURLSHOPT_LOCKFUNC, transport_share_lock);
+			curl_share_setopt(g_curlShare, CURLSHOPT_UNLOCKFUNC, transport_share_unlock);
+			curl_share_setopt(g_curlShare, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+			curl_share_setopt(g_curlShare, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+			curl_share_setopt(g_curlShare, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+		}
+		g_curlInitialized = true;
+		PLUGIN_LOG(LogCategory::Http, LogLevel::Info, "Network initialized.");
+	});
+}
+
+enum class TransportMode { Live, Record, Replay };
+
+struct TransportRecord {
+	quint64 offsetUs = 0;
+	quint32 durationUs = 0;
+	QByteArray method;
+	QByteArray path;
+	QByteArray requestBody;
+	qint32 httpCode = 0;
+	bool curlError = false;
+	QByteArray errorMessage;
+	QByteArray responseBody;
+};
+
+struct TransportState {
+	TransportMode mode = TransportMode::Live;
+	std::mutex mutex;
+	std::chrono::steady_clock::time_point startedAt = std::chrono::steady_clock::now();
+
+	QFile recordFile;
+	QDataStream recordStream;
+	quint64 recordCount = 0;
+
+	// Respostas gravadas por "MÉTODO caminho", na ordem em que aconteceram.
+	QHash<QByteArray, std::deque<TransportRecord>> replayQueue;
+	QHash<QByteArray, TransportRecord> replayLast;
+	double replaySpeed = 1.0;
+};
+
+static std::once_flag g_transportInitFlag;
+static TransportState *g_transport = nullptr;
+
+static QDataStream &operator<<(QDataStream &out, const TransportRecord &record)
+{
+	// Os corpos de fila se repetem muito entre polls; comprimir cada um mantém o arquivo pequeno.
+	out << record.offsetUs << record.durationUs << record.method << record.path << qCompress(record.requestBody)
+	    << record.httpCode << record.curlError << record.errorMessage << qCompress(record.responseBody);
+	return out;
+}
+
+static QDataStream &operator>>(QDataStream &in, TransportRecord &record)
+{
+	QByteArray requestBody;
+	QByteArray responseBody;
+	in >> record.offsetUs >> record.durationUs >> record.method >> record.path >> requestBody >>
+		record.httpCode >> record.curlError >> record.errorMessage >> responseBody;
+	record.requestBody = qUncompress(requestBody);
+	record.responseBody = qUncompress(responseBody);
+	return in;
+}
+
+// Só o caminho entra na chave, assim uma gravação feita contra a API real pode
+// ser reproduzida com qualquer base URL (ex.: o mock local).
+static QByteArray PathOf(const std::string &url)
+{
+	size_t scheme = url.find("://");
+	size_t pathStart = url.find('/', scheme == std::string::npos ? 0 : scheme + 3);
+	if (pathStart == std::string::npos)
+		return QByteArray("/");
+	return QByteArray::fromStdString(url.substr(pathStart));
+}
+
+// Tokens nunca vão para o arquivo. Cabeçalhos (inclusive Authorization) não são gravados.
+static QByteArray RedactSecrets(const std::string &body)
+{
+	static const QRegularExpression secrets(R"(("(?:access_token|refresh_token)"\s*:\s*")[^"]*")");
+	return QString::fromStdString(body)
+		.replace(secrets, QStringLiteral("\\1%1\"").arg(QString::fromLatin1(HTTP_REDACTED_TOKEN)))
+		.toUtf8();
+}
+
+static void LoadReplay(TransportState &state, const QString &path)
+{
+	QFile file(path);
+	if (!file.open(QIODevice::ReadOnly)) {
+		PLUGIN_LOG(LogCategory::Http, LogLevel::Error, "Could not open replay file '%s'.",
+			   path.toUtf8().constData());
+		return;
+	}
+
+	QDataStream in(&file);
+	in.setVersion(QDataStream::Qt_6_0);
+
+	quint32 magic = 0;
+	quint16 version = 0;
+	in >> magic >> version;
+	if (magic != TRANSPORT_RECORD_MAGIC || version != TRANSPORT_RECORD_VERSION) {
+		PLUGIN_LOG(LogCategory::Http, LogLevel::Error, "'%s' is not a transport recording (version %u).",
+			   path.toUtf8().constData(), version);
+		return;
+	}
+
+	quint64 count = 0;
+	while (!in.atEnd()) {
+		TransportRecord record;
+		in >> record;
+		if (in.status() != QDataStream::Ok)
+			break;
+		state.replayQueue[record.method + ' ' + record.path].push_back(record);
+		count++;
+	}
+
+	PLUGIN_LOG(LogCategory::Http, LogLevel::Info, "Replaying %llu recorded requests from '%s' (speed %.2f).",
+		   static_cast<unsigned long long>(count), path.toUtf8().constData(), state.replaySpeed);
+}
+
+static TransportState &Transport()
+{
+	std::call_once(g_transportInitFlag, []() {
+		g_transport = new TransportState();
+		TransportState &state = *g_transport;
+
+		const QString replayPath = qEnvironmentVariable("NIGHTBOT_SR_HTTP_REPLAY");
+		const QString recordPath = qEnvironmentVariable("NIGHTBOT_SR_HTTP_RECORD");
+
+		if (!replayPath.isEmpty()) {
+			bool ok = false;
+			double speed = qEnvironmentVariable("NIGHTBOT_SR_HTTP_REPLAY_SPEED").toDouble(&ok);
+			if (ok && speed >= 0.0)
+				state.replaySpeed = speed;
+
+			state.mode = TransportMode::Replay;
+			LoadReplay(state, replayPath);
+		} else if (!recordPath.isEmpty()) {
+			state.recordFile.setFileName(recordPath);
+			if (!state.recordFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+				PLUGIN_LOG(LogCategory::Http, LogLevel::Error, "Could not create record file '%s'.",
+					   recordPath.toUtf8().constData());
+				return;
+			}
+
+			state.recordStream.setDevice(&state.recordFile);
+			state.recordStream.setVersion(QDataStream::Qt_6_0);
+			state.recordStream << TRANSPORT_RECORD_MAGIC << TRANSPORT_RECORD_VERSION;
+			state.mode = TransportMode::Record;
+			PLUGIN_LOG(LogCategory::Http, LogLevel::Info, "Recording HTTP traffic to '%s'.",
+				   recordPath.toUtf8().constData());
+		}
+	});
+	return *g_transport;
+}
+
+bool HttpTransportReplaying()
+{
+	// Mesma regra do Transport(), sem carregar a gravação: pode ser chamado no carregamento do plugin.
+	static const bool replaying = !qEnvironmentVariableIsEmpty("NIGHTBOT_SR_HTTP_REPLAY");
+	return replaying;
+}
+
+void ShutdownHttpTransport()
+{
+	if (g_transport) {
+		std::lock_guard<std::mutex> lock(g_transport->mutex);
+		if (g_transport->mode == TransportMode::Record) {
+			g_transport->recordFile.close();
+			PLUGIN_LOG(LogCategory::Http, LogLevel::Info, "Recorded %llu requests.",
+				   static_cast<unsigned long long>(g_transport->recordCount));
+		}
+	}
+	// O estado fica vivo até o fim do processo: o call_once não pode ser refeito.
+
+	if (g_curlInitialized) {
+		if (g_curlShare) {
+			curl_share_cleanup(g_curlShare);
+			g_curlShare = nullptr;
+		}
+		curl_global_cleanup();
+		g_curlInitialized = false;
+	}
+}
+
+static size_t transport_write_callback(void *contents, size_t size, size_t nmemb, void *userp)
+{
+	size_t realsize = size * nmemb;
+	((std::string *)userp)->append((char *)contents, realsize);
+	return realsize;
+}
+
+static uint64_t InfoValue(CURL *curl, CURLINFO info)
+{
+	curl_off_t value = 0;
+	if (curl_easy_getinfo(curl, info, &value) != CURLE_OK || value < 0)
+		return 0;
+	return static_cast<uint64_t>(value);
+}
+
+static void RecordSample(CURL *curl, CURLcode res, const HttpRequest &request, const HttpResponse &response)
+{
+	long connects = 0;
+	curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &connects);
+
+	TransportSample sample;
+	sample.status = res == CURLE_OK ? response.http_code : -1;
+	sample.failed = res != CURLE_OK || response.http_code >= 400;
+	sample.reusedConnection = res == CURLE_OK && connects == 0;
+	sample.nameLookupUs = InfoValue(curl, CURLINFO_NAMELOOKUP_TIME_T);
+	sample.connectUs = InfoValue(curl, CURLINFO_CONNECT_TIME_T);
+	sample.appConnectUs = InfoValue(curl, CURLINFO_APPCONNECT_TIME_T);
+	sample.startTransferUs = InfoValue(curl, CURLINFO_STARTTRANSFER_TIME_T);
+	sample.totalUs = InfoValue(curl, CURLINFO_TOTAL_TIME_T);
+	sample.bytesSent = InfoValue(curl, CURLINFO_SIZE_UPLOAD_T);
+	sample.bytesReceived = InfoValue(curl, CURLINFO_SIZE_DOWNLOAD_T);
+
+	TransportStats::get().Record(request.statsKey.empty() ? TransportStats::EndpointKey(request.method, request.url)
+							      : request.statsKey,
+				     sample);
+}
+
+// Fases do curl como spans filhos do "curl_easy_perform"; os tempos do curl são acumulados.
+static void TracePhases(CURL *curl, uint64_t startNs)
+{
+	const uint64_t dns = InfoValue(curl, CURLINFO_NAMELOOKUP_TIME_T) * 1000;
+	const uint64_t connect = InfoValue(curl, CURLINFO_CONNECT_TIME_T) * 1000;
+	const uint64_t tls = InfoValue(curl, CURLINFO_APPCONNECT_TIME_T) * 1000;
+	const uint64_t pretransfer = InfoValue(curl, CURLINFO_PRETRANSFER_TIME_T) * 1000;
+	const uint64_t firstByte = InfoValue(curl, CURLINFO_STARTTRANSFER_TIME_T) * 1000;
+	const uint64_t total = InfoValue(curl, CURLINFO_TOTAL_TIME_T) * 1000;
+
+	TraceRecorder &tracer = TraceRecorder::get();
+	if (dns > 0)
+		tracer.Complete("dns", "curl", startNs, startNs + dns);
+	if (connect > dns)
+		tracer.Complete("connect", "curl", startNs + dns, startNs + connect);
+	if (tls > connect)
+		tracer.Complete("tls", "curl", startNs + connect, startNs + tls);
+	if (firstByte > pretransfer)
+		tracer.Complete("wait", "curl", startNs + pretransfer, startNs + firstByte);
+	if (total > firstByte)
+		tracer.Complete("download", "curl", startNs + firstByte, startNs + total);
+}
+
+static HttpResponse PerformLive(const HttpRequest &request)
+{
+	EnsureNightbotNetwork();
+
+	CURL *curl = curl_easy_init();
+	if (!curl) {
+		PLUGIN_LOG(LogCategory::Http, LogLevel::Error, "Failed to initialize libcurl.");
+		return {-1, "", true, "cURL init failed"};
+	}
+
+	HttpResponse response;
+	struct curl_slist *headers_list = NULL;
+	for (const auto &header : request.headers) {
+		headers_list = curl_slist_append(headers_list, header.c_str());
+	}
+
+	curl_easy_setopt(curl, CURLOPT_URL, request.url.c_str());
+	curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers_list);
+	if (g_curlShare)
+		curl_easy_setopt(curl, CURLOPT_SHARE, g_curlShare);
+	curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, transport_write_callback);
+	curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response.body);
+	curl_easy_setopt(curl, CURLOPT_FAILONERROR, 0L);
+	curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, request.method.c_str());
+	curl_easy_setopt(curl, CURLOPT_TIMEOUT, 10L);
+
+	if (request.method == "POST" || request.method == "PUT") {
+		curl_easy_setopt(curl, CURLOPT_POSTFIELDS, request.body.c_str());
+	}
+
+	const uint64_t traceStart = TraceRecorder::Enabled() ? TraceRecorder::NowNs() : 0;
+	CURLcode res;
+	{
+		TRACE_SCOPE("curl_easy_perform", "curl");
+		res = curl_easy_perform(curl);
+	}
+	curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response.http_code);
+	RecordSample(curl, res, request, response);
+	if (traceStart)
+		TracePhases(curl, traceStart);
+	curl_off_t totalUs = 0;
+	curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME_T, &totalUs);
+
+	curl_slist_free_all(headers_list);
+	curl_easy_cleanup(curl);
+
+	if (res != CURLE_OK) {
+		response.curl_error = true;
+		response.error_message = curl_easy_strerror(res);
+		response.http_code = -1; // Internal error code for cURL failure
+	}
+
+	// Sem a query: ela pode carregar dados do usuário.
+	PLUGIN_LOG(LogCategory::Http, LogLevel::Debug, "%s %s -> %ld in %.1f ms, %zu byte(s)%s%s",
+		   request.method.c_str(), PathOf(request.url).split('?').first().constData(),
+		   response.http_code, static_cast<double>(totalUs) / 1000.0, response.body.size(),
+		   response.curl_error ? ": " : "", response.error_message.c_str());
+	return response;
+}
+
+static HttpResponse PerformReplay(TransportState &state, const HttpRequest &request)
+{
+	const QByteArray key = QByteArray::fromStdString(request.method) + ' ' + PathOf(request.url);
+
+	TransportRecord record;
+	{
+		std::lock_guard<std::mutex> lock(state.mutex);
+		auto it = state.replayQueue.find(key);
+		if (it != state.replayQueue.end() && !it->empty()) {
+			record = it->front();
+			it->pop_front();
+			state.replayLast.insert(key, record);
+		} else if (state.replayLast.contains(key)) {
+			// Gravação esgotada para este endpoint: repete a última resposta (ex.: polls da fila).
+			record = state.replayLast.value(key);
+		} else {
+			return {-1, "", true, "No recorded response for " + key.toStdString()};
+		}
+	}
+
+	TRACE_SCOPE("replay", "curl");
+	if (state.replaySpeed > 0.0) {
+		auto delay = std::chrono::microseconds(static_cast<long long>(record.durationUs * state.replaySpeed));
+		std::this_thread::sleep_for(delay);
+	}
+
+	HttpResponse response;
+	response.http_code = record.httpCode;
+	response.body = record.responseBody.toStdString();
+	response.curl_error = record.curlError;
+	response.error_message = record.errorMessage.toStdString();
+	return response;
+}
+
+static HttpResponse PerformInMode(const HttpRequest &request)
+{
+	TransportState &state = Transport();
+
+	if (state.mode == TransportMode::Replay)
+		return PerformReplay(state, request);
+
+	if (state.mode == TransportMode::Live)
+		return PerformLive(request);
+
+	auto started = std::chrono::steady_clock::now();
+	HttpResponse response = PerformLive(request);
+	auto finished = std::chrono::steady_clock::now();
+
+	TransportRecord record;
+	record.offsetUs = static_cast<quint64>(
+		std::chrono::duration_cast<std::chrono::microseconds>(started - state.startedAt).count());
+	record.durationUs = static_cast<quint32>(
+		std::chrono::duration_cast<std::chrono::microseconds>(finished - started).count());
+	record.method = QByteArray::fromStdString(request.method);
+	record.path = PathOf(request.url);
+	record.requestBody = RedactSecrets(request.body);
+	record.httpCode = static_cast<qint32>(response.http_code);
+	record.curlError = response.curl_error;
+	record.errorMessage = QByteArray::fromStdString(response.error_message);
+	record.responseBody = RedactSecrets(response.body);
+
+	std::lock_guard<std::mutex> lock(state.mutex);
+	if (state.recordFile.isOpen()) {
+		state.recordStream << record;
+		state.recordFile.flush();
+		state.recordCount++;
+	}
+
+	return response;
+}
+
+HttpResponse HttpTransportPerform(const HttpRequest &request)
+{
+	const std::string host = CircuitBreakers::HostOf(request.url);
+	bool probe = false;
+	if (!CircuitBreakers::get().Allow(host, probe)) {
+		HttpResponse response = {-1, "", true, host + " is unreachable; waiting before trying again"};
+		response.circuit_open = true;
+		return response;
+	}
+
+	HttpResponse response = PerformInMode(request);
+	CircuitBreakers::get().Record(host, probe, !response.curl_error && response.http_code < 500);
+	return response;
+}
@@ -0,0 +1,42 @@
+#ifndef HTTP_TRANSPORT_H
+#define HTTP_TRANSPORT_H
+
+#include <string>
+#include <vector>
+
+struct HttpRequest {
+	std::string url;
+	std::string method = "GET";
+	std::string body;
+	std::vector<std::string> headers;
+	// Endpoint nas estatísticas; vazio = derivado da URL (ver TransportStats::EndpointKey).
+	std::string statsKey;
+};
+
+struct HttpResponse {
+	long http_code = 0;
+	std::string body;
+	bool curl_error = false;
+	std::string error_message;
+	// Barrada pelo disjuntor do host, sem tocar a rede (curl_error também vem ligado).
+	bool circuit_open = false;
+};
+
+// Camada única por onde passam todas as requisições HTTP do plugin (API e refresh de token).
+//
+// Modos, escolhidos uma vez pelas variáveis de ambiente:
+//  - NIGHTBOT_SR_HTTP_RECORD=<arquivo>  rede real, gravando cada par requisição/resposta com o tempo.
+//  - NIGHTBOT_SR_HTTP_REPLAY=<arquivo>  sem rede; responde com o que foi gravado.
+//  - NIGHTBOT_SR_HTTP_REPLAY_SPEED=<x>  escala do tempo no replay (1 = original, 0 = sem espera).
+// Cada host passa por um disjuntor (ver CircuitBreakers): fora do ar, as requisições falham na hora.
+HttpResponse HttpTransportPerform(const HttpRequest &request);
+
+// Substitui access_token/refresh_token nas gravações. No replay, é o token das contas em memória.
+inline constexpr const char *HTTP_REDACTED_TOKEN = "nightbot-sr-redacted-token";
+// NIGHTBOT_SR_HTTP_REPLAY definido: nenhuma requisição vai para a rede e as contas não são gravadas.
+bool HttpTransportReplaying();
+
+void EnsureNightbotNetwork();
+void ShutdownHttpTransport();
+
+#endif // HTTP_TRANSPORT_H
@@ -0,0 +1,135 @@
+#include "metrics-server.h"
+#include "plugin-metrics.h"
+#include "plugin-support.h"
+
+#include <QHash>
+#include <QHostAddress>
+#include <QPointer>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QThread>
+#include <QTimer>
+
+#include <mutex>
+
+// Intervalo de regeneração do buffer; scrapes entre duas regenerações recebem o mesmo texto.
+static const int METRICS_REBUILD_MS = 2000;
+// Cabeçalhos de um GET nunca passam disso; acima, a conexão é descartada.
+static const qsizetype METRICS_MAX_REQUEST = 8192;
+
+class MetricsEndpoint : public QObject {
+public:
+	MetricsEndpoint() : server(new QTcpServer(this)), rebuildTimer(new QTimer(this))
+	{
+		rebuildTimer->setInterval(METRICS_REBUILD_MS);
+		connect(rebuildTimer, &QTimer::timeout, this, [this]() { body = RenderPrometheusMetrics(); });
+		connect(server, &QTcpServer::newConnection, this, [this]() { OnConnection(); });
+	}
+
+	void Listen(int newPort)
+	{
+		if (newPort == port && (port == 0 || server->isListening()))
+			return;
+
+		server->close();
+		rebuildTimer->stop();
+		port = newPort;
+		if (port == 0) {
+			obs_log_info("[Nightbot SR/Metrics] Metrics endpoint disabled.");
+			return;
+		}
+
+		if (!server->listen(QHostAddress::LocalHost, static_cast<quint16>(port))) {
+			obs_log_warning("[Nightbot SR/Metrics] Could not listen on 127.0.0.1:%d: %s", port,
+					server->errorString().toUtf8().constData());
+			return;
+		}
+
+		body = RenderPrometheusMetrics();
+		rebuildTimer->start();
+		obs_log_info("[Nightbot SR/Metrics] Serving metrics on http://127.0.0.1:%d/metrics", port);
+	}
+
+private:
+	void OnConnection()
+	{
+		while (QTcpSocket *socket = server->nextPendingConnection()) {
+			connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+				pending.remove(socket);
+				socket->deleteLater();
+			});
+			connect(socket, &QTcpSocket::readyRead, socket, [this, socket]() { OnReadyRead(socket); });
+		}
+	}
+
+	void OnReadyRead(QTcpSocket *socket)
+	{
+		QByteArray &request = pending[socket];
+		request += socket->readAll();
+		if (request.size() > METRICS_MAX_REQUEST) {
+			pending.remove(socket);
+			socket->abort();
+			return;
+		}
+		if (!request.contains("\r\n\r\n"))
+			return;
+
+		QList<QByteArray> requestLine = request.left(request.indexOf("\r\n")).split(' ');
+		pending.remove(socket);
+
+		const bool found = requestLine.size() >= 2 && requestLine.at(0) == "GET" &&
+				   (requestLine.at(1) == "/metrics" || requestLine.at(1).startsWith("/metrics?"));
+
+		QByteArray head = found ? "HTTP/1.1 200 OK\r\nContent-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+					: "HTTP/1.1 404 Not Found\r\nContent-Type: text/plain\r\n";
+		const QByteArray &payload = found ? body : QByteArray("Not Found\n");
+		head += "Content-Length: " + QByteArray::number(payload.size()) + "\r\nConnection: close\r\n\r\n";
+
+		socket->write(head);
+		socket->write(payload);
+		socket->disconnectFromHost();
+	}
+
+	QTcpServer *server;
+	QTimer *rebuildTimer;
+	QByteArray body;
+	QHash<QTcpSocket *, QByteArray> pending;
+	int port = 0;
+};
+
+static std::mutex g_metricsMutex;
+static QThread *g_metricsThread = nullptr;
+static QPointer<MetricsEndpoint> g_metricsEndpoint;
+
+void ApplyMetricsPort(int port)
+{
+	std::lock_guard<std::mutex> lock(g_metricsMutex);
+
+	// A thread só é criada quando o endpoint é ligado pela primeira vez.
+	if (!g_metricsThread) {
+		if (port == 0)
+			return;
+
+		g_metricsThread = new QThread();
+		g_metricsThread->setObjectName("Nightbot Metrics");
+		g_metricsEndpoint = new MetricsEndpoint();
+		g_metricsEndpoint->moveToThread(g_metricsThread);
+		QObject::connect(g_metricsThread, &QThread::finished, g_metricsEndpoint, &QObject::deleteLater);
+		g_metricsThread->start();
+	}
+
+	MetricsEndpoint *endpoint = g_metricsEndpoint;
+	QMetaObject::invokeMethod(endpoint, [endpoint, port]() { endpoint->Listen(port); }, Qt::QueuedConnection);
+}
+
+void ShutdownMetricsServer()
+{
+	std::lock_guard<std::mutex> lock(g_metricsMutex);
+	if (!g_metricsThread)
+		return;
+
+	g_metricsThread->quit();
+	g_metricsThread->wait();
+	delete g_metricsThread;
+	g_metricsThread = nullptr;
+}
@@ -0,0 +1,11 @@
+#ifndef METRICS_SERVER_H
+#define METRICS_SERVER_H
+
+// Endpoint /metrics (formato Prometheus) em 127.0.0.1, numa QThread própria.
+// O texto é gerado periodicamente nessa thread; cada scrape só escreve o buffer pronto.
+
+// Liga, troca de porta ou desliga (port == 0). Pode ser chamado de qualquer thread.
+void ApplyMetricsPort(int port);
+void ShutdownMetricsServer();
+
+#endif // METRICS_SERVER_H
@@ -0,0 +1,366 @@
+#include "moderation-engine.h"
+#include "nightbot-api.h"
+#include "play-history.h"
+#include "queue-eta.h"
+#include "request-history.h"
+#include "trace-recorder.h"
+#include "plugin-support.h"
+
+#include <QDateTime>
+
+#include <deque>
+#include <iterator>
+#include <utility>
+
+static const uint32_t WORD_TAG = 1;
+static const uint32_t ARTIST_TAG = 2;
+// Músicas tocadas guardadas para o período de espera antes de limpar as vencidas.
+static const int COOLDOWN_PRUNE_SIZE = 512;
+
+void KeywordMatcher::Add(const QString &pattern, uint32_t tag)
+{
+	if (!pattern.isEmpty())
+		patterns.push_back({pattern, tag});
+}
+
+void KeywordMatcher::Clear()
+{
+	patterns.clear();
+	nodes.clear();
+	edges.clear();
+}
+
+int32_t KeywordMatcher::Next(int32_t node, char16_t c) const
+{
+	auto it = edges.find((static_cast<uint64_t>(node) << 16) | static_cast<uint64_t>(c));
+	return it == edges.end() ? -1 : it->second;
+}
+
+void KeywordMatcher::Build()
+{
+	nodes.assign(1, Node());
+	edges.clear();
+
+	for (size_t i = 0; i < patterns.size(); ++i) {
+		int32_t node = 0;
+		for (const QChar c : patterns[i].text) {
+			const uint64_t key = (static_cast<uint64_t>(node) << 16) | static_cast<uint64_t>(c.unicode());
+			auto it = edges.find(key);
+			if (it == edges.end()) {
+				nodes.emplace_back();
+				it = edges.emplace(key, static_cast<int32_t>(nodes.size() - 1)).first;
+			}
+			node = it->second;
+		}
+		Node &end = nodes[static_cast<size_t>(node)];
+		if (end.pattern < 0)
+			end.pattern = static_cast<int32_t>(i);
+		end.tags |= patterns[i].tag;
+	}
+
+	// Falhas em largura: o nó de falha é sempre mais raso, então já está pronto quando chega a vez do filho.
+	std::vector<std::vector<std::pair<char16_t, int32_t>>> children(nodes.size());
+	for (const auto &[key, child] : edges)
+		children[static_cast<size_t>(key >> 16)].emplace_back(static_cast<char16_t>(key & 0xFFFF), child);
+
+	std::deque<int32_t> pending;
+	for (const auto &[c, child] : children[0])
+		pending.push_back(child);
+
+	while (!pending.empty()) {
+		const int32_t node = pending.front();
+		pending.pop_front();
+		Node &current = nodes[static_cast<size_t>(node)];
+		current.output = current.pattern >= 0 ? node : nodes[static_cast<size_t>(current.fail)].output;
+
+		for (const auto &[c, child] : children[static_cast<size_t>(node)]) {
+			int32_t fail = current.fail;
+			int32_t next = Next(fail, c);
+			while (next < 0 && fail != 0) {
+				fail = nodes[static_cast<size_t>(fail)].fail;
+				next = Next(fail, c);
+			}
+			nodes[static_cast<size_t>(child)].fail = (next >= 0 && next != child) ? next : 0;
+			pending.push_back(child);
+		}
+	}
+}
+
+int KeywordMatcher::Find(const QString &text, uint32_t tagMask) const
+{
+	if (nodes.size() <= 1)
+		return -1;
+
+	int32_t state = 0;
+	for (const QChar qc : text) {
+		const char16_t c = qc.unicode();
+		int32_t next = Next(state, c);
+		while (next < 0 && state != 0) {
+			state = nodes[static_cast<size_t>(state)].fail;
+			next = Next(state, c);
+		}
+		state = next < 0 ? 0 : next;
+
+		for (int32_t out = nodes[static_cast<size_t>(state)].output; out != 0;
+		     out = nodes[static_cast<size_t>(nodes[static_cast<size_t>(out)].fail)].output) {
+			const Node &match = nodes[static_cast<size_t>(out)];
+			if (match.tags & tagMask)
+				return match.pattern;
+		}
+	}
+	return -1;
+}
+
+ModerationEngine &ModerationEngine::get()
+{
+	static ModerationEngine instance;
+	return instance;
+}
+
+QString ModerationEngine::RuleText(ModerationRule rule)
+{
+	switch (rule) {
+	case ModerationRule::BannedWord:
+		return get_obs_text("Nightbot.Moderation.Rule.BannedWord");
+	case ModerationRule::BannedArtist:
+		return get_obs_text("Nightbot.Moderation.Rule.BannedArtist");
+	case ModerationRule::MaxDuration:
+		return get_obs_text("Nightbot.Moderation.Rule.MaxDuration");
+	case ModerationRule::MaxPerUser:
+		return get_obs_text("Nightbot.Moderation.Rule.MaxPerUser");
+	case ModerationRule::Duplicate:
+		return get_obs_text("Nightbot.Moderation.Rule.Duplicate");
+	case ModerationRule::Cooldown:
+		return get_obs_text("Nightbot.Moderation.Rule.Cooldown");
+	case ModerationRule::Count:
+		break;
+	}
+	return QString();
+}
+
+void ModerationEngine::ResetHits()
+{
+	for (auto &counter : hits)
+		counter.store(0);
+}
+
+void ModerationEngine::Configure(const ModerationSettings &newSettings)
+{
+	const bool rulesChanged = newSettings.bannedWords != settings.bannedWords ||
+				  newSettings.bannedArtists != settings.bannedArtists || matcher.IsEmpty();
+	const bool wasEnabled = settings.enabled;
+	settings = newSettings;
+
+	// Desligado, nada é acompanhado: ao religar, a fila do momento é aprendida de novo.
+	if (!settings.enabled) {
+		seeded = false;
+		flagged.clear();
+		if (wasEnabled)
+			obs_log_info("[Nightbot SR/Moderation] Moderation disabled.");
+		return;
+	}
+
+	if (rulesChanged) {
+		matcher.Clear();
+		auto addLines = [this](const QString &lines, uint32_t tag) {
+			for (const QString &line : lines.split('\n', Qt::SkipEmptyParts)) {
+				const QString normalized = HistoryIndex::Normalize(line);
+				if (normalized.size() > 1)
+					matcher.Add(normalized + ' ', tag);
+			}
+		};
+		addLines(settings.bannedWords, WORD_TAG);
+		addLines(settings.bannedArtists, ARTIST_TAG);
+		matcher.Build();
+	}
+
+	obs_log_info("[Nightbot SR/Moderation] Rules updated (%s): max %d s, %d per user, duplicates %s, "
+		     "cooldown %d min.",
+		     settings.autoDelete ? "delete" : "flag", settings.maxDuration, settings.maxPerUser,
+		     settings.blockDuplicates ? "blocked" : "allowed", settings.cooldownMinutes);
+}
+
+ModerationEngine::Tracked ModerationEngine::KeysFor(const SongItem &item)
+{
+	Tracked keys;
+	// A música tocando não ocupa vaga de quem pediu.
+	if (item.position != 0)
+		keys.userKey = item.user.toLower();
+	keys.urlKey = item.url;
+	const QString title = HistoryIndex::Normalize(item.title);
+	if (title.size() > 1)
+		keys.titleKey = title;
+	return keys;
+}
+
+void ModerationEngine::Track(const QString &id, const Tracked &keys)
+{
+	tracked.insert(id, keys);
+	if (!keys.counted)
+		return;
+	if (!keys.userKey.isEmpty())
+		userCounts[keys.userKey]++;
+	if (!keys.urlKey.isEmpty())
+		urlCounts[keys.urlKey]++;
+	if (!keys.titleKey.isEmpty())
+		titleCounts[keys.titleKey]++;
+}
+
+void ModerationEngine::Untrack(const QString &id)
+{
+	auto it = tracked.find(id);
+	if (it == tracked.end())
+		return;
+
+	auto decrement = [](QHash<QString, int> &counts, const QString &key) {
+		if (key.isEmpty())
+			return;
+		auto count = counts.find(key);
+		if (count != counts.end() && --count.value() <= 0)
+			counts.erase(count);
+	};
+	if (it->counted) {
+		decrement(userCounts, it->userKey);
+		decrement(urlCounts, it->urlKey);
+		decrement(titleCounts, it->titleKey);
+	}
+	tracked.erase(it);
+}
+
+void ModerationEngine::Seed(const std::string &newAccount, const QList<SongItem> &queue)
+{
+	account = newAccount;
+	seeded = true;
+	tracked.clear();
+	userCounts.clear();
+	urlCounts.clear();
+	titleCounts.clear();
+	flagged.clear();
+	lastPlayedMs.clear();
+
+	for (const SongItem &item : queue) {
+		Tracked keys = KeysFor(item);
+		keys.counted = true;
+		Track(item.id, keys);
+	}
+	currentId = (!queue.isEmpty() && queue.first().position == 0) ? queue.first().id : QString();
+
+	// O período de espera vale também para o que tocou antes do OBS abrir.
+	for (const PlayRecord &record :
+	     PlayHistory::get().Recent(PlayHistory::RECENT_CAPACITY, QString::fromStdString(account))) {
+		const QString title = HistoryIndex::Normalize(record.title);
+		if (title.size() > 1 && !lastPlayedMs.contains(title))
+			lastPlayedMs.insert(title, record.endMs);
+	}
+
+	obs_log_info("[Nightbot SR/Moderation] Watching the queue of %s (%d song(s) already in it).", account.c_str(),
+		     static_cast<int>(queue.size()));
+}
+
+ModerationRule ModerationEngine::Check(const SongItem &item, const Tracked &keys, QString *detail)
+{
+	// Artistas proibidos também valem no título: muitos vídeos são "Artista - Música".
+	if (!matcher.IsEmpty()) {
+		for (const QString &field : {item.title, item.artist}) {
+			const int found = matcher.Find(HistoryIndex::Normalize(field) + ' ', WORD_TAG | ARTIST_TAG);
+			if (found >= 0) {
+				*detail = matcher.PatternText(found).trimmed();
+				return matcher.PatternTag(found) == ARTIST_TAG ? ModerationRule::BannedArtist
+									       : ModerationRule::BannedWord;
+			}
+		}
+	}
+
+	if (settings.maxDuration > 0 && item.duration > settings.maxDuration) {
+		*detail = QueueEta::FormatSeconds(item.duration);
+		return ModerationRule::MaxDuration;
+	}
+
+	if (settings.maxPerUser > 0 && !keys.userKey.isEmpty() &&
+	    userCounts.value(keys.userKey) >= settings.maxPerUser) {
+		*detail = item.user;
+		return ModerationRule::MaxPerUser;
+	}
+
+	if (settings.blockDuplicates && ((!keys.urlKey.isEmpty() && urlCounts.contains(keys.urlKey)) ||
+					 (!keys.titleKey.isEmpty() && titleCounts.contains(keys.titleKey))))
+		return ModerationRule::Duplicate;
+
+	if (settings.cooldownMinutes > 0 && !keys.titleKey.isEmpty()) {
+		auto played = lastPlayedMs.constFind(keys.titleKey);
+		if (played != lastPlayedMs.constEnd() &&
+		    QDateTime::currentMSecsSinceEpoch() - played.value() < int64_t(settings.cooldownMinutes) * 60000)
+			return ModerationRule::Cooldown;
+	}
+
+	return ModerationRule::Count;
+}
+
+int ModerationEngine::Evaluate(const std::string &sessionAccount, const QList<SongItem> &queue,
+			       const SongQueueDiff &diff)
+{
+	auto snapshot = SettingsManager::get().GetSnapshot();
+	// Qualquer configuração muda a versão; só recompila quando as regras mudaram.
+	if (snapshot->version != configuredVersion) {
+		const bool first = configuredVersion == 0;
+		configuredVersion = snapshot->version;
+		if (first || snapshot->moderation != settings)
+			Configure(snapshot->moderation);
+	}
+	if (!settings.enabled)
+		return 0;
+
+	TRACE_SCOPE("ModerationEngine::Evaluate", "ui");
+	if (!seeded || sessionAccount != account) {
+		Seed(sessionAccount, queue);
+		return 0;
+	}
+
+	const int64_t now = QDateTime::currentMSecsSinceEpoch();
+	for (const QString &id : diff.removed) {
+		// A música que estava tocando saiu: começa o período de espera dela.
+		if (id == currentId) {
+			auto it = tracked.constFind(id);
+			if (it != tracked.constEnd() && !it->titleKey.isEmpty())
+				lastPlayedMs.insert(it->titleKey, now);
+		}
+		Untrack(id);
+		flagged.remove(id);
+	}
+	currentId = (!queue.isEmpty() && queue.first().position == 0) ? queue.first().id : QString();
+
+	if (lastPlayedMs.size() > COOLDOWN_PRUNE_SIZE) {
+		const int64_t window = int64_t(settings.cooldownMinutes) * 60000;
+		for (auto it = lastPlayedMs.begin(); it != lastPlayedMs.end();)
+			it = now - it.value() >= window ? lastPlayedMs.erase(it) : std::next(it);
+	}
+
+	QStringList toDelete;
+	for (qsizetype index : diff.addedIndexes) {
+		const SongItem &item = queue.at(index);
+		Tracked keys = KeysFor(item);
+		QString detail;
+		// Ninguém pede a música que já está tocando; ela só entra nas contagens.
+		const ModerationRule rule = item.position == 0 ? ModerationRule::Count : Check(item, keys, &detail);
+		keys.counted = rule == ModerationRule::Count;
+		Track(item.id, keys);
+		if (keys.counted)
+			continue;
+
+		hits[static_cast<size_t>(rule)]++;
+		const QString reason = detail.isEmpty() ? RuleText(rule) : RuleText(rule) + ": " + detail;
+		obs_log_info("[Nightbot SR/Moderation] %s '%s' from %s: %s",
+			     settings.autoDelete ? "Deleting" : "Flagging", item.title.toUtf8().constData(),
+			     item.user.toUtf8().constData(), reason.toUtf8().constData());
+
+		if (settings.autoDelete)
+			toDelete << item.id;
+		else
+			flagged.insert(item.id, reason);
+	}
+
+	// Um lote por leitura, na faixa de fundo e no balde da conta: numa enxurrada de spam as
+	// exclusões não tomam a vez de um skip ou pause do usuário.
+	NightbotAPI::get().RunBatch(NightbotAPI::BatchAction::Delete, toDelete, false);
+	return static_cast<int>(toDelete.size());
+}
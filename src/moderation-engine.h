@@ -0,0 +1,116 @@
+#ifndef MODERATION_ENGINE_H
+#define MODERATION_ENGINE_H
+
+#include <QHash>
+#include <QList>
+#include <QString>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "SettingsManager.h"
+#include "song-queue.h"
+
+// Vários padrões procurados de uma vez (Aho-Corasick): o custo é o tamanho do texto, não
+// importa quantas palavras proibidas existam. Textos e padrões devem vir normalizados por
+// HistoryIndex::Normalize com um espaço no fim, para os padrões casarem só palavras inteiras.
+class KeywordMatcher {
+public:
+	// Cada padrão leva uma marca; Find só aceita padrões cujas marcas estejam em tagMask.
+	void Add(const QString &pattern, uint32_t tag);
+	void Build();
+	void Clear();
+	bool IsEmpty() const { return patterns.empty(); }
+	// Índice do primeiro padrão encontrado, ou -1.
+	int Find(const QString &text, uint32_t tagMask) const;
+	const QString &PatternText(int index) const { return patterns[static_cast<size_t>(index)].text; }
+	uint32_t PatternTag(int index) const { return patterns[static_cast<size_t>(index)].tag; }
+
+private:
+	struct Pattern {
+		QString text;
+		uint32_t tag;
+	};
+	struct Node {
+		int32_t fail = 0;
+		// Padrão que termina aqui, ou -1, e as marcas de todos os padrões iguais a ele.
+		int32_t pattern = -1;
+		uint32_t tags = 0;
+		// Nó mais próximo na cadeia de falhas que termina um padrão, ou 0.
+		int32_t output = 0;
+	};
+
+	int32_t Next(int32_t node, char16_t c) const;
+
+	std::vector<Pattern> patterns;
+	std::vector<Node> nodes;
+	// (nó << 16 | caractere) -> nó filho.
+	std::unordered_map<uint64_t, int32_t> edges;
+};
+
+enum class ModerationRule { BannedWord, BannedArtist, MaxDuration, MaxPerUser, Duplicate, Cooldown, Count };
+
+// Regras de moderação avaliadas a cada leitura ao vivo da fila, só para os pedidos novos:
+// contagens por pessoa, músicas na fila e músicas tocadas recentemente são mantidas
+// incrementalmente com o que entrou e saiu, então o custo é O(novos), não O(fila).
+// A primeira leitura de uma conta só aprende a fila; o que já estava lá não é julgado.
+// Só na thread da UI; os contadores podem ser lidos de qualquer thread.
+class ModerationEngine {
+public:
+	static ModerationEngine &get();
+
+	// Retorna quantos pedidos foram apagados (o chamador deve atualizar a fila depois).
+	int Evaluate(const std::string &account, const QList<SongItem> &queue, const SongQueueDiff &diff);
+	// Motivo pelo qual o pedido foi marcado; vazio se não foi.
+	QString FlagReason(const QString &songId) const { return flagged.value(songId); }
+
+	uint64_t Hits(ModerationRule rule) const { return hits[static_cast<size_t>(rule)].load(); }
+	void ResetHits();
+	static QString RuleText(ModerationRule rule);
+
+	ModerationEngine(ModerationEngine const &) = delete;
+	void operator=(ModerationEngine const &) = delete;
+
+private:
+	ModerationEngine() = default;
+
+	struct Tracked {
+		QString userKey;
+		QString urlKey;
+		QString titleKey;
+		// Pedidos barrados não contam para os limites.
+		bool counted = false;
+	};
+
+	void Configure(const ModerationSettings &settings);
+	void Seed(const std::string &account, const QList<SongItem> &queue);
+	void Track(const QString &id, const Tracked &tracked);
+	void Untrack(const QString &id);
+	// Regra violada pelo pedido, ou Count. "detail" recebe o trecho que casou, se houver.
+	ModerationRule Check(const SongItem &item, const Tracked &tracked, QString *detail);
+
+	static Tracked KeysFor(const SongItem &item);
+
+	uint64_t configuredVersion = 0;
+	ModerationSettings settings;
+	KeywordMatcher matcher;
+
+	std::string account;
+	bool seeded = false;
+	QString currentId;
+	QHash<QString, Tracked> tracked;
+	QHash<QString, int> userCounts;
+	QHash<QString, int> urlCounts;
+	QHash<QString, int> titleCounts;
+	// Título normalizado -> quando terminou de tocar.
+	QHash<QString, int64_t> lastPlayedMs;
+	QHash<QString, QString> flagged;
+
+	std::array<std::atomic<uint64_t>, static_cast<size_t>(ModerationRule::Count)> hits{};
+};
+
+#endif // MODERATION_ENGINE_H
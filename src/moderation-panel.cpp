@@ -0,0 +1,192 @@
+#include "moderation-panel.h"
+#include "moderation-engine.h"
+#include "SettingsManager.h"
+#include "plugin-support.h"
+#include "ui-stall-detector.h"
+
+#include <QCheckBox>
+#include <QComboBox>
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QPlainTextEdit>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QStringList>
+#include <QTimer>
+#include <QVBoxLayout>
+
+// As listas são gravadas um pouco depois da última tecla, não a cada caractere.
+static const int MODERATION_SAVE_DELAY_MS = 800;
+static const int MODERATION_HITS_REFRESH_MS = 2000;
+
+ModerationPanel::ModerationPanel(QWidget *parent) : QWidget(parent)
+{
+	const ModerationSettings &current = SettingsManager::get().GetSnapshot()->moderation;
+	QVBoxLayout *layout = new QVBoxLayout(this);
+
+	enabledCheckBox = new QCheckBox(get_obs_text("Nightbot.Moderation.Enable"));
+	enabledCheckBox->setToolTip(get_obs_text("Nightbot.Moderation.Enable.Tooltip"));
+	enabledCheckBox->setChecked(current.enabled);
+	layout->addWidget(enabledCheckBox);
+
+	QFormLayout *form = new QFormLayout();
+
+	actionComboBox = new QComboBox();
+	actionComboBox->addItem(get_obs_text("Nightbot.Moderation.Action.Flag"));
+	actionComboBox->addItem(get_obs_text("Nightbot.Moderation.Action.Delete"));
+	actionComboBox->setCurrentIndex(current.autoDelete ? 1 : 0);
+	form->addRow(get_obs_text("Nightbot.Moderation.Action"), actionComboBox);
+
+	bannedWordsEdit = new QPlainTextEdit(current.bannedWords);
+	bannedWordsEdit->setToolTip(get_obs_text("Nightbot.Moderation.BannedWords.Tooltip"));
+	bannedWordsEdit->setMaximumHeight(90);
+	form->addRow(get_obs_text("Nightbot.Moderation.BannedWords"), bannedWordsEdit);
+
+	bannedArtistsEdit = new QPlainTextEdit(current.bannedArtists);
+	bannedArtistsEdit->setToolTip(get_obs_text("Nightbot.Moderation.BannedWords.Tooltip"));
+	bannedArtistsEdit->setMaximumHeight(90);
+	form->addRow(get_obs_text("Nightbot.Moderation.BannedArtists"), bannedArtistsEdit);
+
+	maxDurationSpinBox = new QSpinBox();
+	maxDurationSpinBox->setRange(0, 60 * 60);
+	maxDurationSpinBox->setSingleStep(30);
+	maxDurationSpinBox->setSuffix(" s");
+	maxDurationSpinBox->setSpecialValueText(get_obs_text("Nightbot.Moderation.Off"));
+	maxDurationSpinBox->setValue(current.maxDuration);
+	form->addRow(get_obs_text("Nightbot.Moderation.MaxDuration"), maxDurationSpinBox);
+
+	maxPerUserSpinBox = new QSpinBox();
+	maxPerUserSpinBox->setRange(0, 100);
+	maxPerUserSpinBox->setSpecialValueText(get_obs_text("Nightbot.Moderation.Off"));
+	maxPerUserSpinBox->setValue(current.maxPerUser);
+	form->addRow(get_obs_text("Nightbot.Moderation.MaxPerUser"), maxPerUserSpinBox);
+
+	cooldownSpinBox = new QSpinBox();
+	cooldownSpinBox->setRange(0, 24 * 60);
+	cooldownSpinBox->setSingleStep(15);
+	cooldownSpinBox->setSuffix(" min");
+	cooldownSpinBox->setSpecialValueText(get_obs_text("Nightbot.Moderation.Off"));
+	cooldownSpinBox->setValue(current.cooldownMinutes);
+	cooldownSpinBox->setToolTip(get_obs_text("Nightbot.Moderation.Cooldown.Tooltip"));
+	form->addRow(get_obs_text("Nightbot.Moderation.Cooldown"), cooldownSpinBox);
+
+	duplicatesCheckBox = new QCheckBox(get_obs_text("Nightbot.Moderation.Duplicates"));
+	duplicatesCheckBox->setChecked(current.blockDuplicates);
+	form->addRow(duplicatesCheckBox);
+	layout->addLayout(form);
+
+	const FairQueueSettings &fairQueue = SettingsManager::get().GetSnapshot()->fairQueue;
+	fairQueueCheckBox = new QCheckBox(get_obs_text("Nightbot.Moderation.FairQueue"));
+	fairQueueCheckBox->setToolTip(get_obs_text("Nightbot.Moderation.FairQueue.Tooltip"));
+	fairQueueCheckBox->setChecked(fairQueue.enabled);
+	fairWindowSpinBox = new QSpinBox();
+	fairWindowSpinBox->setRange(1, 50);
+	fairWindowSpinBox->setValue(fairQueue.window);
+	fairWindowSpinBox->setToolTip(get_obs_text("Nightbot.Moderation.FairQueue.Window.Tooltip"));
+	QHBoxLayout *fairLayout = new QHBoxLayout();
+	fairLayout->addWidget(fairQueueCheckBox);
+	fairLayout->addStretch();
+	fairLayout->addWidget(new QLabel(get_obs_text("Nightbot.Moderation.FairQueue.Window")));
+	fairLayout->addWidget(fairWindowSpinBox);
+	layout->addLayout(fairLayout);
+
+	hitsLabel = new QLabel();
+	hitsLabel->setWordWrap(true);
+	QPushButton *resetButton = new QPushButton(get_obs_text("Nightbot.Moderation.ResetHits"));
+	QHBoxLayout *hitsLayout = new QHBoxLayout();
+	hitsLayout->addWidget(hitsLabel, 1);
+	hitsLayout->addWidget(resetButton);
+	layout->addLayout(hitsLayout);
+	layout->addStretch();
+
+	saveTimer = new QTimer(this);
+	saveTimer->setSingleShot(true);
+	saveTimer->setInterval(MODERATION_SAVE_DELAY_MS);
+	refreshTimer = new QTimer(this);
+	refreshTimer->setInterval(MODERATION_HITS_REFRESH_MS);
+
+	connect(saveTimer, &QTimer::timeout, this, &ModerationPanel::onSave);
+	connect(refreshTimer, &QTimer::timeout, this, &ModerationPanel::onRefreshHits);
+	connect(resetButton, &QPushButton::clicked, this, &ModerationPanel::onResetHits);
+	connect(enabledCheckBox, &QCheckBox::toggled, this, &ModerationPanel::onChanged);
+	connect(actionComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &ModerationPanel::onChanged);
+	connect(bannedWordsEdit, &QPlainTextEdit::textChanged, this, &ModerationPanel::onChanged);
+	connect(bannedArtistsEdit, &QPlainTextEdit::textChanged, this, &ModerationPanel::onChanged);
+	connect(maxDurationSpinBox, QOverload<int>::of(&QSpinBox::valueChanged), this, &ModerationPanel::onChanged);
+	connect(maxPerUserSpinBox, QOverload<int>::of(&QSpinBox::valueChanged), this, &ModerationPanel::onChanged);
+	connect(cooldownSpinBox, QOverload<int>::of(&QSpinBox::valueChanged), this, &ModerationPanel::onChanged);
+	connect(duplicatesCheckBox, &QCheckBox::toggled, this, &ModerationPanel::onChanged);
+	connect(fairQueueCheckBox, &QCheckBox::toggled, this, &ModerationPanel::onChanged);
+	connect(fairWindowSpinBox, QOverload<int>::of(&QSpinBox::valueChanged), this, &ModerationPanel::onChanged);
+
+	onRefreshHits();
+}
+
+void ModerationPanel::showEvent(QShowEvent *event)
+{
+	QWidget::showEvent(event);
+	onRefreshHits();
+	refreshTimer->start();
+}
+
+void ModerationPanel::hideEvent(QHideEvent *event)
+{
+	QWidget::hideEvent(event);
+	refreshTimer->stop();
+	// Fechar a janela logo depois de digitar não pode perder a edição.
+	if (saveTimer->isActive()) {
+		saveTimer->stop();
+		onSave();
+	}
+}
+
+void ModerationPanel::onChanged()
+{
+	UI_SLOT_SCOPE("ModerationPanel::onChanged");
+	saveTimer->start();
+}
+
+void ModerationPanel::onSave()
+{
+	UI_SLOT_SCOPE("ModerationPanel::onSave");
+	ModerationSettings moderation;
+	moderation.enabled = enabledCheckBox->isChecked();
+	moderation.autoDelete = actionComboBox->currentIndex() == 1;
+	moderation.bannedWords = bannedWordsEdit->toPlainText();
+	moderation.bannedArtists = bannedArtistsEdit->toPlainText();
+	moderation.maxDuration = maxDurationSpinBox->value();
+	moderation.maxPerUser = maxPerUserSpinBox->value();
+	moderation.blockDuplicates = duplicatesCheckBox->isChecked();
+	moderation.cooldownMinutes = cooldownSpinBox->value();
+
+	FairQueueSettings fairQueue;
+	fairQueue.enabled = fairQueueCheckBox->isChecked();
+	fairQueue.window = fairWindowSpinBox->value();
+
+	const auto snapshot = SettingsManager::get().GetSnapshot();
+	if (moderation != snapshot->moderation)
+		SettingsManager::get().SetModeration(moderation);
+	if (fairQueue != snapshot->fairQueue)
+		SettingsManager::get().SetFairQueue(fairQueue);
+}
+
+void ModerationPanel::onRefreshHits()
+{
+	UI_SLOT_SCOPE("ModerationPanel::onRefreshHits");
+	QStringList parts;
+	for (size_t i = 0; i < static_cast<size_t>(ModerationRule::Count); ++i) {
+		const auto rule = static_cast<ModerationRule>(i);
+		parts << QString("%1: %2")
+				 .arg(ModerationEngine::RuleText(rule))
+				 .arg(static_cast<qulonglong>(ModerationEngine::get().Hits(rule)));
+	}
+	hitsLabel->setText(QString(get_obs_text("Nightbot.Moderation.Hits")).arg(parts.join(", ")));
+}
+
+void ModerationPanel::onResetHits()
+{
+	UI_SLOT_SCOPE("ModerationPanel::onResetHits");
+	ModerationEngine::get().ResetHits();
+	onRefreshHits();
+}
@@ -0,0 +1,47 @@
+#ifndef MODERATION_PANEL_H
+#define MODERATION_PANEL_H
+
+#include <QWidget>
+
+class QCheckBox;
+class QComboBox;
+class QLabel;
+class QPlainTextEdit;
+class QSpinBox;
+class QTimer;
+
+// Aba "Moderação" das configurações: regras aplicadas a cada pedido novo, quantas vezes cada uma
+// barrou algo e a ordem justa da fila.
+class ModerationPanel : public QWidget {
+	Q_OBJECT
+
+public:
+	explicit ModerationPanel(QWidget *parent = nullptr);
+
+protected:
+	void showEvent(QShowEvent *event) override;
+	void hideEvent(QHideEvent *event) override;
+
+private slots:
+	void onChanged();
+	void onSave();
+	void onRefreshHits();
+	void onResetHits();
+
+private:
+	QCheckBox *enabledCheckBox;
+	QComboBox *actionComboBox;
+	QPlainTextEdit *bannedWordsEdit;
+	QPlainTextEdit *bannedArtistsEdit;
+	QSpinBox *maxDurationSpinBox;
+	QSpinBox *maxPerUserSpinBox;
+	QCheckBox *duplicatesCheckBox;
+	QSpinBox *cooldownSpinBox;
+	QCheckBox *fairQueueCheckBox;
+	QSpinBox *fairWindowSpinBox;
+	QLabel *hitsLabel;
+	QTimer *saveTimer;
+	QTimer *refreshTimer;
+};
+
+#endif // MODERATION_PANEL_H
@@ -1,7 +1,12 @@
-#include <curl/curl.h>
-
 #include "nightbot-api.h"
 #include "nightbot-auth.h"
+#include "http-transport.h"
+#include "trace-recorder.h"
+#include "plugin-log.h"
+#include "plugin-metrics.h"
+#include "api-scheduler.h"
+#include "nightbot-session.h"
+#include "SettingsManager.h"
 #include "plugin-support.h"
 
 #include <QJsonDocument>
@@ -10,147 +15,167 @@
 #include <QJsonParseError>
 #include <QString>
 #include <QtConcurrent/QtConcurrent>
-#include <QThreadPool>
 #include <QTimer>
 #include <QThread>
 
-static QThreadPool *g_apiThreadPool = nullptr;
+#include <util/platform.h>
+
+#include <functional>
+#include <mutex>
 
 void ShutdownNightbotAPI()
 {
-	if (g_apiThreadPool) {
-		obs_log_info("[Nightbot SR/API] Waiting for threads to finish...");
-		g_apiThreadPool->clear();
-		g_apiThreadPool->waitForDone();
-		delete g_apiThreadPool;
-		g_apiThreadPool = nullptr;
-		obs_log_info("[Nightbot SR/API] Threads finished.");
-	}
+	ApiScheduler::get().Shutdown();
+	ShutdownHttpTransport();
 }
 
-static size_t auth_curl_write_callback(void *contents, size_t size, size_t nmemb, void *userp)
+// Depois de um 429 a conta fica parada esse tempo antes da próxima requisição.
+static const int RATE_LIMITED_BACKOFF_MS = 2000;
+// Requisições de um lote de remoções no scheduler ao mesmo tempo. Deixa uma thread livre
+// para os comandos avulsos; promoções vão uma por vez porque a ordem final depende delas.
+static const int BATCH_DELETE_CONCURRENCY = 3;
+// Um erro igual ao último só volta para a UI depois disso.
+static const uint64_t API_ERROR_REPEAT_NS = 30ull * 1000 * 1000 * 1000;
+
+using SessionPtr = std::shared_ptr<NightbotSession>;
+
+// Comandos do usuário vão para a faixa interativa, com o balde de comandos da conta: a espera
+// deles não depende das consultas, da importação nem dos lotes, que gastam o balde da conta.
+static void StartInteractiveTask(const char *name, const SessionPtr &session, std::function<void()> task,
+				 bool coalesce = false)
 {
-	size_t realsize = size * nmemb;
-	((std::string *)userp)->append((char *)contents, realsize);
-	return realsize;
+	ApiScheduler::get().Submit(ApiScheduler::Lane::Interactive, name, std::move(task), coalesce,
+				   session->CommandRateLimit());
 }
 
-struct HttpRequest {
-	std::string url;
-	std::string method = "GET";
-	std::string body;
-	std::vector<std::string> headers;
-};
+// Consultas e leituras em segundo plano. Por padrão, uma consulta igual da mesma conta ainda na
+// fila é substituída, então polls acumulados numa rede lenta viram uma só requisição.
+static void StartBackgroundTask(const char *name, const SessionPtr &session, std::function<void()> task,
+				bool coalesce = true)
+{
+	ApiScheduler::get().Submit(ApiScheduler::Lane::Background, name, std::move(task), coalesce,
+				   session->RateLimit());
+}
 
-struct HttpResponse {
-	long http_code = 0;
-	std::string body;
-	bool curl_error = false;
-	std::string error_message;
-};
+static std::string ApiUrl(const std::string &path)
+{
+	return SettingsManager::get().GetSnapshot()->apiBaseUrl + path;
+}
+
+// Com a rede fora, cada poll falha igual; a UI só precisa ouvir o mesmo erro uma vez por janela.
+static void SignalApiError(const QString &message)
+{
+	static std::mutex mutex;
+	static QString lastMessage;
+	static uint64_t lastNs = 0;
+	const uint64_t nowNs = os_gettime_ns();
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (message == lastMessage && nowNs - lastNs < API_ERROR_REPEAT_NS)
+			return;
+		lastMessage = message;
+		lastNs = nowNs;
+	}
+	QMetaObject::invokeMethod(&NightbotAPI::get(), "apiErrorOccurred", Qt::QueuedConnection,
+				  Q_ARG(QString, message));
+}
 
-static bool HandleRequestError(const HttpRequest &request, HttpResponse &response, bool is_retry)
+static bool HandleRequestError(const SessionPtr &session, const HttpRequest &request, HttpResponse &response,
+			       bool is_retry)
 {
+	// O disjuntor já registrou a queda e o dock mostra o estado dele; cada requisição barrada
+	// não vira mais uma linha no log nem mais um alerta.
+	if (response.circuit_open)
+		return false;
+
+	// Erros de uma conta que não está no dock só vão para o log.
+	const bool active = SessionManager::get().IsActive(session);
+
 	if (response.curl_error) {
-		obs_log_error(
-			 "[Nightbot SR/API] %s request to '%s' failed: %s",
-			 request.method.c_str(), request.url.c_str(), response.error_message.c_str());
-		QMetaObject::invokeMethod(&NightbotAPI::get(), "apiErrorOccurred", Qt::QueuedConnection,
-					  Q_ARG(QString, response.error_message.c_str()));
+		PLUGIN_LOG(LogCategory::Api, LogLevel::Error, "%s request to '%s' failed: %s", request.method.c_str(),
+			   request.url.c_str(), response.error_message.c_str());
+		if (active)
+			SignalApiError(QString::fromStdString(response.error_message));
 		return false;
 	}
 
+	if (response.http_code == 429) {
+		PLUGIN_LOG(LogCategory::Api, LogLevel::Warning,
+			   "Rate limited on account %s; pausing its requests for %d ms.", session->Id().c_str(),
+			   RATE_LIMITED_BACKOFF_MS);
+		// O 429 vale para a conta inteira, comandos inclusive.
+		ApiScheduler::get().Throttle(session->RateLimit(), RATE_LIMITED_BACKOFF_MS);
+		ApiScheduler::get().Throttle(session->CommandRateLimit(), RATE_LIMITED_BACKOFF_MS);
+	}
+
 	if (response.http_code == 401) {
 		if (is_retry)
 			return false;
 
-		obs_log_info("[Nightbot SR/API] Received 401 Unauthorized. Attempting to refresh token...");
-		NightbotAuth::RefreshStatus status = NightbotAuth::get().RefreshToken();
+		PLUGIN_LOG(LogCategory::Api, LogLevel::Info,
+			   "Received 401 Unauthorized. Attempting to refresh token...");
+		NightbotAuth::RefreshStatus status = NightbotAuth::get().RefreshToken(session);
 
 		if (status == NightbotAuth::RefreshStatus::WAITING) {
 			int retries = 0;
 			while (status == NightbotAuth::RefreshStatus::WAITING && retries < 10) {
 				QThread::msleep(500);
-				status = NightbotAuth::get().RefreshToken();
+				status = NightbotAuth::get().RefreshToken(session);
 				retries++;
 			}
 		}
 
 		if (status == NightbotAuth::RefreshStatus::DONE) {
-			obs_log_info(
-				"[Nightbot SR/API] Token refreshed. Retrying original request...");
+			PLUGIN_LOG(LogCategory::Api, LogLevel::Info, "Token refreshed. Retrying original request...");
 			return true;
-		} else {
-			obs_log_warning("[Nightbot SR/API] Token refresh failed. Triggering re-authentication.");
+		} else if (status == NightbotAuth::RefreshStatus::UNAVAILABLE) {
+			// Backend fora do ar não quer dizer token inválido: pedir login de novo não ajudaria.
+			PLUGIN_LOG(LogCategory::Api, LogLevel::Warning,
+				   "Token refresh backend is unavailable; keeping account %s until it is back.",
+				   session->Id().c_str());
+			return false;
+		} else if (active) {
+			PLUGIN_LOG(LogCategory::Api, LogLevel::Warning,
+				   "Token refresh failed. Triggering re-authentication.");
 			QTimer::singleShot(0, &NightbotAuth::get(), []() {
 				NightbotAuth::get().Authenticate();
 			});
 			return false;
+		} else {
+			PLUGIN_LOG(LogCategory::Api, LogLevel::Warning, "Token refresh failed for account %s.",
+				   session->Id().c_str());
+			return false;
 		}
 	}
 
 	if (response.http_code >= 400) {
-		obs_log_warning(
-			"[Nightbot SR/API] Request to '%s' failed with HTTP status %ld.",
-			request.url.c_str(), response.http_code);
-		QMetaObject::invokeMethod(&NightbotAPI::get(), "apiErrorOccurred", Qt::QueuedConnection,
-					  Q_ARG(QString, "API Error: " + QString::number(response.http_code)));
+		PLUGIN_LOG(LogCategory::Api, LogLevel::Warning, "Request to '%s' failed with HTTP status %ld.",
+			   request.url.c_str(), response.http_code);
+		if (active)
+			SignalApiError("API Error: " + QString::number(response.http_code));
 		return false;
 	}
 
 	return false;
 }
 
-static HttpResponse PerformRequest(const HttpRequest &request, bool is_retry = false)
+static HttpResponse PerformRequest(const SessionPtr &session, const HttpRequest &request, bool is_retry = false)
 {
-	const std::string &access_token = NightbotAuth::get().GetAccessToken();
+	const std::string access_token = session->AccessToken();
 	if (access_token.empty()) {
-		obs_log_warning("[Nightbot SR/API] "
-				  "Attempt to make %s request without an access token.", request.method.c_str());
+		PLUGIN_LOG(LogCategory::Api, LogLevel::Warning, "Attempt to make %s request without an access token.",
+			   request.method.c_str());
 		return {-1, "", true, "No access token"};
 	}
 
-	CURL *curl = curl_easy_init();
-	if (!curl) {
-		obs_log_error("[Nightbot SR/API] Failed to initialize libcurl.");
-		return {-1, "", true, "cURL init failed"};
-	}
-
-	HttpResponse response;
-	std::string auth_header = "Authorization: Bearer " + access_token;
-	struct curl_slist *headers_list = NULL;
-	headers_list = curl_slist_append(headers_list, auth_header.c_str());
-	for(const auto& header : request.headers) {
-		headers_list = curl_slist_append(headers_list, header.c_str());
-	}
-
-	curl_easy_setopt(curl, CURLOPT_URL, request.url.c_str());
-	curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers_list);
-	curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, auth_curl_write_callback);
-	curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response.body);
-	curl_easy_setopt(curl, CURLOPT_FAILONERROR, 0L);
-	curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, request.method.c_str());
-	curl_easy_setopt(curl, CURLOPT_TIMEOUT, 10L);
-
-	if (request.method == "POST" || request.method == "PUT") {
-		curl_easy_setopt(curl, CURLOPT_POSTFIELDS, request.body.c_str());
-	}
-
-	CURLcode res = curl_easy_perform(curl);
-	curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response.http_code);
-
-	curl_slist_free_all(headers_list);
-	curl_easy_cleanup(curl);
-
-	if (res != CURLE_OK) {
-		response.curl_error = true;
-		response.error_message = curl_easy_strerror(res);
-		response.http_code = -1; // Internal error code for cURL failure
-	}
+	HttpRequest authorized = request;
+	authorized.headers.insert(authorized.headers.begin(), "Authorization: Bearer " + access_token);
+	HttpResponse response = HttpTransportPerform(authorized);
 
 	if (response.curl_error || response.http_code >= 400) {
-		if (HandleRequestError(request, response, is_retry)) {
-			return PerformRequest(request, true);
+		if (HandleRequestError(session, request, response, is_retry)) {
+			PluginMetrics::get().requestRetries.fetch_add(1, std::memory_order_relaxed);
+			return PerformRequest(session, request, true);
 		}
 	}
 
@@ -163,32 +188,43 @@ NightbotAPI &NightbotAPI::get()
 	return instance;
 }
 
-NightbotAPI::NightbotAPI()
-{
-	if (!g_apiThreadPool) {
-		g_apiThreadPool = new QThreadPool();
-		g_apiThreadPool->setMaxThreadCount(4);
-	}
-}
+NightbotAPI::NightbotAPI() {}
 
 void NightbotAPI::FetchUserInfo()
 {
-	g_apiThreadPool->start([this]() {
-		obs_log_info("[Nightbot SR/API] Fetching user info...");
-
-		HttpRequest request = { "https://api.nightbot.tv/1/me" };
-		auto response = PerformRequest(request);
+	auto session = SessionManager::get().Active();
+	StartBackgroundTask("FetchUserInfo", session, [this, session]() {
+		PLUGIN_LOG(LogCategory::Api, LogLevel::Info, "Fetching user info...");
+
+		HttpRequest request = { ApiUrl("/1/me") };
+		auto response = PerformRequest(session, request);
+
+		// O nome fica guardado na conta que fez a busca, mesmo que o dock já tenha trocado de canal.
+		auto deliver = [this, session](const QString &display_name) {
+			QMetaObject::invokeMethod(
+				this,
+				[this, session, display_name]() {
+					if (!display_name.isEmpty())
+						SessionManager::get().Rename(session, display_name.toStdString());
+					if (SessionManager::get().IsActive(session))
+						emit userInfoFetched(display_name);
+				},
+				Qt::QueuedConnection);
+		};
 
 		if (response.http_code == 200) {
 			QJsonParseError parseError;
 			QByteArray response_data = QString::fromStdString(response.body).toUtf8();
-			QJsonDocument doc = QJsonDocument::fromJson(response_data, &parseError);
+			QJsonDocument doc;
+			{
+				TRACE_SCOPE("ParseUserInfo", "json");
+				doc = QJsonDocument::fromJson(response_data, &parseError);
+			}
 
 			if (doc.isNull()) {
-				obs_log_error(
-					 "[Nightbot SR/API] Failed to parse user info response: %s",
-					 parseError.errorString().toUtf8().constData());
-				emit userInfoFetched("");
+				PLUGIN_LOG(LogCategory::Api, LogLevel::Error, "Failed to parse user info response: %s",
+					   parseError.errorString().toUtf8().constData());
+				deliver("");
 				return;
 			}
 
@@ -197,88 +233,66 @@ void NightbotAPI::FetchUserInfo()
 				QJsonObject userObj = rootObj.value("user").toObject();
 				QString display_name = userObj["displayName"].toString();
 
-				obs_log_info("[Nightbot SR/API] Fetched user: %s",
-					 display_name.toUtf8().constData());
-				emit userInfoFetched(display_name);
+				PLUGIN_LOG(LogCategory::Api, LogLevel::Info, "Fetched user: %s",
+					   display_name.toUtf8().constData());
+				deliver(display_name);
 			} else {
-				emit userInfoFetched("");
+				deliver("");
 			}
 		} else {
-			emit userInfoFetched("");
+			deliver("");
 		}
 	});
 }
 
 void NightbotAPI::FetchSongQueue(const QString &playlistUserText)
 {
-	g_apiThreadPool->start([this, playlistUserText]() {
-		QList<SongItem> song_queue;
-
-		HttpRequest request = { "https://api.nightbot.tv/1/song_requests/queue" };
-		auto response = PerformRequest(request);
+	auto session = SessionManager::get().Active();
+	StartBackgroundTask("FetchSongQueue", session, [this, playlistUserText, session]() {
+		HttpRequest request = { ApiUrl("/1/song_requests/queue") };
+		auto response = PerformRequest(session, request);
 
 		if (response.http_code == 200) {
-			QJsonParseError parseError; 
-			QJsonDocument doc = QJsonDocument::fromJson(
-				response.body.c_str(), &parseError);
+			SongQueueParseResult result;
+			QByteArray body = QByteArray::fromRawData(response.body.data(),
+								  static_cast<qsizetype>(response.body.size()));
 
-			if (doc.isNull() || !doc.isObject()) {
-				obs_log_warning("[Nightbot SR/API] Failed to parse song queue response.");
-			} else {
-				QJsonObject rootObj = doc.object();
-
-				if (rootObj.contains("_requestsEnabled")) {
-					bool isEnabled = rootObj["_requestsEnabled"].toBool();
-					emit srStatusFetched(isEnabled);
-				}
-
-				if (rootObj.contains("_currentSong") && rootObj["_currentSong"].isObject()) {
-					QJsonObject songObj = rootObj["_currentSong"].toObject();
-					SongItem item;
-					item.id = songObj["_id"].toString();
-					item.position = 0;
-					QJsonObject trackObj = songObj["track"].toObject();
-					item.title = trackObj["title"].toString();
-					item.artist = trackObj["artist"].toString();
-					item.duration = trackObj["duration"].toInt();
-					if (songObj.contains("user") && songObj["user"].isObject()) {
-						item.user = songObj["user"].toObject()["displayName"].toString();
-					} else {
-						item.user = playlistUserText;
-					}
-					song_queue.append(item);
-				}
-
-				const auto queueArray = rootObj["queue"].toArray();
-				for (const QJsonValue value : queueArray) {
-					QJsonObject songObj = value.toObject();
-					SongItem item;
-					item.id = songObj["_id"].toString();
-					item.position = songObj["_position"].toInt();
-					QJsonObject trackObj = songObj["track"].toObject();
-					item.title = trackObj["title"].toString();
-					item.artist = trackObj["artist"].toString();
-					item.duration = trackObj["duration"].toInt();
-					item.user = songObj["user"].toObject()["displayName"].toString();
-					song_queue.append(item);
-				}
+			if (!ParseSongQueue(body, playlistUserText, result)) {
+				PLUGIN_LOG(LogCategory::Api, LogLevel::Warning, "Failed to parse song queue response.");
+				return;
 			}
 
-			std::sort(song_queue.begin(), song_queue.end(),
-				  [](const SongItem &a, const SongItem &b) {
-					  return a.position < b.position;
-				  });
-		}
+			// A fila fica na conta para a troca de canal mostrar algo na hora; o dock só
+			// recebe o que for da conta ativa.
+			session->StoreQueue(result.queue);
+			if (!SessionManager::get().IsActive(session))
+				return;
 
-		emit songQueueFetched(song_queue);
+			if (result.hasRequestsEnabled)
+				emit srStatusFetched(result.requestsEnabled);
+
+			// Entrega na thread da UI por aqui para o trace mostrar quanto a fila de eventos atrasou o sinal.
+			const uint64_t postedAt = TraceRecorder::Enabled() ? TraceRecorder::NowNs() : 0;
+			QMetaObject::invokeMethod(
+				this,
+				[this, postedAt, session, queue = result.queue]() {
+					if (postedAt)
+						TraceRecorder::get().Async("songQueueFetched", "signal", postedAt,
+									   TraceRecorder::NowNs());
+					if (SessionManager::get().IsActive(session))
+						emit songQueueFetched(queue);
+				},
+				Qt::QueuedConnection);
+		}
 	});
 }
 
 void NightbotAPI::FetchSRSettings()
 {
-	g_apiThreadPool->start([this]() {
-		HttpRequest request = { "https://api.nightbot.tv/1/song_requests" };
-		auto response = PerformRequest(request);
+	auto session = SessionManager::get().Active();
+	StartBackgroundTask("FetchSRSettings", session, [this, session]() {
+		HttpRequest request = { ApiUrl("/1/song_requests") };
+		auto response = PerformRequest(session, request);
 
 		if (response.http_code == 200) {
 			QJsonParseError parseError;
@@ -286,7 +300,8 @@ void NightbotAPI::FetchSRSettings()
 				response.body.c_str(), &parseError);
 
 			if (doc.isNull() || !doc.isObject()) {
-				obs_log_warning("[Nightbot SR/API] Failed to parse SR settings response.");
+				PLUGIN_LOG(LogCategory::Api, LogLevel::Warning,
+					   "Failed to parse SR settings response.");
 				return;
 			}
 
@@ -295,7 +310,8 @@ void NightbotAPI::FetchSRSettings()
 				QJsonObject settingsObj = rootObj["settings"].toObject();
 				if (settingsObj.contains("volume") && settingsObj["volume"].isDouble()) {
 					int volume = settingsObj["volume"].toInt();
-					emit volumeFetched(volume);
+					if (SessionManager::get().IsActive(session))
+						emit volumeFetched(volume);
 				}
 			}
 		}
@@ -304,57 +320,58 @@ void NightbotAPI::FetchSRSettings()
 
 void NightbotAPI::ControlPlay()
 {
-	g_apiThreadPool->start([this]() {
-		obs_log_info("[Nightbot SR/API] Sending PLAY command...");
-		const std::string url =
-			"https://api.nightbot.tv/1/song_requests/queue/play";
+	auto session = SessionManager::get().Active();
+	StartInteractiveTask("ControlPlay", session, [this, session]() {
+		PLUGIN_LOG(LogCategory::Api, LogLevel::Info, "Sending PLAY command...");
+		const std::string url = ApiUrl("/1/song_requests/queue/play");
 		HttpRequest request = { url, "POST" };
-		auto response = PerformRequest(request);
+		auto response = PerformRequest(session, request);
 
 		if (response.http_code >= 200 && response.http_code < 300) {
-			obs_log_info("[Nightbot SR/API] PLAY command successful.");
+			PLUGIN_LOG(LogCategory::Api, LogLevel::Info, "PLAY command successful.");
 		} else {
-			obs_log_warning(
-			     "[Nightbot SR/API] PLAY command failed with HTTP status %ld.",
-			     response.http_code);
+			PLUGIN_LOG(LogCategory::Api, LogLevel::Warning, "PLAY command failed with HTTP status %ld.",
+				   response.http_code);
 		}
 	});
 }
 
 void NightbotAPI::ControlPause()
 {
-	g_apiThreadPool->start([this]() {
-		obs_log_info("[Nightbot SR/API] Sending PAUSE command...");
-		const std::string url =
-			"https://api.nightbot.tv/1/song_requests/queue/pause";
+	auto session = SessionManager::get().Active();
+	StartInteractiveTask("ControlPause", session, [this, session]() {
+		PLUGIN_LOG(LogCategory::Api, LogLevel::Info, "Sending PAUSE command...");
+		const std::string url = ApiUrl("/1/song_requests/queue/pause");
 		HttpRequest request = { url, "POST" };
-		auto response = PerformRequest(request);
+		auto response = PerformRequest(session, request);
 
 		if (response.http_code >= 200 && response.http_code < 300) {
-			obs_log_info("[Nightbot SR/API] PAUSE command successful.");
+			PLUGIN_LOG(LogCategory::Api, LogLevel::Info, "PAUSE command successful.");
 		} else {
-			obs_log_warning(
-			     "[Nightbot SR/API] PAUSE command failed with HTTP status %ld.",
-			     response.http_code);
+			PLUGIN_LOG(LogCategory::Api, LogLevel::Warning, "PAUSE command failed with HTTP status %ld.",
+				   response.http_code);
 		}
 	});
 }
 
 void NightbotAPI::ControlSkip()
 {
-	g_apiThreadPool->start([this]() {
-		obs_log_info("[Nightbot SR/API] Sending SKIP command...");
-		const std::string url = "https://api.nightbot.tv/1/song_requests/queue/skip";
+	auto session = SessionManager::get().Active();
+	StartInteractiveTask("ControlSkip", session, [this, session]() {
+		PLUGIN_LOG(LogCategory::Api, LogLevel::Info, "Sending SKIP command...");
+		const std::string url = ApiUrl("/1/song_requests/queue/skip");
 		HttpRequest request = { url, "POST" };
-		std::ignore = PerformRequest(request);
+		std::ignore = PerformRequest(session, request);
 	});
 }
 
 void NightbotAPI::SetVolume(int volume)
 {
-	g_apiThreadPool->start([this, volume]() {
-		obs_log_info("[Nightbot SR/API] Setting volume to %d...", volume);
-		const std::string url = "https://api.nightbot.tv/1/song_requests";
+	// Arrastar o slider gera vários valores: só o último ainda na fila é enviado.
+	auto session = SessionManager::get().Active();
+	StartInteractiveTask("SetVolume", session, [this, volume, session]() {
+		PLUGIN_LOG(LogCategory::Api, LogLevel::Info, "Setting volume to %d...", volume);
+		const std::string url = ApiUrl("/1/song_requests");
 
 		QJsonObject body;
 		body["volume"] = volume;
@@ -365,8 +382,8 @@ void NightbotAPI::SetVolume(int volume)
 		HttpRequest request = {url, "PUT", put_body};
 		request.headers.push_back("Content-Type: application/json");
 
-		std::ignore = PerformRequest(request);
-	});
+		std::ignore = PerformRequest(session, request);
+	}, true);
 }
 
 void NightbotAPI::DeleteSong(const QString &songId)
@@ -374,59 +391,79 @@ void NightbotAPI::DeleteSong(const QString &songId)
 	if (songId.isEmpty())
 		return;
 
-	g_apiThreadPool->start([songId]() {
-		obs_log_info("[Nightbot SR/API] Deleting song with ID: %s", songId.toUtf8().constData());
-		std::string url = "https://api.nightbot.tv/1/song_requests/queue/" + songId.toStdString();
+	auto session = SessionManager::get().Active();
+	StartInteractiveTask("DeleteSong", session, [songId, session]() {
+		PLUGIN_LOG(LogCategory::Api, LogLevel::Info, "Deleting song with ID: %s", songId.toUtf8().constData());
+		std::string url = ApiUrl("/1/song_requests/queue/" + songId.toStdString());
 		HttpRequest request = { url, "DELETE" };
-		std::ignore = PerformRequest(request);
+		std::ignore = PerformRequest(session, request);
 	});
 }
 
-void NightbotAPI::AddSong(const QString &query)
+// Texto de erro de uma resposta da API: o campo "message" do JSON quando existe, senão o corpo cru.
+static QString ApiErrorMessage(const HttpResponse &response)
 {
-	g_apiThreadPool->start([this, query]() {
-		obs_log_info("[Nightbot SR/API] Adding song with query: %s",
-			     query.toUtf8().constData());
+	if (response.curl_error)
+		return QString::fromStdString(response.error_message);
+
+	QJsonParseError parseError;
+	QJsonDocument errorDoc = QJsonDocument::fromJson(QByteArray::fromStdString(response.body), &parseError);
+	if (!errorDoc.isNull() && errorDoc.isObject() && errorDoc.object().contains("message"))
+		return errorDoc.object()["message"].toString();
+	return QString::fromStdString(response.body);
+}
 
-		QJsonObject body;
-		body["q"] = query;
-		QJsonDocument doc(body);
-		std::string post_body =
-			doc.toJson(QJsonDocument::Compact).toStdString();
+static HttpResponse PostSongRequest(const SessionPtr &session, const QString &query)
+{
+	PLUGIN_LOG(LogCategory::Api, LogLevel::Info, "Adding song with query: %s", query.toUtf8().constData());
 
-		HttpRequest request = {
-			"https://api.nightbot.tv/1/song_requests/queue", "POST",
-			post_body};
-		request.headers.push_back("Content-Type: application/json");
+	QJsonObject body;
+	body["q"] = query;
+	QJsonDocument doc(body);
+	std::string post_body = doc.toJson(QJsonDocument::Compact).toStdString();
 
-		auto response = PerformRequest(request);
+	HttpRequest request = {ApiUrl("/1/song_requests/queue"), "POST", post_body};
+	request.headers.push_back("Content-Type: application/json");
 
-		if (response.http_code == 200) {
+	return PerformRequest(session, request);
+}
+
+void NightbotAPI::AddSong(const QString &query)
+{
+	auto session = SessionManager::get().Active();
+	StartInteractiveTask("AddSong", session, [this, query, session]() {
+		auto response = PostSongRequest(session, query);
+
+		if (!SessionManager::get().IsActive(session))
+			return;
+
+		if (response.http_code == 200)
 			emit songAdded(true, "");
-		} else {
-			QJsonParseError parseError;
-			QJsonDocument errorDoc = QJsonDocument::fromJson(
-				QByteArray::fromStdString(response.body),
-				&parseError);
-			QString finalErrorMsg;
-
-			if (!errorDoc.isNull() && errorDoc.isObject() &&
-			    errorDoc.object().contains("message")) {
-				finalErrorMsg = errorDoc.object()["message"].toString();
-			} else {
-				finalErrorMsg = QString::fromStdString(response.body);
-			}
-			emit songAdded(false, "Error: " + finalErrorMsg);
-		}
+		else
+			emit songAdded(false, "Error: " + ApiErrorMessage(response));
 	});
 }
 
+void NightbotAPI::AddSongFor(const std::shared_ptr<NightbotSession> &session, const QString &query,
+			     std::function<void(bool success, const QString &error)> done)
+{
+	// Importações não têm ninguém esperando cada item: vão na faixa de background, sem juntar pedidos.
+	StartBackgroundTask("ImportSong", session, [session, query, done = std::move(done)]() {
+		auto response = PostSongRequest(session, query);
+		if (response.http_code == 200)
+			done(true, QString());
+		else
+			done(false, ApiErrorMessage(response));
+	}, false);
+}
+
 void NightbotAPI::SetSREnabled(bool enabled)
 {
-	g_apiThreadPool->start([this, enabled]() {
-		obs_log_info("[Nightbot SR/API] Setting Song Requests to %s...",
-		     enabled ? "Enabled" : "Disabled");
-		const std::string url = "https://api.nightbot.tv/1/song_requests";
+	auto session = SessionManager::get().Active();
+	StartInteractiveTask("SetSREnabled", session, [this, enabled, session]() {
+		PLUGIN_LOG(LogCategory::Api, LogLevel::Info, "Setting Song Requests to %s...",
+			   enabled ? "Enabled" : "Disabled");
+		const std::string url = ApiUrl("/1/song_requests");
 
 		QJsonObject body;
 		body["enabled"] = enabled;
@@ -436,7 +473,7 @@ void NightbotAPI::SetSREnabled(bool enabled)
 		HttpRequest request = { url, "PUT", put_body };
 		request.headers.push_back("Content-Type: application/json");
 
-		std::ignore = PerformRequest(request);
+		std::ignore = PerformRequest(session, request);
 	});
 }
 
@@ -445,10 +482,111 @@ void NightbotAPI::PromoteSong(const QString &songId)
 	if (songId.isEmpty())
 		return;
 
-	g_apiThreadPool->start([songId]() {
-		obs_log_info("[Nightbot SR/API] Promoting song with ID: %s", songId.toUtf8().constData());
-		std::string url = "https://api.nightbot.tv/1/song_requests/queue/" + songId.toStdString() + "/promote";
+	auto session = SessionManager::get().Active();
+	StartInteractiveTask("PromoteSong", session, [songId, session]() {
+		PLUGIN_LOG(LogCategory::Api, LogLevel::Info, "Promoting song with ID: %s", songId.toUtf8().constData());
+		std::string url = ApiUrl("/1/song_requests/queue/" + songId.toStdString() + "/promote");
 		HttpRequest request = { url, "POST" };
-		std::ignore = PerformRequest(request);
+		std::ignore = PerformRequest(session, request);
 	});
 }
+
+// Estado de um lote. Cada requisição que termina puxa o próximo id, então o scheduler
+// nunca recebe mais que o limite do lote e os comandos avulsos não ficam atrás dele.
+struct SongBatch {
+	NightbotAPI::BatchAction action;
+	SessionPtr session;
+	int concurrency;
+	bool report;
+
+	std::mutex mutex;
+	QStringList pending;
+	int inFlight = 0;
+	int succeeded = 0;
+	int failed = 0;
+	QString firstError;
+};
+
+static void PumpBatch(NightbotAPI *api, const std::shared_ptr<SongBatch> &batch);
+
+static void RunBatchItem(NightbotAPI *api, const std::shared_ptr<SongBatch> &batch, const QString &songId)
+{
+	const bool isDelete = batch->action == NightbotAPI::BatchAction::Delete;
+	const std::string path = "/1/song_requests/queue/" + songId.toStdString();
+	HttpRequest request = isDelete ? HttpRequest{ApiUrl(path), "DELETE"}
+				       : HttpRequest{ApiUrl(path + "/promote"), "POST"};
+	auto response = PerformRequest(batch->session, request);
+	const bool ok = !response.curl_error && response.http_code >= 200 && response.http_code < 300;
+	if (!ok)
+		PLUGIN_LOG(LogCategory::Api, LogLevel::Warning, "Batch %s of %s failed (HTTP %ld).",
+			   isDelete ? "delete" : "promote", songId.toUtf8().constData(), response.http_code);
+
+	bool done;
+	{
+		std::lock_guard<std::mutex> lock(batch->mutex);
+		batch->inFlight--;
+		if (ok) {
+			batch->succeeded++;
+		} else {
+			batch->failed++;
+			if (batch->firstError.isEmpty())
+				batch->firstError = response.curl_error ? QString::fromStdString(response.error_message)
+									: "HTTP " + QString::number(response.http_code);
+		}
+		done = batch->pending.isEmpty() && batch->inFlight == 0;
+	}
+
+	if (!done) {
+		PumpBatch(api, batch);
+		return;
+	}
+
+	PLUGIN_LOG(LogCategory::Api, LogLevel::Info, "Batch %s finished: %d succeeded, %d failed.",
+		   isDelete ? "delete" : "promote", batch->succeeded, batch->failed);
+	if (batch->report && SessionManager::get().IsActive(batch->session))
+		QMetaObject::invokeMethod(api, "batchFinished", Qt::QueuedConnection, Q_ARG(int, batch->succeeded),
+					  Q_ARG(int, batch->failed), Q_ARG(QString, batch->firstError));
+}
+
+static void PumpBatch(NightbotAPI *api, const std::shared_ptr<SongBatch> &batch)
+{
+	QStringList starting;
+	{
+		std::lock_guard<std::mutex> lock(batch->mutex);
+		while (batch->inFlight < batch->concurrency && !batch->pending.isEmpty()) {
+			starting << batch->pending.takeFirst();
+			batch->inFlight++;
+		}
+	}
+
+	// Lotes são tráfego em volume: ficam no balde da conta e fora da faixa dos comandos,
+	// para um skip no meio de uma limpeza grande não esperar atrás deles.
+	const char *name = batch->action == NightbotAPI::BatchAction::Delete ? "BatchDelete" : "BatchPromote";
+	for (const QString &songId : starting)
+		StartBackgroundTask(
+			name, batch->session, [api, batch, songId]() { RunBatchItem(api, batch, songId); }, false);
+}
+
+void NightbotAPI::RunBatch(BatchAction action, const QStringList &songIds, bool report)
+{
+	if (songIds.isEmpty())
+		return;
+
+	auto batch = std::make_shared<SongBatch>();
+	batch->action = action;
+	batch->session = SessionManager::get().Active();
+	batch->report = report;
+	if (action == BatchAction::Delete) {
+		batch->concurrency = BATCH_DELETE_CONCURRENCY;
+		batch->pending = songIds;
+	} else {
+		// Cada promoção coloca a música no topo: a última enviada termina em primeiro.
+		batch->concurrency = 1;
+		for (auto it = songIds.crbegin(); it != songIds.crend(); ++it)
+			batch->pending << *it;
+	}
+
+	PLUGIN_LOG(LogCategory::Api, LogLevel::Info, "Starting batch %s of %d song(s).",
+		   action == BatchAction::Delete ? "delete" : "promote", static_cast<int>(songIds.size()));
+	PumpBatch(this, batch);
+}
@@ -2,23 +2,23 @@
 #define NIGHTBOT_API_H
 
 #include <QObject>
+#include <functional>
+#include <memory>
 #include <string>
 #include <QList>
 #include <QString>
+#include <QStringList>
 
-struct SongItem {
-	QString id;
-	QString title;
-	QString artist;
-	QString user;
-	int position;
-	int duration;
-};
+#include "song-queue.h"
+
+class NightbotSession;
 
 class NightbotAPI : public QObject {
 	Q_OBJECT
 
 public:
+	enum class BatchAction { Delete, Promote };
+
 	static NightbotAPI &get();
 
 	void FetchUserInfo();
@@ -30,9 +30,18 @@ public:
 	void ControlSkip();
 	void DeleteSong(const QString &songId);
 	void AddSong(const QString &query);
+	// Como AddSong, mas para uma conta fixa e com o resultado entregue em "done" (na thread da API)
+	// em vez de songAdded. Usado pela importação em massa.
+	void AddSongFor(const std::shared_ptr<NightbotSession> &session, const QString &query,
+			std::function<void(bool success, const QString &error)> done);
 	void PromoteSong(const QString &songId);
 	void SetSREnabled(bool enabled);
 	void SetVolume(int volume);
+	// Várias músicas em um lote: as requisições vão em paralelo (limitado) e batchFinished sai
+	// uma vez no fim. Promoções seguem a ordem da lista, a primeira fica no topo.
+	// Com report = false não há batchFinished: lotes automáticos (moderação) não mexem no
+	// estado de lote do dock.
+	void RunBatch(BatchAction action, const QStringList &songIds, bool report = true);
 
 signals:
 	void userInfoFetched(const QString &userName);
@@ -41,6 +50,7 @@ signals:
 	void srStatusFetched(bool isEnabled);
 	void volumeFetched(int volume);
 	void apiErrorOccurred(const QString &error);
+	void batchFinished(int succeeded, int failed, const QString &firstError);
 
 private:
 	NightbotAPI();
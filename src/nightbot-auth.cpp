@@ -1,6 +1,8 @@
 #include "nightbot-auth.h"
-#include <curl/curl.h>
-#include <atomic>
+#include "http-transport.h"
+#include "trace-recorder.h"
+#include "plugin-metrics.h"
+#include "nightbot-session.h"
 #include <chrono>
 
 #include <QUrl>
@@ -17,27 +19,19 @@
 #include <QJsonObject>
 #include <QJsonParseError>
 
-static const char *BACKEND_BASE_URL = "https://nightbot-obs.areaz12server.net.br";
+NightbotAuth::NightbotAuth(QObject *parent) : QObject(parent) {}
 
-static std::atomic<bool> g_is_refreshing(false);
-static std::chrono::steady_clock::time_point g_last_success_time;
-
-static void LoadState(std::string &access, std::string &refresh)
-{
-	access = SettingsManager::get().GetAccessToken();
-	refresh = SettingsManager::get().GetRefreshToken();
-}
-
-static size_t auth_write_callback(void *contents, size_t size, size_t nmemb, void *userp)
+NightbotAuth::~NightbotAuth()
 {
-	size_t realsize = size * nmemb;
-	((std::string *)userp)->append((char *)contents, realsize);
-	return realsize;
+    if (http_server && http_server->isListening())
+		http_server->close();
 }
 
-NightbotAuth::NightbotAuth(QObject *parent) : QObject(parent)
+void NightbotAuth::EnsureServer()
 {
-	LoadState(access_token, refresh_token);
+	// O servidor local e os timers só são necessários durante o fluxo OAuth.
+	if (http_server)
+		return;
 
 	http_server = new QTcpServer(this);
 	connect(http_server, &QTcpServer::newConnection, this,
@@ -53,19 +47,16 @@ NightbotAuth::NightbotAuth(QObject *parent) : QObject(parent)
 		&NightbotAuth::onSecondElapsed);
 }
 
-NightbotAuth::~NightbotAuth()
+void NightbotAuth::Authenticate(bool newAccount)
 {
-    if (http_server->isListening())
-		http_server->close();
-}
+	EnsureServer();
 
-void NightbotAuth::Authenticate()
-{
 	if (http_server->isListening()) {
 		obs_log_info(
 		     "[Nightbot SR/Auth] Authentication process is already in progress.");
 		return;
 	}
+	adding_account = newAccount;
 
 	if (!http_server->listen(QHostAddress::LocalHost, 8921)) {
 		obs_log_error("[Nightbot SR/Auth] Failed to start local server.");
@@ -80,7 +71,7 @@ void NightbotAuth::Authenticate()
 	countdown_timer->start(1000);
 
 
-	const char *redirect_uri = BACKEND_BASE_URL;
+	const std::string redirect_uri = SettingsManager::get().GetSnapshot()->backendBaseUrl;
 	const char *scopes = "song_requests_queue song_requests";
 
 	QUrl url("https://nightbot.tv/oauth2/authorize");
@@ -88,7 +79,7 @@ void NightbotAuth::Authenticate()
 
 	query.addQueryItem("response_type", "code");
 	query.addQueryItem("client_id", client_id.c_str());
-	query.addQueryItem("redirect_uri", redirect_uri);
+	query.addQueryItem("redirect_uri", QString::fromStdString(redirect_uri));
 	query.addQueryItem("scope", scopes);
 
 	url.setQuery(query);
@@ -96,61 +87,49 @@ void NightbotAuth::Authenticate()
 	QDesktopServices::openUrl(url);
 }
 
-NightbotAuth::RefreshStatus NightbotAuth::RefreshToken()
+NightbotAuth::RefreshStatus NightbotAuth::RefreshToken(const std::shared_ptr<NightbotSession> &session)
 {
-	if (g_is_refreshing)
+	if (session->refreshing.exchange(true))
 		return RefreshStatus::WAITING;
 
 	auto now = std::chrono::steady_clock::now();
-	if (std::chrono::duration_cast<std::chrono::seconds>(now - g_last_success_time).count() < 10) {
+	if (std::chrono::duration_cast<std::chrono::seconds>(now - session->lastRefreshSuccess).count() < 10) {
+		session->refreshing = false;
 		return RefreshStatus::DONE;
 	}
 
+	const std::string refresh_token = session->RefreshToken();
 	if (refresh_token.empty()) {
+		session->refreshing = false;
 		obs_log_warning(
 		     "[Nightbot SR/Auth] No refresh token available to renew.");
 		return RefreshStatus::FAILED;
 	}
 
 	obs_log_info("[Nightbot SR/Auth] Refreshing token...");
-
-	CURL *curl = curl_easy_init();
-	if (!curl) {
-		obs_log_error(
-		     "[Nightbot SR/Auth] Failed to initialize libcurl for token refresh.");
-		return RefreshStatus::FAILED;
-	}
-
-	g_is_refreshing = true;
-
-	std::string readBuffer;
-	std::string refresh_url_str = std::string(BACKEND_BASE_URL) + "/refresh-token";
-	const char *refresh_url = refresh_url_str.c_str();
+	TRACE_SCOPE("RefreshToken", "auth");
 
 	QJsonObject request_body;
 	request_body["refresh_token"] = QString::fromStdString(refresh_token);
 	QJsonDocument doc(request_body);
-	std::string postFields =
-		doc.toJson(QJsonDocument::Compact).toStdString();
-
-	curl_easy_setopt(curl, CURLOPT_URL, refresh_url);
-	curl_easy_setopt(curl, CURLOPT_POST, 1L);
-	curl_easy_setopt(curl, CURLOPT_POSTFIELDS, postFields.c_str());
-	curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, auth_write_callback);
-	curl_easy_setopt(curl, CURLOPT_WRITEDATA, &readBuffer);
-	struct curl_slist *headers = NULL;
-	headers = curl_slist_append(headers, "Content-Type: application/json");
-	curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-
-	CURLcode res = curl_easy_perform(curl);
-	long http_code = 0;
-	curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
+
+	HttpRequest request;
+	request.url = SettingsManager::get().GetSnapshot()->backendBaseUrl + "/refresh-token";
+	request.method = "POST";
+	request.body = doc.toJson(QJsonDocument::Compact).toStdString();
+	request.headers.push_back("Content-Type: application/json");
+
+	HttpResponse response = HttpTransportPerform(request);
+	long http_code = response.http_code;
+	const std::string &readBuffer = response.body;
 
 	bool success = false;
 
-	if (res != CURLE_OK) {
-		obs_log_error("[Nightbot SR/Auth] Token refresh request failed: %s",
-		     curl_easy_strerror(res));
+	if (response.curl_error) {
+		// Com o disjuntor aberto a queda já está no log.
+		if (!response.circuit_open)
+			obs_log_error("[Nightbot SR/Auth] Token refresh request failed: %s",
+			     response.error_message.c_str());
 	} else if (http_code >= 200 && http_code < 300) {
 		QJsonParseError parseError;
 		QJsonDocument doc = QJsonDocument::fromJson(
@@ -164,23 +143,17 @@ NightbotAuth::RefreshStatus NightbotAuth::RefreshToken()
 			QJsonObject data = doc.object();
 			if (data.contains("access_token") &&
 			    data["access_token"].isString()) {
-				access_token =
-					data["access_token"].toString().toStdString();
-				SettingsManager::get().SetAccessToken(access_token);
-
+				std::string new_refresh_token = refresh_token;
 				if (data.contains("refresh_token") &&
-				    data["refresh_token"].isString()) {
-					refresh_token = data["refresh_token"]
-							      .toString()
-							      .toStdString();
-					SettingsManager::get().SetRefreshToken(
-						refresh_token);
-				}
-				SettingsManager::get().Save();
+				    data["refresh_token"].isString())
+					new_refresh_token = data["refresh_token"].toString().toStdString();
+
+				session->SetTokens(data["access_token"].toString().toStdString(), new_refresh_token);
+				SessionManager::get().Persist(session);
 
 				obs_log_info(
-				     "[Nightbot SR/Auth] Token refreshed successfully.");
-				g_last_success_time = std::chrono::steady_clock::now();
+				     "[Nightbot SR/Auth] Token refreshed successfully (%s).", session->Id().c_str());
+				session->lastRefreshSuccess = std::chrono::steady_clock::now();
 				success = true;
 			} else {
 				obs_log_warning(
@@ -191,40 +164,42 @@ NightbotAuth::RefreshStatus NightbotAuth::RefreshToken()
 		obs_log_warning(
 		     "[Nightbot SR/Auth] Token refresh failed with HTTP status %ld. Response: %s",
 		     http_code, readBuffer.c_str());
-		// Se o refresh token for inválido, limpa a sessão e notifica a UI.
+		// Refresh token inválido: a conta perde os tokens mas fica na lista para um novo login.
+		// Só a conta do dock muda o estado de login da UI.
 		if (http_code == 400 || http_code == 401) {
 			obs_log_warning(
-				"[Nightbot SR/Auth] Refresh token is invalid. Clearing session.");
-			ClearTokens();
-			emit authenticationFinished(false);
+				"[Nightbot SR/Auth] Refresh token is invalid. Clearing tokens of account %s.",
+				session->Id().c_str());
+			SessionManager::get().Disconnect(session);
+			if (SessionManager::get().IsActive(session))
+				emit authenticationFinished(false);
 		}
 	}
 
-	curl_slist_free_all(headers);
-	curl_easy_cleanup(curl);
-	g_is_refreshing = false;
-	return success ? RefreshStatus::DONE : RefreshStatus::FAILED;
+	if (success)
+		PluginMetrics::get().tokenRefreshes.fetch_add(1, std::memory_order_relaxed);
+	else
+		PluginMetrics::get().tokenRefreshFailures.fetch_add(1, std::memory_order_relaxed);
+
+	session->refreshing = false;
+	if (success)
+		return RefreshStatus::DONE;
+	return response.curl_error || http_code >= 500 ? RefreshStatus::UNAVAILABLE : RefreshStatus::FAILED;
 }
 
 void NightbotAuth::ClearTokens()
 {
-	access_token.clear();
-	refresh_token.clear();
-
-	SettingsManager::get().SetAccessToken("");
-	SettingsManager::get().SetRefreshToken("");
-	SettingsManager::get().SetUserName("");
-	SettingsManager::get().Save();
+	SessionManager::get().RemoveSession(SessionManager::get().Active()->Id());
 }
 
 bool NightbotAuth::IsAuthenticated()
 {
-	return !access_token.empty();
+	return SessionManager::get().Active()->IsAuthenticated();
 }
 
-const std::string &NightbotAuth::GetAccessToken()
+std::string NightbotAuth::GetAccessToken()
 {
-	return access_token;
+	return SessionManager::get().Active()->AccessToken();
 }
 
 void NightbotAuth::onNewConnection()
@@ -297,12 +272,17 @@ void NightbotAuth::onNewConnection()
 				QJsonObject data = doc.object();
 				if (data.contains("access_token") && data["access_token"].isString() &&
 				    data.contains("refresh_token") && data["refresh_token"].isString()) {
-					access_token = data["access_token"].toString().toStdString();
-					refresh_token = data["refresh_token"].toString().toStdString();
-
-					SettingsManager::get().SetAccessToken(access_token);
-					SettingsManager::get().SetRefreshToken(refresh_token);
-					SettingsManager::get().Save();
+					const std::string access_token = data["access_token"].toString().toStdString();
+					const std::string refresh_token = data["refresh_token"].toString().toStdString();
+
+					if (adding_account) {
+						SessionManager::get().AddSession(access_token, refresh_token);
+					} else {
+						auto session = SessionManager::get().Active();
+						session->SetTokens(access_token, refresh_token);
+						SessionManager::get().Persist(session);
+					}
+					adding_account = false;
 
 					obs_log_info("[Nightbot SR/Auth] Tokens received and saved successfully.");
 					emit authenticationFinished(true);
@@ -332,7 +312,7 @@ void NightbotAuth::onNewConnection()
 
 void NightbotAuth::onAuthTimeout()
 {
-	if (http_server->isListening()) {
+	if (http_server && http_server->isListening()) {
 		obs_log_warning(
 		     "[Nightbot SR/Auth] Authentication timed out after 30 seconds. Server is shutting down.");
 		countdown_timer->stop();
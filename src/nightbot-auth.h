@@ -2,8 +2,11 @@
 #define NIGHTBOT_AUTH_H
 
 #include <QObject>
+#include <memory>
 #include <string>
 
+class NightbotSession;
+
 class QTcpServer;
 class QTcpSocket;
 class QTimer;
@@ -20,15 +23,20 @@ public:
 	enum class RefreshStatus {
 		WAITING,
 		DONE,
-		FAILED
+		FAILED,
+		// Backend de refresh fora do ar (rede, 5xx ou disjuntor aberto); o token pode continuar válido.
+		UNAVAILABLE
 	};
 
-	void Authenticate();
-	RefreshStatus RefreshToken();
+	// Com newAccount, os tokens recebidos viram uma conta nova em vez de substituir a ativa.
+	void Authenticate(bool newAccount = false);
+	RefreshStatus RefreshToken(const std::shared_ptr<NightbotSession> &session);
+	// Desconecta a conta ativa.
 	void ClearTokens();
 	bool IsAuthenticated();
 
-	const std::string &GetAccessToken();
+	// Token da conta ativa (cópia: outra thread pode renová-lo a qualquer momento).
+	std::string GetAccessToken();
 
 signals:
 	void authenticationFinished(bool success);
@@ -43,9 +51,10 @@ private:
 	NightbotAuth(QObject *parent = nullptr);
 	~NightbotAuth();
 
+	void EnsureServer();
+
 	std::string client_id = "148baef93cc409a221dfe21a820efbab";
-	std::string access_token;
-	std::string refresh_token;
+	bool adding_account = false;
 
 	QTcpServer *http_server = nullptr;
 	QTimer *auth_timeout_timer = nullptr;
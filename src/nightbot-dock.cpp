@@ -9,9 +9,15 @@
 #include <QTimer>
 #include <QSlider>
 #include <QLabel>
+#include <QComboBox>
+#include <QAction>
+#include <QMenu>
+#include <QInputDialog>
+#include <QMessageBox>
 #include <QToolTip>
 #include <QHBoxLayout>
 #include <QHeaderView>
+#include <QScrollBar>
 #include <QVBoxLayout>
 #include <QWidget>
 #include <QFile>
@@ -20,14 +26,47 @@
 #include "nightbot-api.h"
 #include "SettingsManager.h"
 #include "nightbot-auth.h"
+#include "nightbot-session.h"
 #include "plugin-support.h"
 #include "song-request-dialog.h"
 #include "nightbot-settings.h"
+#include "queue-cache.h"
+#include "polling-gate.h"
+#include "trace-recorder.h"
+#include "plugin-metrics.h"
+#include "ui-stall-detector.h"
+#include "queue-update-source.h"
+#include "request-history.h"
+#include "play-history.h"
+#include "moderation-engine.h"
+#include "thumbnail-cache.h"
+#include "circuit-breaker.h"
+
+#include <QDateTime>
+
+#include <algorithm>
+#include <optional>
+
+// Com o canal de push conectado, a consulta só serve para pegar eventos perdidos.
+static const int PUSH_RESYNC_INTERVAL_MS = 5 * 60 * 1000;
+// Tempo que o resultado de um lote fica visível no dock.
+static const int BATCH_STATUS_VISIBLE_MS = 10000;
+// Músicas listadas em "Tocadas de ...".
+static const size_t PLAYED_BY_USER_LIMIT = 20;
+// Colunas da fila.
+static const int TITLE_COLUMN = 1;
+static const int ETA_COLUMN = 3;
+static const int ACTIONS_COLUMN = 4;
 
 NightbotDock::NightbotDock() : QWidget(nullptr)
 {
 	QVBoxLayout *mainLayout = new QVBoxLayout();
 
+	// Só aparece com mais de uma conta conectada.
+	channelComboBox = new QComboBox();
+	channelComboBox->setToolTip(get_obs_text("Nightbot.Dock.Channel.Tooltip"));
+	mainLayout->addWidget(channelComboBox);
+
 	QHBoxLayout *controlsLayout = new QHBoxLayout();
 	controlsLayout->setContentsMargins(0, 0, 0, 0);
 
@@ -78,26 +117,74 @@ NightbotDock::NightbotDock() : QWidget(nullptr)
 	mainLayout->addLayout(controlsLayout);
 
 	songQueueTable = new QTableWidget();
-	songQueueTable->setColumnCount(4);
+	songQueueTable->setColumnCount(5);
 
 	QStringList headers;
 	headers << get_obs_text("Nightbot.Queue.Position")
 		<< get_obs_text("Nightbot.Queue.Title")
 		<< get_obs_text("Nightbot.Queue.User")
+		<< get_obs_text("Nightbot.Queue.Eta")
 		<< get_obs_text("Nightbot.Queue.Actions");
 	songQueueTable->setHorizontalHeaderLabels(headers);
 
 	QHeaderView *header = songQueueTable->horizontalHeader();
 	header->setSectionResizeMode(0, QHeaderView::ResizeToContents);
-	header->setSectionResizeMode(1, QHeaderView::Stretch);
+	header->setSectionResizeMode(TITLE_COLUMN, QHeaderView::Stretch);
 	header->setSectionResizeMode(2, QHeaderView::ResizeToContents);
 
-	header->setSectionResizeMode(3, QHeaderView::ResizeToContents);
+	header->setSectionResizeMode(ETA_COLUMN, QHeaderView::ResizeToContents);
+	header->setSectionResizeMode(ACTIONS_COLUMN, QHeaderView::ResizeToContents);
+	songQueueTable->horizontalHeaderItem(ETA_COLUMN)->setToolTip(get_obs_text("Nightbot.Queue.Eta.Tooltip"));
 	songQueueTable->verticalHeader()->hide();
+	songQueueTable->setIconSize(QSize(ThumbnailCache::WIDTH, ThumbnailCache::HEIGHT));
 	songQueueTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+	songQueueTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+	songQueueTable->setSelectionMode(QAbstractItemView::ExtendedSelection);
+	songQueueTable->setContextMenuPolicy(Qt::CustomContextMenu);
+
+	QAction *deleteSelectedAction = new QAction(songQueueTable);
+	deleteSelectedAction->setShortcut(QKeySequence::Delete);
+	deleteSelectedAction->setShortcutContext(Qt::WidgetShortcut);
+	songQueueTable->addAction(deleteSelectedAction);
+	connect(deleteSelectedAction, &QAction::triggered, this,
+		[this]() { StartBatch(NightbotAPI::BatchAction::Delete, SelectedSongIds()); });
+	connect(songQueueTable, &QTableWidget::customContextMenuRequested, this, &NightbotDock::onQueueContextMenu);
+
+	staleLabel = new QLabel();
+	staleLabel->setWordWrap(true);
+	staleLabel->setStyleSheet("color: gray;");
+	staleLabel->hide();
+	mainLayout->addWidget(staleLabel);
+
+	circuitLabel = new QLabel();
+	circuitLabel->setWordWrap(true);
+	circuitLabel->setStyleSheet("color: gray;");
+	circuitLabel->hide();
+	mainLayout->addWidget(circuitLabel);
+
+	batchLabel = new QLabel();
+	batchLabel->setWordWrap(true);
+	batchLabel->setStyleSheet("color: gray;");
+	batchLabel->hide();
+	mainLayout->addWidget(batchLabel);
 
 	mainLayout->addWidget(songQueueTable);
 
+	etaLabel = new QLabel();
+	etaLabel->setStyleSheet("color: gray;");
+	etaLabel->hide();
+	mainLayout->addWidget(etaLabel);
+
+	// A previsão anda sozinha entre as consultas; nenhuma chamada à API por tique.
+	etaTimer = new QTimer(this);
+	etaTimer->setInterval(1000);
+	connect(etaTimer, &QTimer::timeout, this, &NightbotDock::UpdateEta);
+
+	// Rolar ou redimensionar muda as linhas visíveis; cada miniatura que chega pode ser de uma delas.
+	connect(songQueueTable->verticalScrollBar(), &QScrollBar::valueChanged, this, &NightbotDock::UpdateThumbnails);
+	connect(songQueueTable->verticalScrollBar(), &QScrollBar::rangeChanged, this, &NightbotDock::UpdateThumbnails);
+	connect(&ThumbnailCache::get(), &ThumbnailCache::thumbnailReady, this, &NightbotDock::UpdateThumbnails);
+
 	QHBoxLayout *volumeLayout = new QHBoxLayout();
 	volumeLayout->setContentsMargins(0, 0, 0, 0);
 	QLabel *volumeLabel = new QLabel(get_obs_text("Nightbot.Controls.Volume"));
@@ -116,6 +203,7 @@ NightbotDock::NightbotDock() : QWidget(nullptr)
 	connect(refreshButton, &QPushButton::clicked, this, &NightbotDock::onRefreshClicked);
 
 	connect(playPauseButton, &QPushButton::clicked, this, [this]() {
+		UI_SLOT_SCOPE("NightbotDock::playPauseClicked");
 		bool isPlaying = playPauseButton->property("isPlaying").toBool();
 		if (isPlaying) {
 			NightbotAPI::get().ControlPause();
@@ -132,13 +220,19 @@ NightbotDock::NightbotDock() : QWidget(nullptr)
 	connect(srToggleButton, &QToolButton::clicked, this, &NightbotDock::onToggleSRClicked);
 
 	connect(&NightbotAPI::get(), &NightbotAPI::songQueueFetched, this,
-		&NightbotDock::UpdateSongQueue);
+		&NightbotDock::onSongQueueFetched);
 
-	connect(&NightbotAPI::get(), &NightbotAPI::srStatusFetched, this,
-		&NightbotDock::updateSRStatusButton);
+	connect(&NightbotAPI::get(), &NightbotAPI::srStatusFetched, this, [this](bool isEnabled) {
+		UI_SLOT_SCOPE("NightbotDock::srStatusFetched");
+		QueueCache::get().StoreSRStatus(SessionManager::get().Active()->Id(), isEnabled);
+		updateSRStatusButton(isEnabled);
+	});
 
-	connect(&NightbotAPI::get(), &NightbotAPI::volumeFetched, this,
-		&NightbotDock::updateVolumeSlider);
+	connect(&NightbotAPI::get(), &NightbotAPI::volumeFetched, this, [this](int volume) {
+		UI_SLOT_SCOPE("NightbotDock::volumeFetched");
+		QueueCache::get().StoreVolume(SessionManager::get().Active()->Id(), volume);
+		updateVolumeSlider(volume);
+	});
 
 	connect(volumeSlider, &QSlider::sliderReleased, this, [this]() {
 		onVolumeChanged(volumeSlider->value());
@@ -155,102 +249,215 @@ NightbotDock::NightbotDock() : QWidget(nullptr)
 
 	connect(&NightbotAPI::get(), &NightbotAPI::apiErrorOccurred, this,
 		[this](const QString &) { alertButton->show(); });
+	connect(&NightbotAPI::get(), &NightbotAPI::batchFinished, this, &NightbotDock::onBatchFinished);
+	connect(&CircuitBreakers::get(), &CircuitBreakers::stateChanged, this, &NightbotDock::onCircuitStateChanged);
 
 	connect(alertButton, &QPushButton::clicked, this,
 		&NightbotDock::onAlertClicked);
 
-	refreshTimer = new QTimer(this);
-	connect(refreshTimer, &QTimer::timeout, this, &NightbotDock::onRefreshClicked);
+	RebuildChannelList();
+	connect(channelComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this,
+		&NightbotDock::onChannelSelected);
+	connect(&SessionManager::get(), &SessionManager::sessionsChanged, this, &NightbotDock::onSessionsChanged);
+	connect(&SessionManager::get(), &SessionManager::activeSessionChanged, this,
+		&NightbotDock::onActiveSessionChanged);
+
+	{
+		auto snapshot = SettingsManager::get().GetSnapshot();
+		nowPlayingFormat.Compile(snapshot->nowPlayingFormat);
+		appliedNowPlayingSource = snapshot->nowPlayingSource;
+		appliedNowPlayingToFile = snapshot->nowPlayingToFileEnabled;
+		appliedNowPlayingPath = snapshot->nowPlayingToFilePath;
+	}
+	connect(&SettingsManager::get(), &SettingsManager::snapshotChanged, this,
+		&NightbotDock::onSettingsChanged);
+
+	connect(&PollingGate::get(), &PollingGate::stateChanged, this, [this]() {
+		if (started)
+			UpdateRefreshTimer();
+	});
+
+	pollingSource = new PollingUpdateSource(this);
+	connect(pollingSource, &QueueUpdateSource::refreshRequested, this, &NightbotDock::onRefreshClicked);
+
+	// A troca entre push e polling é enfileirada: o push pode mudar de estado dentro de UpdateRefreshTimer.
+	pushSource = new PushUpdateSource(this);
+	pushSource->SetUrl(QString::fromStdString(SettingsManager::get().GetSnapshot()->pushUrl));
+	connect(pushSource, &QueueUpdateSource::refreshRequested, this, &NightbotDock::onRefreshClicked);
+	connect(
+		pushSource, &QueueUpdateSource::activeChanged, this,
+		[this]() {
+			if (started)
+				UpdateRefreshTimer();
+		},
+		Qt::QueuedConnection);
+
+	// Só o "casco" do dock é montado aqui. Timer e requisições começam em Start(),
+	// depois que o OBS terminar de carregar.
+	if (NightbotAuth::get().IsAuthenticated())
+		LoadCachedQueue();
+};
+
+void NightbotDock::Start()
+{
+	if (started)
+		return;
+	started = true;
+
+	// O OBS já restaurou o layout: vale a visibilidade real, tenha havido showEvent ou não.
+	PollingGate::get().SetDockVisible(isVisible());
 	UpdateRefreshTimer();
 
-	if (NightbotAuth::get().IsAuthenticated()) {
+	if (NightbotAuth::get().IsAuthenticated())
 		onRefreshClicked();
+}
+
+void NightbotDock::LoadCachedQueue()
+{
+	UI_SLOT_SCOPE("NightbotDock::LoadCachedQueue");
+	QueueCacheData cached;
+	if (!QueueCache::get().Load(SessionManager::get().Active()->Id(), cached))
+		return;
+
+	obs_log_info("[Nightbot SR/Dock] Showing cached queue with %d song(s) until live data arrives.",
+		     static_cast<int>(cached.queue.size()));
+
+	showingStale = true;
+	staleLabel->setText(QString(get_obs_text("Nightbot.Dock.Stale"))
+				    .arg(QDateTime::fromMSecsSinceEpoch(cached.savedAtMs).toString("HH:mm")));
+	staleLabel->show();
+
+	updateSRStatusButton(cached.srEnabled);
+	if (cached.volume >= 0)
+		updateVolumeSlider(cached.volume);
+	UpdateSongQueue(cached.queue);
+}
+
+void NightbotDock::onSongQueueFetched(const QList<SongItem> &queue)
+{
+	UI_SLOT_SCOPE("NightbotDock::onSongQueueFetched");
+	if (showingStale) {
+		showingStale = false;
+		staleLabel->hide();
 	}
-};
+
+	PluginMetrics::get().queueLength.store(queue.size(), std::memory_order_relaxed);
+	PluginMetrics::get().lastQueueUpdateMs.store(QDateTime::currentMSecsSinceEpoch(), std::memory_order_relaxed);
+
+	const std::string account = SessionManager::get().Active()->Id();
+	{
+		UI_SLOT_SCOPE("QueueCache::StoreQueue");
+		QueueCache::get().StoreQueue(account, queue);
+	}
+	RequestHistory::get().RecordTracks(queue);
+	// Antes de redesenhar: {last} e {recent} já devem ver a música que acabou de sair.
+	PlayHistory::get().ObserveQueue(account, queue);
+	UpdateSongQueue(queue);
+}
 
 void NightbotDock::UpdateRefreshTimer()
 {
+	UI_SLOT_SCOPE("NightbotDock::UpdateRefreshTimer");
 	if (NightbotAuth::get().GetAccessToken().empty()) {
-		if (refreshTimer->isActive()) {
-			refreshTimer->stop();
+		pushSource->Stop();
+		if (pollingSource->IsActive()) {
+			pollingSource->Stop();
 			obs_log_info("[Nightbot SR/Dock] Not authenticated. Auto-refresh timer stopped.");
 		}
+		PluginMetrics::get().pollIntervalMs.store(0, std::memory_order_relaxed);
 		updateSRStatusButton(false);
 		return;
 	}
 
-	bool enabled = SettingsManager::get().GetAutoRefreshEnabled();
-	if (enabled) {
-		int interval_s = SettingsManager::get().GetAutoRefreshInterval();
+	auto settings = SettingsManager::get().GetSnapshot();
+	if (settings->autoRefreshEnabled) {
+		int interval_s = settings->autoRefreshInterval;
 		if (interval_s > 0) {
-			int interval_ms = interval_s * 1000;
-			refreshTimer->start(interval_ms);
-			obs_log_info("[Nightbot SR/Dock] Auto-refresh timer started with %dms interval.", interval_ms);
+			int interval_ms = PollingGate::get().EffectiveIntervalMs(interval_s * 1000, *settings);
+			if (interval_ms == 0) {
+				PluginMetrics::get().pollIntervalMs.store(0, std::memory_order_relaxed);
+				pushSource->Stop();
+				if (pollingSource->IsActive()) {
+					pollingSource->Stop();
+					obs_log_info("[Nightbot SR/Dock] Auto-refresh paused (%s).",
+						     PollingGate::get().Describe(*settings));
+				}
+				pollingPaused = true;
+				return;
+			}
+
+			// Com o push conectado, a consulta vira só uma ressincronização de segurança.
+			// Se o canal cair, activeChanged chama esta função de novo e o intervalo normal volta.
+			pushSource->Start();
+			if (pushSource->IsActive())
+				interval_ms = std::max(interval_ms, PUSH_RESYNC_INTERVAL_MS);
+			PluginMetrics::get().pollIntervalMs.store(interval_ms, std::memory_order_relaxed);
+
+			if (!pollingSource->IsActive() || pollingSource->IntervalMs() != interval_ms) {
+				pollingSource->SetIntervalMs(interval_ms);
+				obs_log_info("[Nightbot SR/Dock] Auto-refresh timer started with %dms interval (%s%s).",
+					     interval_ms, PollingGate::get().Describe(*settings),
+					     pushSource->IsActive() ? ", push connected" : "");
+			}
+
+			// Ao sair da pausa os dados podem estar velhos: atualiza na hora.
+			if (pollingPaused) {
+				pollingPaused = false;
+				onRefreshClicked();
+			}
 		} else {
-			refreshTimer->stop();
+			pollingSource->Stop();
+			pushSource->Stop();
+			PluginMetrics::get().pollIntervalMs.store(0, std::memory_order_relaxed);
 			obs_log_warning("[Nightbot SR/Dock] Auto-refresh is enabled but interval is invalid (%d seconds). Timer stopped to prevent spam.", interval_s);
 		}
 	} else {
-		refreshTimer->stop();
-		obs_log_info("[Nightbot SR/Dock] Auto-refresh timer stopped.");
+		// Só registra na parada: cada mudança de configuração passa por aqui de novo.
+		const bool wasRunning = pollingSource->IsActive() || pushSource->IsActive();
+		pollingSource->Stop();
+		pushSource->Stop();
+		PluginMetrics::get().pollIntervalMs.store(0, std::memory_order_relaxed);
+		if (wasRunning)
+			obs_log_info("[Nightbot SR/Dock] Auto-refresh timer stopped.");
 	}
 }
 
 void NightbotDock::UpdateSongQueue(const QList<SongItem> &queue)
 {
-	songQueueTable->clearContents();
-	songQueueTable->setRowCount(static_cast<int>(queue.size()));
+	TRACE_SCOPE("UpdateSongQueue", "ui");
+	UI_SLOT_SCOPE("UpdateSongQueue");
 
-	// 1. Prepara o texto "Tocando Agora" independentemente de qualquer saída.
-	QString nowPlayingText = "";
-	if (!queue.isEmpty() && queue.at(0).position == 0) {
-		const SongItem &currentSong = queue.at(0);
-		int minutes = currentSong.duration / 60;
-		int seconds = currentSong.duration % 60;
-		QString durationStr = QStringLiteral("%1:%2").arg(minutes).arg(seconds, 2, 10, QLatin1Char('0'));
+	// A maior parte das consultas devolve a mesma fila: nesse caso não há o que redesenhar.
+	SongQueueDiff diff = DiffSongQueue(displayedQueue, queue);
+	if (hasDisplayedQueue && diff.IsEmpty() && displayedStale == showingStale)
+		return;
 
-		QString format = QString::fromStdString(SettingsManager::get().GetNowPlayingFormat());
-		format.replace("{music}", currentSong.title);
-		format.replace("{artist}", currentSong.artist);
-		format.replace("{user}", currentSong.user);
-		format.replace("{time}", durationStr);
+	const uint64_t updateStart = os_gettime_ns();
 
-		nowPlayingText = format;
+	// Só dados ao vivo: o cache pode ter pedidos que já foram julgados (ou apagados).
+	// Com pedidos apagados, a ordem justa espera a próxima leitura, já sem eles.
+	if (!showingStale) {
+		if (ModerationEngine::get().Evaluate(SessionManager::get().Active()->Id(), queue, diff) > 0)
+			QTimer::singleShot(500, this, &NightbotDock::onRefreshClicked);
+		else
+			ApplyFairOrder(queue, diff);
 	}
 
-	// 2. Atualiza a fonte de texto, se uma estiver selecionada.
-	std::string sourceName = SettingsManager::get().GetNowPlayingSource();
-	if (!sourceName.empty() && !nowPlayingText.isEmpty()) {
-		obs_source_t *textSource = obs_get_source_by_name(sourceName.c_str());
-		if (textSource) {
-			obs_data_t *settings = obs_data_create();
-			obs_data_set_string(settings, "text", nowPlayingText.toUtf8().constData());
-			obs_source_update(textSource, settings);
-			obs_data_release(settings);
-			obs_source_release(textSource);
-		} else {
-			obs_log_warning("[Nightbot SR/Dock] Now playing source '%s' not found.", sourceName.c_str());
-			SettingsManager::get().SetNowPlayingSource("");
-		}
-	}
+	// A tabela é refeita: guarda a seleção pelos ids para ela sobreviver às consultas.
+	const QStringList selectedIds = SelectedSongIds();
 
-	// 3. Salva para o arquivo, se a opção estiver habilitada.
-	if (SettingsManager::get().GetNowPlayingToFileEnabled() && !nowPlayingText.isEmpty()) {
-		std::string filePathStr = SettingsManager::get().GetNowPlayingToFilePath();
-		if (!filePathStr.empty()) {
-			QFile file(QString::fromStdString(filePathStr));
-			if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-				QTextStream out(&file);
-				out << nowPlayingText;
-				file.close();
-			} else {
-				obs_log_warning("[Nightbot SR/Dock] Failed to write to file '%s'. Error: %s",
-						filePathStr.c_str(),
-						file.errorString().toUtf8().constData());
-				SettingsManager::get().SetNowPlayingToFilePath("");
-			}
-		}
-	}
+	displayedQueue = queue;
+	displayedStale = showingStale;
+	hasDisplayedQueue = true;
+
+	const int64_t nowMs = QDateTime::currentMSecsSinceEpoch();
+	queueEta.Update(queue, nowMs);
+
+	UpdateNowPlayingOutputs(false);
+
+	songQueueTable->clearContents();
+	thumbnailRows.clear();
+	songQueueTable->setRowCount(static_cast<int>(queue.size()));
 
 	for (qsizetype i = 0; i < queue.size(); ++i) {
 		const SongItem &item = queue.at(static_cast<int>(i));
@@ -263,6 +470,7 @@ void NightbotDock::UpdateSongQueue(const QList<SongItem> &queue)
 		QTableWidgetItem *posItem;
 		QTableWidgetItem *titleItem = new QTableWidgetItem(titleWithDuration);
 		QTableWidgetItem *userItem = new QTableWidgetItem(item.user);
+		QTableWidgetItem *etaItem = new QTableWidgetItem(EtaText(static_cast<size_t>(i), nowMs));
 
 		if (i == 0 && !queue.isEmpty()) {
 			posItem = new QTableWidgetItem();
@@ -273,9 +481,18 @@ void NightbotDock::UpdateSongQueue(const QList<SongItem> &queue)
 			posItem->setFont(boldFont);
 			titleItem->setFont(boldFont);
 			userItem->setFont(boldFont);
+			etaItem->setFont(boldFont);
 		} else {
 			posItem = new QTableWidgetItem(QString::number(item.position));
 
+			// O ícone do título é a miniatura; o aviso da moderação fica na posição.
+			const QString flagReason = ModerationEngine::get().FlagReason(item.id);
+			if (!flagReason.isEmpty()) {
+				posItem->setIcon(style()->standardIcon(QStyle::SP_MessageBoxWarning));
+				posItem->setToolTip(flagReason);
+				titleItem->setToolTip(flagReason);
+			}
+
 			QWidget *actionsWidget = new QWidget();
 			QHBoxLayout *actionsLayout = new QHBoxLayout(actionsWidget);
 			actionsLayout->setContentsMargins(5, 0, 5, 0);
@@ -304,26 +521,313 @@ void NightbotDock::UpdateSongQueue(const QList<SongItem> &queue)
 			actionsLayout->addWidget(deleteButton);
 			actionsWidget->setLayout(actionsLayout);
 
-			songQueueTable->setCellWidget(static_cast<int>(i), 3, actionsWidget);
+			songQueueTable->setCellWidget(static_cast<int>(i), ACTIONS_COLUMN, actionsWidget);
+		}
+
+		if (showingStale) {
+			const QBrush staleBrush = palette().brush(QPalette::Disabled, QPalette::Text);
+			posItem->setForeground(staleBrush);
+			titleItem->setForeground(staleBrush);
+			userItem->setForeground(staleBrush);
+			etaItem->setForeground(staleBrush);
 		}
 
 		posItem->setTextAlignment(Qt::AlignCenter);
 		userItem->setTextAlignment(Qt::AlignCenter);
 		songQueueTable->setItem(static_cast<int>(i), 0, posItem);
-		songQueueTable->setItem(static_cast<int>(i), 1, titleItem);
+		songQueueTable->setItem(static_cast<int>(i), TITLE_COLUMN, titleItem);
 		songQueueTable->setItem(static_cast<int>(i), 2, userItem);
+		etaItem->setTextAlignment(Qt::AlignCenter);
+		songQueueTable->setItem(static_cast<int>(i), ETA_COLUMN, etaItem);
+
+		if (i > 0 && selectedIds.contains(item.id))
+			songQueueTable->selectionModel()->select(songQueueTable->model()->index(static_cast<int>(i), 0),
+								 QItemSelectionModel::Select |
+									 QItemSelectionModel::Rows);
+	}
+
+	uint64_t queueBytes = 0;
+	for (const SongItem &item : queue)
+		queueBytes += sizeof(SongItem) +
+			      static_cast<uint64_t>(item.id.size() + item.title.size() + item.artist.size() + item.user.size()) *
+				      sizeof(QChar);
+	PluginMetrics::get().queueMemoryBytes.store(queueBytes, std::memory_order_relaxed);
+	UpdateEta();
+	UpdateEtaTimer();
+	UpdateThumbnails();
+	PluginMetrics::get().RecordUiUpdate((os_gettime_ns() - updateStart) / 1000);
+}
+
+QString NightbotDock::EtaText(size_t row, int64_t nowMs) const
+{
+	if (row == 0 && queueEta.CurrentRemainingSeconds(nowMs) >= 0)
+		return QString(get_obs_text("Nightbot.Queue.Eta.Playing"))
+			.arg(QueueEta::FormatSeconds(queueEta.CurrentRemainingSeconds(nowMs)));
+	return QueueEta::FormatSeconds(queueEta.SecondsUntil(row, nowMs));
+}
+
+void NightbotDock::UpdateEta()
+{
+	UI_SLOT_SCOPE("NightbotDock::UpdateEta");
+	const int64_t nowMs = QDateTime::currentMSecsSinceEpoch();
+
+	// Só as linhas na tela: numa fila longa o resto nem é visto até rolar.
+	int first;
+	int last;
+	if (VisibleRows(first, last)) {
+		for (int row = first; row <= last && row < static_cast<int>(queueEta.Size()); ++row) {
+			QTableWidgetItem *item = songQueueTable->item(row, ETA_COLUMN);
+			const QString text = EtaText(static_cast<size_t>(row), nowMs);
+			if (item && item->text() != text)
+				item->setText(text);
+		}
+	}
+
+	etaLabel->setVisible(queueEta.Size() > 0);
+	if (queueEta.Size() > 0)
+		etaLabel->setText(QString(get_obs_text("Nightbot.Queue.Eta.Total"))
+					  .arg(static_cast<qulonglong>(queueEta.Size()))
+					  .arg(QueueEta::FormatSeconds(queueEta.TotalRemainingSeconds(nowMs))));
+
+	if (nowPlayingFormat.UsesEta())
+		UpdateNowPlayingOutputs(false);
+}
+
+bool NightbotDock::VisibleRows(int &first, int &last) const
+{
+	const int rows = songQueueTable->rowCount();
+	if (!isVisible() || rows == 0)
+		return false;
+	first = std::max(0, songQueueTable->rowAt(0));
+	last = songQueueTable->rowAt(songQueueTable->viewport()->height() - 1);
+	if (last < 0)
+		last = rows - 1;
+	return true;
+}
+
+void NightbotDock::UpdateThumbnails()
+{
+	UI_SLOT_SCOPE("NightbotDock::UpdateThumbnails");
+	int first = 0;
+	int last = -1;
+	const bool visible = VisibleRows(first, last);
+
+	// O ícone de um item segura a imagem mesmo depois de o cache descartá-la: só as linhas na
+	// tela ficam com miniatura, assim a memória não cresce com a rolagem numa fila longa.
+	for (auto it = thumbnailRows.begin(); it != thumbnailRows.end();) {
+		if (visible && *it >= first && *it <= last) {
+			++it;
+			continue;
+		}
+		if (QTableWidgetItem *titleItem = songQueueTable->item(*it, TITLE_COLUMN))
+			titleItem->setIcon(QIcon());
+		it = thumbnailRows.erase(it);
+	}
+
+	// As que faltam na memória são pedidas; rolar a tabela troca os pedidos pelos das novas linhas.
+	QList<SongItem> missing;
+	for (int row = first; visible && row <= last && row < displayedQueue.size(); ++row) {
+		QTableWidgetItem *titleItem = songQueueTable->item(row, TITLE_COLUMN);
+		if (!titleItem || thumbnailRows.contains(row))
+			continue;
+		const SongItem &song = displayedQueue.at(row);
+		const QPixmap pixmap = ThumbnailCache::get().Find(ThumbnailCache::KeyFor(song));
+		if (pixmap.isNull()) {
+			missing << song;
+		} else {
+			titleItem->setIcon(QIcon(pixmap));
+			thumbnailRows.insert(row);
+		}
+	}
+	ThumbnailCache::get().Request(missing);
+}
+
+void NightbotDock::UpdateEtaTimer()
+{
+	// Com o dock fechado o tique só é preciso se o texto "Tocando Agora" mostrar a contagem.
+	const bool needed = queueEta.Size() > 0 && (isVisible() || nowPlayingFormat.UsesEta());
+	if (needed && !etaTimer->isActive())
+		etaTimer->start();
+	else if (!needed)
+		etaTimer->stop();
+}
+
+void NightbotDock::UpdateNowPlayingOutputs(bool force)
+{
+	auto snapshot = SettingsManager::get().GetSnapshot();
+
+	// 1. Prepara o texto "Tocando Agora" independentemente de qualquer saída.
+	QString nowPlayingText = "";
+	if (!displayedQueue.isEmpty() && displayedQueue.at(0).position == 0) {
+		std::vector<PlayRecord> recent;
+		if (nowPlayingFormat.UsesHistory()) {
+			const QString account = QString::fromStdString(SessionManager::get().Active()->Id());
+			recent = PlayHistory::get().Recent(NowPlayingFormat::RECENT_PLAYS, account);
+		}
+		NowPlayingContext context;
+		context.recent = &recent;
+		if (nowPlayingFormat.UsesEta()) {
+			const int64_t nowMs = QDateTime::currentMSecsSinceEpoch();
+			context.remainingSeconds = queueEta.CurrentRemainingSeconds(nowMs);
+			context.queueRemainingSeconds = queueEta.TotalRemainingSeconds(nowMs);
+		}
+		nowPlayingText = nowPlayingFormat.Render(displayedQueue.at(0), context);
+	}
+
+	// Evita reescrever a fonte e o arquivo a cada consulta se o texto não mudou.
+	if (!force && nowPlayingText == lastNowPlayingText)
+		return;
+	lastNowPlayingText = nowPlayingText;
 
+	TRACE_SCOPE("UpdateNowPlayingOutputs", "ui");
+	UI_SLOT_SCOPE("UpdateNowPlayingOutputs");
+
+	// 2. Atualiza a fonte de texto, se uma estiver selecionada.
+	const std::string &sourceName = snapshot->nowPlayingSource;
+	if (!sourceName.empty() && !nowPlayingText.isEmpty()) {
+		TRACE_SCOPE("UpdateTextSource", "ui");
+		UI_SLOT_SCOPE("UpdateTextSource");
+		obs_source_t *textSource = obs_get_source_by_name(sourceName.c_str());
+		if (textSource) {
+			obs_data_t *settings = obs_data_create();
+			obs_data_set_string(settings, "text", nowPlayingText.toUtf8().constData());
+			obs_source_update(textSource, settings);
+			obs_data_release(settings);
+			obs_source_release(textSource);
+		} else if (!showingStale) {
+			// Com dados do cache a cena ainda pode não ter sido carregada.
+			obs_log_warning("[Nightbot SR/Dock] Now playing source '%s' not found.", sourceName.c_str());
+			SettingsManager::get().SetNowPlayingSource("");
+		} else {
+			// Tenta de novo quando os dados ao vivo chegarem.
+			lastNowPlayingText.clear();
+		}
 	}
+
+	// 3. Salva para o arquivo, se a opção estiver habilitada.
+	if (snapshot->nowPlayingToFileEnabled && !nowPlayingText.isEmpty()) {
+		const QString &filePath = snapshot->nowPlayingToFilePath;
+		if (!filePath.isEmpty()) {
+			TRACE_SCOPE("WriteNowPlayingFile", "io");
+			UI_SLOT_SCOPE("WriteNowPlayingFile");
+			QFile file(filePath);
+			if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+				QTextStream out(&file);
+				out << nowPlayingText;
+				file.close();
+			} else {
+				obs_log_warning("[Nightbot SR/Dock] Failed to write to file '%s'. Error: %s",
+						filePath.toUtf8().constData(),
+						file.errorString().toUtf8().constData());
+				SettingsManager::get().SetNowPlayingToFilePath("");
+			}
+		}
+	}
+}
+
+void NightbotDock::onSettingsChanged()
+{
+	UI_SLOT_SCOPE("NightbotDock::onSettingsChanged");
+	auto snapshot = SettingsManager::get().GetSnapshot();
+
+	// Só recompila o modelo quando o formato realmente mudou.
+	const bool formatChanged = snapshot->nowPlayingFormat != nowPlayingFormat.Format();
+	if (formatChanged)
+		nowPlayingFormat.Compile(snapshot->nowPlayingFormat);
+
+	pushSource->SetUrl(QString::fromStdString(snapshot->pushUrl));
+
+	// Só formato, fonte ou arquivo mudam as saídas; moderação, diagnóstico e afins não reescrevem nada.
+	const bool outputsChanged = snapshot->nowPlayingSource != appliedNowPlayingSource ||
+				    snapshot->nowPlayingToFileEnabled != appliedNowPlayingToFile ||
+				    snapshot->nowPlayingToFilePath != appliedNowPlayingPath;
+	appliedNowPlayingSource = snapshot->nowPlayingSource;
+	appliedNowPlayingToFile = snapshot->nowPlayingToFileEnabled;
+	appliedNowPlayingPath = snapshot->nowPlayingToFilePath;
+	if (hasDisplayedQueue && (formatChanged || outputsChanged))
+		UpdateNowPlayingOutputs(true);
+
+	UpdateEtaTimer();
+
+	// As saídas de "Tocando Agora" entram na decisão de pausar as consultas.
+	if (started)
+		UpdateRefreshTimer();
+}
+
+void NightbotDock::showEvent(QShowEvent *event)
+{
+	UI_SLOT_SCOPE("NightbotDock::showEvent");
+	QWidget::showEvent(event);
+	PollingGate::get().SetDockVisible(true);
+	// Enquanto esteve fechado as linhas não foram atualizadas.
+	UpdateEta();
+	UpdateEtaTimer();
+	UpdateThumbnails();
+}
+
+void NightbotDock::hideEvent(QHideEvent *event)
+{
+	UI_SLOT_SCOPE("NightbotDock::hideEvent");
+	QWidget::hideEvent(event);
+	PollingGate::get().SetDockVisible(false);
+	UpdateEtaTimer();
+	// Fechado, nada está na tela: descarta as miniaturas que ainda não começaram a ser buscadas.
+	UpdateThumbnails();
 }
 
 void NightbotDock::onRefreshClicked()
 {
+	UI_SLOT_SCOPE("NightbotDock::onRefreshClicked");
 	NightbotAPI::get().FetchSongQueue(get_obs_text("Nightbot.Queue.PlaylistUser"));
 	NightbotAPI::get().FetchSRSettings();
 }
 
+void NightbotDock::onCircuitStateChanged(const QString &host)
+{
+	UI_SLOT_SCOPE("NightbotDock::onCircuitStateChanged");
+	UpdateCircuitLabel();
+
+	auto snapshot = SettingsManager::get().GetSnapshot();
+	const std::string changed = host.toStdString();
+	if (changed != CircuitBreakers::HostOf(snapshot->apiBaseUrl) &&
+	    changed != CircuitBreakers::HostOf(snapshot->backendBaseUrl))
+		return;
+	if (CircuitBreakers::get().State(changed) != CircuitState::Closed || !NightbotAuth::get().IsAuthenticated())
+		return;
+
+	// De volta: o que mudou durante a queda (fila, estado do SR, volume) vem numa busca completa,
+	// e os alertas daquele período não valem mais.
+	obs_log_info("[Nightbot SR/Dock] %s is back; refreshing everything.", changed.c_str());
+	alertButton->hide();
+	onRefreshClicked();
+}
+
+void NightbotDock::UpdateCircuitLabel()
+{
+	auto snapshot = SettingsManager::get().GetSnapshot();
+	const std::string apiHost = CircuitBreakers::HostOf(snapshot->apiBaseUrl);
+	const std::string backendHost = CircuitBreakers::HostOf(snapshot->backendBaseUrl);
+
+	QStringList lines;
+	for (const CircuitBreakers::HostStatus &status : CircuitBreakers::get().Status()) {
+		if (status.state == CircuitState::Closed || (status.host != apiHost && status.host != backendHost))
+			continue;
+		const char *hostKey = status.host == apiHost ? "Nightbot.Dock.Circuit.Api"
+							     : "Nightbot.Dock.Circuit.Backend";
+		const char *stateKey = status.state == CircuitState::Open ? "Nightbot.Dock.Circuit.Open"
+									  : "Nightbot.Dock.Circuit.HalfOpen";
+		lines << QString(get_obs_text(hostKey)).arg(QString::fromStdString(status.host)) + " " +
+				 get_obs_text(stateKey);
+	}
+
+	circuitLabel->setText(lines.join('\n'));
+	circuitLabel->setVisible(!lines.isEmpty());
+}
+
 void NightbotDock::onSkipClicked()
 {
+	UI_SLOT_SCOPE("NightbotDock::onSkipClicked");
+	PlayHistory::get().MarkSkipRequested(SessionManager::get().Active()->Id());
 	NightbotAPI::get().ControlSkip();
 	QTimer::singleShot(500, this, &NightbotDock::onRefreshClicked);
 
@@ -339,6 +843,7 @@ void NightbotDock::onAddSongClicked()
 
 void NightbotDock::onToggleSRClicked()
 {
+	UI_SLOT_SCOPE("NightbotDock::onToggleSRClicked");
 	bool isChecked = srToggleButton->isChecked();
 	NightbotAPI::get().SetSREnabled(isChecked);
 	updateSRStatusButton(isChecked);
@@ -347,6 +852,7 @@ void NightbotDock::onToggleSRClicked()
 
 void NightbotDock::updateSRStatusButton(bool isEnabled)
 {
+	UI_SLOT_SCOPE("NightbotDock::updateSRStatusButton");
 	srToggleButton->setEnabled(NightbotAuth::get().IsAuthenticated());
 	srToggleButton->setChecked(isEnabled);
 	if (isEnabled) {
@@ -360,11 +866,13 @@ void NightbotDock::updateSRStatusButton(bool isEnabled)
 
 void NightbotDock::onVolumeChanged(int volume)
 {
+	UI_SLOT_SCOPE("NightbotDock::onVolumeChanged");
 	NightbotAPI::get().SetVolume(volume);
 }
 
 void NightbotDock::onAuthStatusChanged(bool success)
 {
+	UI_SLOT_SCOPE("NightbotDock::onAuthStatusChanged");
 	alertButton->setVisible(!success);
 }
 
@@ -377,12 +885,14 @@ void NightbotDock::onAlertClicked()
 
 void NightbotDock::onVolumeSliderMoved(int value)
 {
+	UI_SLOT_SCOPE("NightbotDock::onVolumeSliderMoved");
 	QToolTip::showText(QCursor::pos(), QString::number(value) + "%",
 			   volumeSlider);
 }
 
 void NightbotDock::updateVolumeSlider(int volume)
 {
+	UI_SLOT_SCOPE("NightbotDock::updateVolumeSlider");
 	// Só atualiza o slider se o usuário não estiver interagindo com ele
 	// e se o valor recebido da API for diferente do valor atual.
 	if (volumeSlider->isSliderDown() || volumeSlider->value() == volume) {
@@ -398,14 +908,263 @@ void NightbotDock::updateVolumeSlider(int volume)
 
 void NightbotDock::onPromoteSongClicked(const QString &songId)
 {
+	UI_SLOT_SCOPE("NightbotDock::onPromoteSongClicked");
 	NightbotAPI::get().PromoteSong(songId);
 	QTimer::singleShot(500, this, &NightbotDock::onRefreshClicked);
 
 	NightbotAPI::get().FetchSongQueue(get_obs_text("Nightbot.Queue.PlaylistUser"));
 }
 
+void NightbotDock::RebuildChannelList()
+{
+	const auto sessions = SessionManager::get().Sessions();
+	const auto active = SessionManager::get().Active();
+
+	channelComboBox->blockSignals(true);
+	channelComboBox->clear();
+	for (const auto &session : sessions) {
+		const std::string name = session->DisplayName();
+		channelComboBox->addItem(name.empty() ? QString(get_obs_text("Nightbot.Dock.Channel.Unnamed"))
+						      : QString::fromStdString(name),
+					 QString::fromStdString(session->Id()));
+		if (session == active)
+			channelComboBox->setCurrentIndex(channelComboBox->count() - 1);
+	}
+	channelComboBox->blockSignals(false);
+	channelComboBox->setVisible(sessions.size() > 1);
+}
+
+void NightbotDock::onSessionsChanged()
+{
+	UI_SLOT_SCOPE("NightbotDock::onSessionsChanged");
+	RebuildChannelList();
+
+	// Logout, conta removida ou refresh recusado: a fila guardada não pode aparecer para quem
+	// conectar depois com o mesmo id (a conta principal é sempre "primary").
+	const std::string cached = QueueCache::get().Account();
+	const auto session = SessionManager::get().Find(cached);
+	if (!cached.empty() && (!session || !session->IsAuthenticated()))
+		QueueCache::get().Forget(cached);
+}
+
+void NightbotDock::onChannelSelected(int index)
+{
+	UI_SLOT_SCOPE("NightbotDock::onChannelSelected");
+	if (index < 0)
+		return;
+
+	SessionManager::get().SetActive(channelComboBox->itemData(index).toString().toStdString());
+}
+
+void NightbotDock::onActiveSessionChanged()
+{
+	UI_SLOT_SCOPE("NightbotDock::onActiveSessionChanged");
+	RebuildChannelList();
+	alertButton->hide();
+	// O resultado de um lote da conta anterior não chega mais (só a conta ativa recebe sinais).
+	batchRunning = false;
+	batchLabel->hide();
+
+	// Mostra na hora a última fila vista dessa conta, como dado velho; a busca abaixo traz a atual.
+	// A moderação só aprende a fila da conta nova nessa leitura ao vivo: com a fila guardada (vazia
+	// se a conta nunca foi consultada), tudo que já estava no canal pareceria pedido novo.
+	// Pelo mesmo motivo a ordem justa espera essa leitura, e planeja a fila inteira dela.
+	showingStale = true;
+	fairQueue.Reset();
+	staleLabel->setText(get_obs_text("Nightbot.Dock.StaleChannel"));
+	staleLabel->show();
+	UpdateSongQueue(SessionManager::get().Active()->LastQueue());
+	updateSRStatusButton(srToggleButton->isChecked());
+	volumeSlider->setEnabled(NightbotAuth::get().IsAuthenticated());
+
+	// O push autentica com o token da conta: precisa de uma conexão nova.
+	pushSource->Reconnect();
+	if (started)
+		UpdateRefreshTimer();
+	if (NightbotAuth::get().IsAuthenticated())
+		onRefreshClicked();
+}
+
+QStringList NightbotDock::SongIdsWhere(const std::function<bool(int row, const SongItem &)> &match) const
+{
+	// A linha 0 é a música tocando: sai da fila pelo "pular", não por lote.
+	QStringList ids;
+	for (int row = 1; row < displayedQueue.size(); ++row)
+		if (match(row, displayedQueue.at(row)))
+			ids << displayedQueue.at(row).id;
+	return ids;
+}
+
+QStringList NightbotDock::SelectedSongIds() const
+{
+	const QItemSelectionModel *selection = songQueueTable->selectionModel();
+	return SongIdsWhere([selection](int row, const SongItem &) { return selection->isRowSelected(row); });
+}
+
+void NightbotDock::StartBatch(NightbotAPI::BatchAction action, const QStringList &songIds)
+{
+	UI_SLOT_SCOPE("NightbotDock::StartBatch");
+	if (batchRunning || songIds.isEmpty())
+		return;
+
+	batchRunning = true;
+	ShowBatchStatus(QString(get_obs_text("Nightbot.Queue.Batch.Running")).arg(songIds.size()), false);
+	songQueueTable->clearSelection();
+	NightbotAPI::get().RunBatch(action, songIds);
+}
+
+void NightbotDock::ApplyFairOrder(const QList<SongItem> &queue, const SongQueueDiff &diff)
+{
+	// Só com dados ao vivo: promover a partir de uma fila guardada mandaria ids e ordem velhos.
+	// Um lote em andamento (nosso ou do usuário) ainda vai mudar a fila; a leitura no fim dele replaneja.
+	if (showingStale || batchRunning)
+		return;
+
+	const QStringList plan = fairQueue.Plan(queue, diff, SettingsManager::get().GetSnapshot()->fairQueue);
+	if (plan.isEmpty())
+		return;
+
+	// Sem limpar a seleção: a reordenação acontece sozinha, enquanto o usuário mexe na fila.
+	batchRunning = true;
+	ShowBatchStatus(QString(get_obs_text("Nightbot.Queue.FairOrder")).arg(plan.size()), false);
+	NightbotAPI::get().RunBatch(NightbotAPI::BatchAction::Promote, plan);
+}
+
+void NightbotDock::ShowBatchStatus(const QString &text, bool transient)
+{
+	batchLabel->setText(text);
+	batchLabel->show();
+	if (transient)
+		QTimer::singleShot(BATCH_STATUS_VISIBLE_MS, this, [this, text]() {
+			if (batchLabel->text() == text)
+				batchLabel->hide();
+		});
+}
+
+void NightbotDock::onQueueContextMenu(const QPoint &pos)
+{
+	// Só a montagem do menu é medida: o tempo dentro de menu.exec() é do usuário, e os slots
+	// que rodam nesse meio tempo viram invocações próprias, não fases desta.
+	std::optional<UiSlotScope> buildScope;
+	buildScope.emplace("NightbotDock::onQueueContextMenu");
+	const QStringList selected = SelectedSongIds();
+	const int row = songQueueTable->rowAt(pos.y());
+	const QString user = row > 0 && row < displayedQueue.size() ? displayedQueue.at(row).user : QString();
+	// O histórico também vale para quem pediu a música que está tocando.
+	const QString rowUser = row >= 0 && row < displayedQueue.size() ? displayedQueue.at(row).user : QString();
+	const QStringList fromUser = user.isEmpty() ? QStringList() : SongIdsWhere([&user](int, const SongItem &item) {
+		return item.user == user;
+	});
+
+	QMenu menu(this);
+	QAction *deleteSelected =
+		menu.addAction(QString(get_obs_text("Nightbot.Queue.Batch.DeleteSelected")).arg(selected.size()));
+	QAction *promoteSelected =
+		menu.addAction(QString(get_obs_text("Nightbot.Queue.Batch.PromoteSelected")).arg(selected.size()));
+	menu.addSeparator();
+	QAction *deleteFromUser = menu.addAction(
+		QString(get_obs_text("Nightbot.Queue.Batch.DeleteFromUser")).arg(user).arg(fromUser.size()));
+	QAction *deleteMatching = menu.addAction(get_obs_text("Nightbot.Queue.Batch.DeleteMatching"));
+	menu.addSeparator();
+	QAction *playedByUser = menu.addAction(QString(get_obs_text("Nightbot.Queue.History.ByUser")).arg(rowUser));
+
+	deleteSelected->setEnabled(!batchRunning && !selected.isEmpty());
+	promoteSelected->setEnabled(!batchRunning && !selected.isEmpty());
+	deleteFromUser->setVisible(!fromUser.isEmpty());
+	deleteFromUser->setEnabled(!batchRunning);
+	deleteMatching->setEnabled(!batchRunning && displayedQueue.size() > 1);
+	playedByUser->setVisible(!rowUser.isEmpty());
+	buildScope.reset();
+
+	QAction *chosen = menu.exec(songQueueTable->viewport()->mapToGlobal(pos));
+	if (!chosen)
+		return;
+
+	if (chosen == playedByUser) {
+		ShowPlayedByUser(rowUser);
+		return;
+	}
+
+	if (chosen == deleteSelected || chosen == promoteSelected) {
+		StartBatch(chosen == deleteSelected ? NightbotAPI::BatchAction::Delete
+						    : NightbotAPI::BatchAction::Promote,
+			   selected);
+		return;
+	}
+
+	QStringList ids = fromUser;
+	if (chosen == deleteMatching) {
+		const QString text = QInputDialog::getText(this, get_obs_text("Nightbot.Queue.Batch.DeleteMatching"),
+							   get_obs_text("Nightbot.Queue.Batch.MatchingPrompt"))
+					     .trimmed();
+		if (text.isEmpty())
+			return;
+
+		ids = SongIdsWhere([&text](int, const SongItem &item) {
+			return item.title.contains(text, Qt::CaseInsensitive) ||
+			       item.user.contains(text, Qt::CaseInsensitive);
+		});
+		if (ids.isEmpty()) {
+			ShowBatchStatus(QString(get_obs_text("Nightbot.Queue.Batch.NoMatch")).arg(text), true);
+			return;
+		}
+	}
+
+	// Filtros podem pegar mais do que o esperado: confirma antes de apagar.
+	if (QMessageBox::question(this, get_obs_text("Nightbot.DockTitle"),
+				  QString(get_obs_text("Nightbot.Queue.Batch.Confirm")).arg(ids.size())) ==
+	    QMessageBox::Yes)
+		StartBatch(NightbotAPI::BatchAction::Delete, ids);
+}
+
+void NightbotDock::ShowPlayedByUser(const QString &user)
+{
+	// A busca pode abrir segmentos antigos do disco: roda na thread do histórico e a janela
+	// aparece quando o resultado voltar.
+	auto show = [this, user](const std::vector<PlayRecord> &records) {
+		QStringList lines;
+		{
+			UI_SLOT_SCOPE("NightbotDock::ShowPlayedByUser");
+			for (const PlayRecord &record : records) {
+				QString line = QDateTime::fromMSecsSinceEpoch(record.startMs).toString("dd/MM HH:mm");
+				line += "  " + record.title;
+				if (!record.artist.isEmpty())
+					line += " - " + record.artist;
+				if (record.skipped)
+					line += QString(" (%1)").arg(get_obs_text("Nightbot.Queue.History.Skipped"));
+				lines << line;
+			}
+		}
+
+		const QString title = QString(get_obs_text("Nightbot.Queue.History.ByUser")).arg(user);
+		const QString text = lines.isEmpty() ? QString(get_obs_text("Nightbot.Queue.History.Empty")).arg(user)
+						     : lines.join("\n");
+		QMessageBox::information(this, title, text);
+	};
+	PlayHistory::get().ByUserAsync(user, PLAYED_BY_USER_LIMIT, this, show);
+}
+
+void NightbotDock::onBatchFinished(int succeeded, int failed, const QString &firstError)
+{
+	UI_SLOT_SCOPE("NightbotDock::onBatchFinished");
+	batchRunning = false;
+	if (failed == 0)
+		ShowBatchStatus(QString(get_obs_text("Nightbot.Queue.Batch.Done")).arg(succeeded), true);
+	else
+		ShowBatchStatus(QString(get_obs_text("Nightbot.Queue.Batch.Partial"))
+					.arg(succeeded)
+					.arg(failed)
+					.arg(firstError),
+				true);
+
+	// Uma única busca no fim reconcilia a fila com tudo que o lote mudou.
+	onRefreshClicked();
+}
+
 void NightbotDock::SetPlayPauseState(bool isPlaying)
 {
+	UI_SLOT_SCOPE("NightbotDock::SetPlayPauseState");
+	queueEta.SetPaused(!isPlaying, QDateTime::currentMSecsSinceEpoch());
 	if (isPlaying) {
 		playPauseButton->setIcon(style()->standardIcon(QStyle::SP_MediaPause));
 		playPauseButton->setToolTip(get_obs_text("Nightbot.Controls.Pause"));
@@ -2,27 +2,47 @@
 #define NIGHTBOT_DOCK_H
 
 #include <QList>
+#include <QSet>
+#include <QStringList>
 #include <QWidget>
 
+#include <functional>
+
+#include "fair-queue.h"
+#include "nightbot-api.h"
+#include "now-playing-format.h"
+#include "queue-eta.h"
+#include "song-queue.h"
+
 class QPushButton;
 class QToolButton;
 class QTableWidget;
 class QTimer;
 class QSlider;
-struct SongItem;
+class QLabel;
+class QComboBox;
+class PollingUpdateSource;
+class PushUpdateSource;
 
 class NightbotDock : public QWidget {
 	Q_OBJECT
 
 public:
 	explicit NightbotDock();
+	void Start();
 	void UpdateRefreshTimer();
 
 public slots:
 	void SetPlayPauseState(bool isPlaying);
 
+protected:
+	void showEvent(QShowEvent *event) override;
+	void hideEvent(QHideEvent *event) override;
+
 private slots:
 	void UpdateSongQueue(const QList<SongItem> &queue);
+	void onSongQueueFetched(const QList<SongItem> &queue);
+	void onSettingsChanged();
 	void onRefreshClicked();
 	void onSkipClicked();
 	void onPromoteSongClicked(const QString &songId);
@@ -34,14 +54,67 @@ private slots:
 	void onAuthStatusChanged(bool success);
 	void onVolumeSliderMoved(int value);
 	void updateVolumeSlider(int volume);
+	void onChannelSelected(int index);
+	void onSessionsChanged();
+	void onActiveSessionChanged();
+	void onQueueContextMenu(const QPoint &pos);
+	void onBatchFinished(int succeeded, int failed, const QString &firstError);
+	void onCircuitStateChanged(const QString &host);
 
 private:
+	void LoadCachedQueue();
+	void UpdateNowPlayingOutputs(bool force);
+	void RebuildChannelList();
+	// Ids das músicas da fila (sem a que está tocando) que atendem ao filtro.
+	QStringList SongIdsWhere(const std::function<bool(int row, const SongItem &)> &match) const;
+	QStringList SelectedSongIds() const;
+	void StartBatch(NightbotAPI::BatchAction action, const QStringList &songIds);
+	void ShowBatchStatus(const QString &text, bool transient);
+	// Promove o mínimo para as próximas músicas ficarem em rodízio, se o modo justo estiver ligado.
+	void ApplyFairOrder(const QList<SongItem> &queue, const SongQueueDiff &diff);
+	void ShowPlayedByUser(const QString &user);
+	// Refaz só os textos de previsão das linhas visíveis e o total; chamado a cada segundo.
+	void UpdateEta();
+	void UpdateEtaTimer();
+	// Primeira e última linha na tela; false com o dock fechado ou a tabela vazia.
+	bool VisibleRows(int &first, int &last) const;
+	// Miniaturas das linhas visíveis: da memória, ou pedidas ao ThumbnailCache. As linhas que
+	// saíram da tela perdem o ícone.
+	void UpdateThumbnails();
+	QString EtaText(size_t row, int64_t nowMs) const;
+	// Aviso de API ou backend fora do ar, a partir dos disjuntores dos dois hosts.
+	void UpdateCircuitLabel();
+
+	QComboBox *channelComboBox;
 	QPushButton *playPauseButton;
 	QTableWidget *songQueueTable;
-	QTimer *refreshTimer;
+	PollingUpdateSource *pollingSource;
+	PushUpdateSource *pushSource;
 	QPushButton *alertButton;
 	QToolButton *srToggleButton;
 	QSlider *volumeSlider;
+	QLabel *staleLabel;
+	QLabel *batchLabel;
+	QLabel *circuitLabel;
+	QLabel *etaLabel;
+	QTimer *etaTimer;
+	// Linhas com miniatura no ícone do título; nunca mais que as visíveis.
+	QSet<int> thumbnailRows;
+	QueueEta queueEta;
+	FairQueue fairQueue;
+	NowPlayingFormat nowPlayingFormat;
+	bool showingStale = false;
+	QList<SongItem> displayedQueue;
+	bool displayedStale = false;
+	bool hasDisplayedQueue = false;
+	QString lastNowPlayingText;
+	// Saídas de "Tocando Agora" da última configuração vista; outra mudança não reescreve nada.
+	std::string appliedNowPlayingSource;
+	bool appliedNowPlayingToFile = false;
+	QString appliedNowPlayingPath;
+	bool started = false;
+	bool pollingPaused = false;
+	bool batchRunning = false;
 };
 
 #endif // NIGHTBOT_DOCK_H
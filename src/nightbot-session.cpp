@@ -0,0 +1,294 @@
+#include "nightbot-session.h"
+#include "api-scheduler.h"
+#include "http-transport.h"
+#include "SettingsManager.h"
+#include "plugin-support.h"
+
+#include <obs.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+// Limite por conta. A API do Nightbot não documenta o valor; 2 req/s com rajada de 6 fica
+// folgado para uma conta e impede que duas contas ativas somem o dobro de tráfego.
+static const double SESSION_RATE_PER_SECOND = 2.0;
+static const double SESSION_RATE_BURST = 6.0;
+// Cota à parte para os comandos. Eles vêm de uma pessoa apertando botões, então quase nunca
+// somam muito ao tráfego da conta, mas nunca ficam atrás de uma importação ou de um lote.
+static const double COMMAND_RATE_PER_SECOND = 1.0;
+static const double COMMAND_RATE_BURST = 4.0;
+static const char *EXTRA_ID_PREFIX = "account-";
+
+NightbotSession::NightbotSession(std::string id)
+	: id(std::move(id)),
+	  rateLimit(std::make_shared<ApiRateLimit>(SESSION_RATE_PER_SECOND, SESSION_RATE_BURST)),
+	  commandRateLimit(std::make_shared<ApiRateLimit>(COMMAND_RATE_PER_SECOND, COMMAND_RATE_BURST))
+{
+}
+
+std::string NightbotSession::AccessToken() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return accessToken;
+}
+
+std::string NightbotSession::RefreshToken() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return refreshToken;
+}
+
+void NightbotSession::SetTokens(const std::string &newAccessToken, const std::string &newRefreshToken)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	accessToken = newAccessToken;
+	refreshToken = newRefreshToken;
+}
+
+bool NightbotSession::IsAuthenticated() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return !accessToken.empty();
+}
+
+std::string NightbotSession::DisplayName() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return displayName;
+}
+
+void NightbotSession::SetDisplayName(const std::string &name)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	displayName = name;
+}
+
+QList<SongItem> NightbotSession::LastQueue() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return lastQueue;
+}
+
+void NightbotSession::StoreQueue(const QList<SongItem> &queue)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	lastQueue = queue;
+}
+
+SessionManager &SessionManager::get()
+{
+	static SessionManager instance;
+	return instance;
+}
+
+void SessionManager::Load()
+{
+	auto primary = std::make_shared<NightbotSession>(NightbotSession::PRIMARY_ID);
+	primary->SetTokens(SettingsManager::get().GetAccessToken(), SettingsManager::get().GetRefreshToken());
+	primary->SetDisplayName(SettingsManager::get().GetNightUserName());
+	// O replay não confere tokens: sem login salvo, a conta principal usa o marcador da gravação.
+	if (HttpTransportReplaying() && !primary->IsAuthenticated())
+		primary->SetTokens(HTTP_REDACTED_TOKEN, HTTP_REDACTED_TOKEN);
+
+	std::vector<std::shared_ptr<NightbotSession>> loaded = {primary};
+	int nextId = 1;
+
+	obs_data_array_t *extras = SettingsManager::get().GetExtraSessions();
+	const size_t count = extras ? obs_data_array_count(extras) : 0;
+	for (size_t i = 0; i < count; i++) {
+		obs_data_t *item = obs_data_array_item(extras, i);
+		const std::string id = obs_data_get_string(item, "id");
+		const bool duplicate = std::any_of(loaded.begin(), loaded.end(),
+						   [&id](const auto &session) { return session->Id() == id; });
+		if (id.rfind(EXTRA_ID_PREFIX, 0) == 0 && !duplicate) {
+			auto session = std::make_shared<NightbotSession>(id);
+			session->SetTokens(obs_data_get_string(item, "access_token"),
+					   obs_data_get_string(item, "refresh_token"));
+			session->SetDisplayName(obs_data_get_string(item, "user_name"));
+			loaded.push_back(session);
+			nextId = std::max(nextId, std::atoi(id.c_str() + std::strlen(EXTRA_ID_PREFIX)) + 1);
+		}
+		obs_data_release(item);
+	}
+	obs_data_array_release(extras);
+
+	const size_t loadedCount = loaded.size();
+	const std::string activeId = SettingsManager::get().GetActiveSession();
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		sessions = std::move(loaded);
+		nextExtraId = nextId;
+		active = sessions.front();
+		for (const auto &session : sessions)
+			if (session->Id() == activeId)
+				active = session;
+	}
+
+	obs_log_info("[Nightbot SR/Session] Loaded %zu account(s); active: %s", loadedCount, Active()->Id().c_str());
+}
+
+std::shared_ptr<NightbotSession> SessionManager::Active() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return active;
+}
+
+std::vector<std::shared_ptr<NightbotSession>> SessionManager::Sessions() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return sessions;
+}
+
+std::shared_ptr<NightbotSession> SessionManager::Find(const std::string &id) const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	for (const auto &session : sessions)
+		if (session->Id() == id)
+			return session;
+	return nullptr;
+}
+
+bool SessionManager::IsActive(const std::shared_ptr<NightbotSession> &session) const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return session && session == active;
+}
+
+void SessionManager::SetActive(const std::string &id)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (active && active->Id() == id)
+			return;
+
+		auto it = std::find_if(sessions.begin(), sessions.end(),
+				       [&id](const auto &session) { return session->Id() == id; });
+		if (it == sessions.end())
+			return;
+		active = *it;
+	}
+
+	obs_log_info("[Nightbot SR/Session] Switched to account %s.", id.c_str());
+	SettingsManager::get().SetActiveSession(id);
+	SettingsManager::get().Save();
+	emit activeSessionChanged();
+}
+
+std::shared_ptr<NightbotSession> SessionManager::AddSession(const std::string &accessToken,
+							     const std::string &refreshToken)
+{
+	std::shared_ptr<NightbotSession> session;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		session = std::make_shared<NightbotSession>(EXTRA_ID_PREFIX + std::to_string(nextExtraId++));
+		session->SetTokens(accessToken, refreshToken);
+		sessions.push_back(session);
+		active = session;
+	}
+
+	obs_log_info("[Nightbot SR/Session] Added account %s.", session->Id().c_str());
+	PersistExtraSessions();
+	SettingsManager::get().SetActiveSession(session->Id());
+	SettingsManager::get().Save();
+	emit sessionsChanged();
+	emit activeSessionChanged();
+	return session;
+}
+
+void SessionManager::Disconnect(const std::shared_ptr<NightbotSession> &session)
+{
+	if (!session)
+		return;
+
+	session->SetTokens("", "");
+	obs_log_info("[Nightbot SR/Session] Disconnected account %s.", session->Id().c_str());
+	Persist(session);
+	emit sessionsChanged();
+}
+
+void SessionManager::RemoveSession(const std::string &id)
+{
+	auto session = Find(id);
+	if (!session)
+		return;
+
+	session->SetTokens("", "");
+	session->SetDisplayName("");
+	session->StoreQueue({});
+
+	if (session->IsPrimary()) {
+		Persist(session);
+		emit sessionsChanged();
+		return;
+	}
+
+	bool wasActive;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		sessions.erase(std::remove(sessions.begin(), sessions.end(), session), sessions.end());
+		wasActive = active == session;
+		if (wasActive)
+			active = sessions.front();
+	}
+
+	obs_log_info("[Nightbot SR/Session] Removed account %s.", id.c_str());
+	PersistExtraSessions();
+	if (wasActive)
+		SettingsManager::get().SetActiveSession(NightbotSession::PRIMARY_ID);
+	SettingsManager::get().Save();
+	emit sessionsChanged();
+	if (wasActive)
+		emit activeSessionChanged();
+}
+
+void SessionManager::Rename(const std::shared_ptr<NightbotSession> &session, const std::string &name)
+{
+	if (!session || session->DisplayName() == name)
+		return;
+
+	session->SetDisplayName(name);
+	Persist(session);
+	emit sessionsChanged();
+}
+
+void SessionManager::Persist(const std::shared_ptr<NightbotSession> &session)
+{
+	// No replay os tokens vêm da gravação (o marcador, não credenciais): o settings.json fica como está.
+	if (!session || HttpTransportReplaying())
+		return;
+
+	if (session->IsPrimary()) {
+		SettingsManager::get().SetAccessToken(session->AccessToken());
+		SettingsManager::get().SetRefreshToken(session->RefreshToken());
+		// SetUserName republica o snapshot; só vale a pena quando o nome mudou.
+		const std::string name = session->DisplayName();
+		if (name != SettingsManager::get().GetNightUserName())
+			SettingsManager::get().SetUserName(name);
+	} else {
+		PersistExtraSessions();
+	}
+	SettingsManager::get().Save();
+}
+
+void SessionManager::PersistExtraSessions()
+{
+	if (HttpTransportReplaying())
+		return;
+
+	obs_data_array_t *array = obs_data_array_create();
+	for (const auto &session : Sessions()) {
+		if (session->IsPrimary())
+			continue;
+
+		obs_data_t *item = obs_data_create();
+		obs_data_set_string(item, "id", session->Id().c_str());
+		obs_data_set_string(item, "user_name", session->DisplayName().c_str());
+		obs_data_set_string(item, "access_token", session->AccessToken().c_str());
+		obs_data_set_string(item, "refresh_token", session->RefreshToken().c_str());
+		obs_data_array_push_back(array, item);
+		obs_data_release(item);
+	}
+	SettingsManager::get().SetExtraSessions(array);
+	obs_data_array_release(array);
+}
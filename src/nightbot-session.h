@@ -0,0 +1,112 @@
+#ifndef NIGHTBOT_SESSION_H
+#define NIGHTBOT_SESSION_H
+
+#include <QList>
+#include <QObject>
+#include <QString>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "song-queue.h"
+
+class ApiRateLimit;
+
+// Uma conta do Nightbot: tokens, estado do refresh, limite de requisições e a última fila vista.
+// As saídas de "Tocando Agora" (fonte, arquivo e formato) não ficam aqui: são globais e seguem a
+// conta ativa, a única consultada; mantê-las por conta exigiria consultar todas o tempo todo.
+// Acessada das threads da API; tudo que muda depois da criação é protegido pelo mutex.
+class NightbotSession {
+public:
+	// A sessão "primary" usa as chaves antigas do settings.json; as demais ficam em extra_sessions.
+	static constexpr const char *PRIMARY_ID = "primary";
+
+	explicit NightbotSession(std::string id);
+
+	const std::string &Id() const { return id; }
+	bool IsPrimary() const { return id == PRIMARY_ID; }
+
+	std::string AccessToken() const;
+	std::string RefreshToken() const;
+	void SetTokens(const std::string &accessToken, const std::string &refreshToken);
+	bool IsAuthenticated() const;
+
+	std::string DisplayName() const;
+	void SetDisplayName(const std::string &name);
+
+	QList<SongItem> LastQueue() const;
+	void StoreQueue(const QList<SongItem> &queue);
+
+	// Consultas, importação e lotes.
+	const std::shared_ptr<ApiRateLimit> &RateLimit() const { return rateLimit; }
+	// Só os comandos do usuário (hotkeys e botões), separado para o volume não atrasá-los.
+	const std::shared_ptr<ApiRateLimit> &CommandRateLimit() const { return commandRateLimit; }
+
+	// Estado do refresh: uma renovação por vez e por conta.
+	std::atomic<bool> refreshing{false};
+	std::chrono::steady_clock::time_point lastRefreshSuccess;
+
+private:
+	const std::string id;
+	const std::shared_ptr<ApiRateLimit> rateLimit;
+	const std::shared_ptr<ApiRateLimit> commandRateLimit;
+
+	mutable std::mutex mutex;
+	std::string accessToken;
+	std::string refreshToken;
+	std::string displayName;
+	QList<SongItem> lastQueue;
+};
+
+// Contas conectadas e qual delas o dock e as hotkeys controlam. Todas compartilham o mesmo
+// transporte HTTP e o mesmo ApiScheduler; só a conta ativa é consultada periodicamente,
+// então o custo de uma conta parada é só a memória dos tokens e da última fila.
+class SessionManager : public QObject {
+	Q_OBJECT
+
+public:
+	static SessionManager &get();
+
+	// Lê as contas do settings.json. Chamado depois de SettingsManager::Load().
+	void Load();
+
+	std::shared_ptr<NightbotSession> Active() const;
+	std::vector<std::shared_ptr<NightbotSession>> Sessions() const;
+	std::shared_ptr<NightbotSession> Find(const std::string &id) const;
+	bool IsActive(const std::shared_ptr<NightbotSession> &session) const;
+
+	void SetActive(const std::string &id);
+	// Cria uma conta com os tokens recebidos e a torna ativa.
+	std::shared_ptr<NightbotSession> AddSession(const std::string &accessToken, const std::string &refreshToken);
+	// A conta principal só é desconectada (tokens apagados); as extras são removidas.
+	void RemoveSession(const std::string &id);
+	// Apaga só os tokens (refresh token recusado): a conta continua na lista, com o nome, e
+	// volta a funcionar com um novo login enquanto estiver selecionada.
+	void Disconnect(const std::shared_ptr<NightbotSession> &session);
+
+	// Atualiza o nome exibido da conta (vindo de /1/me) e grava se mudou.
+	void Rename(const std::shared_ptr<NightbotSession> &session, const std::string &name);
+
+	// Grava tokens e nome da conta no settings.json.
+	void Persist(const std::shared_ptr<NightbotSession> &session);
+
+signals:
+	void sessionsChanged();
+	void activeSessionChanged();
+
+private:
+	SessionManager() = default;
+
+	void PersistExtraSessions();
+
+	mutable std::mutex mutex;
+	std::vector<std::shared_ptr<NightbotSession>> sessions;
+	std::shared_ptr<NightbotSession> active;
+	int nextExtraId = 1;
+};
+
+#endif // NIGHTBOT_SESSION_H
@@ -13,13 +13,18 @@
 #include <QFileDialog>
 #include <QFile>
 #include <QFrame>
+#include <QTabWidget>
 
 #include "nightbot-settings.h"
 #include "nightbot-api.h"
 #include "nightbot-auth.h"
+#include "nightbot-session.h"
 #include "SettingsManager.h"
 #include "nightbot-dock.h"
+#include "diagnostics-panel.h"
+#include "moderation-panel.h"
 #include "plugin-support.h"
+#include "ui-stall-detector.h"
 
 extern NightbotDock *g_dock_widget;
 
@@ -53,10 +58,13 @@ NightbotSettingsDialog::NightbotSettingsDialog(QWidget *parent)
 		new QPushButton(get_obs_text("Nightbot.Settings.Connect"));
 	disconnectButton = new QPushButton(
 		get_obs_text("Nightbot.Settings.Disconnect"));
+	addChannelButton = new QPushButton(get_obs_text("Nightbot.Settings.AddChannel"));
+	addChannelButton->setToolTip(get_obs_text("Nightbot.Settings.AddChannel.Tooltip"));
 
 	QHBoxLayout *buttonLayout = new QHBoxLayout();
 	buttonLayout->addWidget(connectButton);
 	buttonLayout->addWidget(disconnectButton);
+	buttonLayout->addWidget(addChannelButton);
 
 	authLayout->addWidget(instructions);
 	authLayout->addSpacing(10);
@@ -81,6 +89,21 @@ NightbotSettingsDialog::NightbotSettingsDialog(QWidget *parent)
 
 	queueLayout->addLayout(refreshLayout);
 
+	QHBoxLayout *idleLayout = new QHBoxLayout();
+	QLabel *idleMultiplierLabel = new QLabel(get_obs_text("Nightbot.Settings.Polling.IdleMultiplier"));
+	idleMultiplierLabel->setToolTip(get_obs_text("Nightbot.Settings.Polling.IdleMultiplier.Tooltip"));
+	idleMultiplierSpinBox = new QSpinBox();
+	idleMultiplierSpinBox->setMinimum(1);
+	idleMultiplierSpinBox->setMaximum(12);
+	idleMultiplierSpinBox->setSuffix("x");
+	idleLayout->addWidget(idleMultiplierLabel);
+	idleLayout->addWidget(idleMultiplierSpinBox);
+	idleLayout->addStretch();
+	queueLayout->addLayout(idleLayout);
+
+	pauseWhenHiddenCheckBox = new QCheckBox(get_obs_text("Nightbot.Settings.Polling.PauseWhenHidden"));
+	queueLayout->addWidget(pauseWhenHiddenCheckBox);
+
 	// --- Seção "Tocando Agora" ---
 	QGroupBox *nowPlayingGroup = new QGroupBox(get_obs_text("Nightbot.Settings.NowPlaying"));
 	QVBoxLayout *nowPlayingLayout = new QVBoxLayout();
@@ -105,7 +128,7 @@ NightbotSettingsDialog::NightbotSettingsDialog(QWidget *parent)
 	formatLabelLayout->addStretch();
 
 	nowPlayingFormatLineEdit = new QLineEdit();
-	nowPlayingFormatLineEdit->setPlaceholderText("{music}, {artist}, {user}, {time}");
+	nowPlayingFormatLineEdit->setPlaceholderText("{music}, {artist}, {user}, {time}, {remaining}, {last}, {recent}");
 
 	nowPlayingLayout->addLayout(formatLabelLayout);
 	nowPlayingLayout->addWidget(nowPlayingFormatLineEdit);
@@ -158,12 +181,19 @@ NightbotSettingsDialog::NightbotSettingsDialog(QWidget *parent)
 	connect(clearPathButton, &QPushButton::clicked, this, &NightbotSettingsDialog::onClearPathClicked);
 	connect(filePathLineEdit, &QLineEdit::editingFinished, this, &NightbotSettingsDialog::onFilePathChanged);
 
-	mainLayout->addWidget(authGroup);
-	mainLayout->addWidget(queueGroup);
-	mainLayout->addWidget(nowPlayingGroup);
-	mainLayout->addLayout(outputLayout);
+	QWidget *generalTab = new QWidget();
+	QVBoxLayout *generalLayout = new QVBoxLayout(generalTab);
+	generalLayout->addWidget(authGroup);
+	generalLayout->addWidget(queueGroup);
+	generalLayout->addWidget(nowPlayingGroup);
+	generalLayout->addLayout(outputLayout);
+	generalLayout->addStretch();
 
-	mainLayout->addStretch();
+	QTabWidget *tabs = new QTabWidget();
+	tabs->addTab(generalTab, get_obs_text("Nightbot.Settings.Tab.General"));
+	tabs->addTab(new ModerationPanel(), get_obs_text("Nightbot.Settings.Tab.Moderation"));
+	tabs->addTab(new DiagnosticsPanel(), get_obs_text("Nightbot.Settings.Tab.Diagnostics"));
+	mainLayout->addWidget(tabs);
 
 	QFrame *line = new QFrame();
 	line->setFrameShape(QFrame::HLine);
@@ -183,11 +213,15 @@ NightbotSettingsDialog::NightbotSettingsDialog(QWidget *parent)
 		&NightbotSettingsDialog::onNowPlayingFormatChanged);
 	connect(autoRefreshCheckBox, &QCheckBox::toggled, this, &NightbotSettingsDialog::onAutoRefreshToggled);
 	connect(refreshIntervalSpinBox, QOverload<int>::of(&QSpinBox::valueChanged), this, &NightbotSettingsDialog::onRefreshIntervalChanged);
+	connect(idleMultiplierSpinBox, QOverload<int>::of(&QSpinBox::valueChanged), this, &NightbotSettingsDialog::onIdleMultiplierChanged);
+	connect(pauseWhenHiddenCheckBox, &QCheckBox::toggled, this, &NightbotSettingsDialog::onPauseWhenHiddenToggled);
 
 	connect(connectButton, &QPushButton::clicked, this,
 		&NightbotSettingsDialog::OnConnectClicked);
 	connect(disconnectButton, &QPushButton::clicked, this,
 		&NightbotSettingsDialog::OnDisconnectClicked);
+	connect(addChannelButton, &QPushButton::clicked, this, &NightbotSettingsDialog::OnAddChannelClicked);
+	connect(&SessionManager::get(), &SessionManager::activeSessionChanged, this, [this]() { UpdateUI(); });
 
 	connect(&auth, &NightbotAuth::authenticationFinished, this, [this](bool success){
 		UpdateUI(success); });
@@ -205,17 +239,26 @@ NightbotSettingsDialog::NightbotSettingsDialog(QWidget *parent)
 
 void NightbotSettingsDialog::OnConnectClicked()
 {
+	UI_SLOT_SCOPE("NightbotSettingsDialog::OnConnectClicked");
 	auth.Authenticate();
 }
 
+void NightbotSettingsDialog::OnAddChannelClicked()
+{
+	UI_SLOT_SCOPE("NightbotSettingsDialog::OnAddChannelClicked");
+	auth.Authenticate(true);
+}
+
 void NightbotSettingsDialog::OnDisconnectClicked()
 {
+	UI_SLOT_SCOPE("NightbotSettingsDialog::OnDisconnectClicked");
 	auth.ClearTokens();
 	UpdateUI(false);
 }
 
 void NightbotSettingsDialog::onAuthTimerUpdate(int remainingSeconds)
 {
+	UI_SLOT_SCOPE("NightbotSettingsDialog::onAuthTimerUpdate");
 	statusLabel->setText(
 		QString("<b>%1</b> <span style='color: #ffcc00;'>%2 (%3s)</span>")
 			.arg(get_obs_text("Nightbot.Settings.Status"))
@@ -226,9 +269,8 @@ void NightbotSettingsDialog::onAuthTimerUpdate(int remainingSeconds)
 
 void NightbotSettingsDialog::onUserInfoFetched(const QString &userName)
 {
+	UI_SLOT_SCOPE("NightbotSettingsDialog::onUserInfoFetched");
 	if (!userName.isEmpty()) {
-		SettingsManager::get().SetUserName(userName.toStdString());
-
 		if (g_dock_widget) {
 			NightbotAPI::get().FetchSongQueue(get_obs_text("Nightbot.Queue.PlaylistUser"));
 		}
@@ -239,6 +281,7 @@ void NightbotSettingsDialog::onUserInfoFetched(const QString &userName)
 
 void NightbotSettingsDialog::onAutoRefreshToggled(bool checked)
 {
+	UI_SLOT_SCOPE("NightbotSettingsDialog::onAutoRefreshToggled");
 	SettingsManager::get().SetAutoRefreshEnabled(checked);
 	refreshIntervalSpinBox->setEnabled(checked);
 	if (g_dock_widget)
@@ -247,12 +290,27 @@ void NightbotSettingsDialog::onAutoRefreshToggled(bool checked)
 
 void NightbotSettingsDialog::onRefreshIntervalChanged(int value)
 {
+	UI_SLOT_SCOPE("NightbotSettingsDialog::onRefreshIntervalChanged");
 	SettingsManager::get().SetAutoRefreshInterval(value);
 	if (g_dock_widget)
 		g_dock_widget->UpdateRefreshTimer();
 }
+
+void NightbotSettingsDialog::onIdleMultiplierChanged(int value)
+{
+	UI_SLOT_SCOPE("NightbotSettingsDialog::onIdleMultiplierChanged");
+	SettingsManager::get().SetPollIdleMultiplier(value);
+}
+
+void NightbotSettingsDialog::onPauseWhenHiddenToggled(bool checked)
+{
+	UI_SLOT_SCOPE("NightbotSettingsDialog::onPauseWhenHiddenToggled");
+	SettingsManager::get().SetPollPauseWhenHidden(checked);
+}
+
 void NightbotSettingsDialog::onSaveToFileToggled(bool checked)
 {
+	UI_SLOT_SCOPE("NightbotSettingsDialog::onSaveToFileToggled");
 	SettingsManager::get().SetNowPlayingToFileEnabled(checked);
 	filePathLineEdit->setEnabled(checked);
 	browseButton->setEnabled(checked);
@@ -271,18 +329,21 @@ void NightbotSettingsDialog::onBrowseFileClicked()
 
 void NightbotSettingsDialog::onClearPathClicked()
 {
+	UI_SLOT_SCOPE("NightbotSettingsDialog::onClearPathClicked");
 	filePathLineEdit->clear();
 	onFilePathChanged();
 }
 
 void NightbotSettingsDialog::onFilePathChanged()
 {
+	UI_SLOT_SCOPE("NightbotSettingsDialog::onFilePathChanged");
 	SettingsManager::get().SetNowPlayingToFilePath(filePathLineEdit->text().toStdString());
 	CheckFilePath();
 }
 
 void NightbotSettingsDialog::onApiError(const QString &error)
 {
+	UI_SLOT_SCOPE("NightbotSettingsDialog::onApiError");
 	Q_UNUSED(error);
 	authErrorLabel->setText(get_obs_text("Nightbot.Error.AuthenticationFailed"));
 	authErrorLabel->show();
@@ -330,14 +391,14 @@ void NightbotSettingsDialog::PopulateTextSources()
 
 void NightbotSettingsDialog::onNowPlayingSourceChanged(const QString &sourceName)
 {
+	UI_SLOT_SCOPE("NightbotSettingsDialog::onNowPlayingSourceChanged");
 	SettingsManager::get().SetNowPlayingSource(sourceName.toStdString());
-	SettingsManager::get().Save();
 }
 
 void NightbotSettingsDialog::onNowPlayingFormatChanged(const QString &format)
 {
+	UI_SLOT_SCOPE("NightbotSettingsDialog::onNowPlayingFormatChanged");
 	SettingsManager::get().SetNowPlayingFormat(format.toStdString());
-	SettingsManager::get().Save();
 }
 
 void NightbotSettingsDialog::UpdateUI(bool just_authenticated)
@@ -351,7 +412,7 @@ void NightbotSettingsDialog::UpdateUI(bool just_authenticated)
 	bool authenticated = auth.IsAuthenticated();
 
 	if (authenticated) {
-		std::string user_name = SettingsManager::get().GetNightUserName();
+		std::string user_name = SessionManager::get().Active()->DisplayName();
 		obs_log_info("[Nightbot SR/Settings] Authenticated user: %s",
 				user_name.c_str());
 
@@ -379,11 +440,14 @@ void NightbotSettingsDialog::UpdateUI(bool just_authenticated)
 
 	connectButton->setEnabled(!authenticated);
 	disconnectButton->setEnabled(authenticated);
+	addChannelButton->setEnabled(authenticated);
 
 	bool autoRefreshEnabled = SettingsManager::get().GetAutoRefreshEnabled();
 	autoRefreshCheckBox->setChecked(autoRefreshEnabled);
 	refreshIntervalSpinBox->setEnabled(autoRefreshEnabled);
 	refreshIntervalSpinBox->setValue(SettingsManager::get().GetAutoRefreshInterval());
+	idleMultiplierSpinBox->setValue(SettingsManager::get().GetPollIdleMultiplier());
+	pauseWhenHiddenCheckBox->setChecked(SettingsManager::get().GetPollPauseWhenHidden());
 
 	PopulateTextSources();
 	nowPlayingFormatLineEdit->setText(
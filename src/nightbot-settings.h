@@ -19,10 +19,13 @@ public:
 private slots:
 	void OnConnectClicked();
 	void OnDisconnectClicked();
+	void OnAddChannelClicked();
 	void onAuthTimerUpdate(int remainingSeconds);
 	void onUserInfoFetched(const QString &userName);
 	void onAutoRefreshToggled(bool checked);
 	void onRefreshIntervalChanged(int value);
+	void onIdleMultiplierChanged(int value);
+	void onPauseWhenHiddenToggled(bool checked);
 	void onNowPlayingSourceChanged(const QString &sourceName);
 	void onNowPlayingFormatChanged(const QString &format);
 	void onApiError(const QString &error);
@@ -40,8 +43,11 @@ private:
 	QLabel *authErrorLabel;
 	QPushButton *connectButton;
 	QPushButton *disconnectButton;
+	QPushButton *addChannelButton;
 	QCheckBox *autoRefreshCheckBox;
 	QSpinBox *refreshIntervalSpinBox;
+	QSpinBox *idleMultiplierSpinBox;
+	QCheckBox *pauseWhenHiddenCheckBox;
 	QComboBox *nowPlayingSourceComboBox;
 	QLineEdit *nowPlayingFormatLineEdit;
 	QCheckBox *saveToFileCheckBox;
@@ -0,0 +1,120 @@
+#include "now-playing-format.h"
+#include "song-queue.h"
+#include "play-history.h"
+#include "queue-eta.h"
+
+#include <QStringView>
+
+void NowPlayingFormat::Compile(const QString &newFormat)
+{
+	static const struct {
+		QLatin1String name;
+		Token token;
+	} placeholders[] = {
+		{QLatin1String("{music}"), Token::Music},
+		{QLatin1String("{artist}"), Token::Artist},
+		{QLatin1String("{user}"), Token::User},
+		{QLatin1String("{time}"), Token::Time},
+		{QLatin1String("{last}"), Token::Last},
+		{QLatin1String("{recent}"), Token::Recent},
+		{QLatin1String("{remaining}"), Token::Remaining},
+		{QLatin1String("{queue_remaining}"), Token::QueueRemaining},
+	};
+
+	format = newFormat;
+	segments.clear();
+	literalLength = 0;
+	usesHistory = false;
+	usesEta = false;
+
+	QString literal;
+	qsizetype i = 0;
+	while (i < format.size()) {
+		bool matched = false;
+		if (format.at(i) == QLatin1Char('{')) {
+			for (const auto &placeholder : placeholders) {
+				if (QStringView(format).mid(i).startsWith(placeholder.name)) {
+					if (!literal.isEmpty()) {
+						literalLength += literal.size();
+						segments.push_back({Token::Literal, literal});
+						literal.clear();
+					}
+					segments.push_back({placeholder.token, QString()});
+					usesHistory = usesHistory || placeholder.token == Token::Last ||
+						      placeholder.token == Token::Recent;
+					usesEta = usesEta || placeholder.token == Token::Remaining ||
+						  placeholder.token == Token::QueueRemaining;
+					i += placeholder.name.size();
+					matched = true;
+					break;
+				}
+			}
+		}
+
+		if (!matched) {
+			literal.append(format.at(i));
+			++i;
+		}
+	}
+
+	if (!literal.isEmpty()) {
+		literalLength += literal.size();
+		segments.push_back({Token::Literal, literal});
+	}
+}
+
+static QString PlayLabel(const PlayRecord &record)
+{
+	return record.artist.isEmpty() ? record.title : record.title + " - " + record.artist;
+}
+
+QString NowPlayingFormat::Render(const SongItem &song, const NowPlayingContext &context) const
+{
+	const std::vector<PlayRecord> *recent = context.recent;
+	QString result;
+	result.reserve(literalLength + song.title.size() + song.artist.size() + song.user.size() + 8);
+
+	for (const Segment &segment : segments) {
+		switch (segment.token) {
+		case Token::Literal:
+			result.append(segment.text);
+			break;
+		case Token::Music:
+			result.append(song.title);
+			break;
+		case Token::Artist:
+			result.append(song.artist);
+			break;
+		case Token::User:
+			result.append(song.user);
+			break;
+		case Token::Time:
+			result.append(QStringLiteral("%1:%2")
+					      .arg(song.duration / 60)
+					      .arg(song.duration % 60, 2, 10, QLatin1Char('0')));
+			break;
+		case Token::Last:
+			if (recent && !recent->empty())
+				result.append(PlayLabel(recent->front()));
+			break;
+		case Token::Recent:
+			if (recent)
+				for (size_t i = 0; i < recent->size() && i < RECENT_PLAYS; ++i) {
+					if (i > 0)
+						result.append(" | ");
+					result.append(PlayLabel((*recent)[i]));
+				}
+			break;
+		case Token::Remaining:
+			if (context.remainingSeconds >= 0)
+				result.append(QueueEta::FormatSeconds(context.remainingSeconds));
+			break;
+		case Token::QueueRemaining:
+			if (context.queueRemainingSeconds >= 0)
+				result.append(QueueEta::FormatSeconds(context.queueRemainingSeconds));
+			break;
+		}
+	}
+
+	return result;
+}
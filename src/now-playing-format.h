@@ -0,0 +1,50 @@
+#ifndef NOW_PLAYING_FORMAT_H
+#define NOW_PLAYING_FORMAT_H
+
+#include <QString>
+#include <cstdint>
+#include <vector>
+
+struct SongItem;
+struct PlayRecord;
+
+// Dados que não vêm da música atual. Só é preciso preencher o que o formato usa.
+struct NowPlayingContext {
+	// Últimas músicas tocadas, mais recente primeiro.
+	const std::vector<PlayRecord> *recent = nullptr;
+	// Segundos até acabar a música atual / a fila toda; negativo = desconhecido.
+	int64_t remainingSeconds = -1;
+	int64_t queueRemainingSeconds = -1;
+};
+
+// Modelo do texto "Tocando Agora" pré-compilado em segmentos, para que a
+// renderização a cada atualização da fila não precise procurar os placeholders.
+class NowPlayingFormat {
+public:
+	// Quantas músicas entram em {recent}.
+	static constexpr size_t RECENT_PLAYS = 3;
+
+	void Compile(const QString &format);
+	const QString &Format() const { return format; }
+	// {last} e {recent} precisam do histórico de reprodução; sem eles não vale consultar.
+	bool UsesHistory() const { return usesHistory; }
+	// {remaining} e {queue_remaining} mudam a cada segundo: o texto precisa ser refeito no tique.
+	bool UsesEta() const { return usesEta; }
+	QString Render(const SongItem &song, const NowPlayingContext &context = {}) const;
+
+private:
+	enum class Token { Literal, Music, Artist, User, Time, Last, Recent, Remaining, QueueRemaining };
+
+	struct Segment {
+		Token token;
+		QString text;
+	};
+
+	QString format;
+	std::vector<Segment> segments;
+	qsizetype literalLength = 0;
+	bool usesHistory = false;
+	bool usesEta = false;
+};
+
+#endif // NOW_PLAYING_FORMAT_H
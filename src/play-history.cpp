@@ -0,0 +1,531 @@
+#include "play-history.h"
+#include "trace-recorder.h"
+#include "plugin-support.h"
+
+#include <obs-module.h>
+
+#include <QDataStream>
+#include <QDate>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QPointer>
+#include <QSaveFile>
+#include <QThreadPool>
+#include <QtEndian>
+
+#include <algorithm>
+#include <limits>
+
+static const char *PLAY_HISTORY_DIR_NAME = "play-history";
+static const char *PLAY_HISTORY_INDEX_NAME = "index.bin";
+
+// 'NBPH'
+static const quint32 PLAY_HISTORY_MAGIC = 0x4E425048;
+// 2: resumo por conta. Um índice da versão 1 é descartado e os segmentos são relidos uma vez.
+static const quint16 PLAY_HISTORY_VERSION = 2;
+static const quint8 PLAY_RECORD_VERSION = 1;
+// Um registro de verdade tem poucas centenas de bytes; mais que isso é lixo no arquivo.
+static const quint32 PLAY_RECORD_MAX_BYTES = 64 * 1024;
+
+static const int64_t HOUR_MS = 60 * 60 * 1000;
+static const int64_t DAY_MS = 24 * HOUR_MS;
+// Sem leitura da fila por mais que isso (OBS fechado, consultas pausadas), o fim real é
+// desconhecido: a música termina na última vez em que foi vista.
+static const int64_t STALE_GAP_MS = 10 * 60 * 1000;
+// A troca só é vista na consulta seguinte, e o player tem seus atrasos: margem antes de chamar de pulada.
+static const int64_t FINISH_TOLERANCE_MS = 15 * 1000;
+
+static QThreadPool *g_playHistoryThread = nullptr;
+
+static QThreadPool *PlayHistoryThread()
+{
+	if (!g_playHistoryThread) {
+		g_playHistoryThread = new QThreadPool();
+		g_playHistoryThread->setMaxThreadCount(1);
+	}
+	return g_playHistoryThread;
+}
+
+static QString GetHistoryDir()
+{
+	char *path = obs_module_config_path(PLAY_HISTORY_DIR_NAME);
+	QString result = path ? QString::fromUtf8(path) : QString();
+	bfree(path);
+	return result;
+}
+
+static QString SegmentFileName(int64_t dayStartMs)
+{
+	return QDate(1970, 1, 1).addDays(dayStartMs / DAY_MS).toString("yyyyMMdd") + ".log";
+}
+
+static QByteArray EncodeRecord(const PlayRecord &record)
+{
+	QByteArray payload;
+	QDataStream out(&payload, QIODevice::WriteOnly);
+	out.setVersion(QDataStream::Qt_6_0);
+	out << PLAY_RECORD_VERSION << record.account << record.songId << record.title << record.artist << record.user
+	    << qint32(record.duration) << qint64(record.startMs) << qint64(record.endMs) << record.skipped;
+
+	QByteArray frame(sizeof(quint32), Qt::Uninitialized);
+	qToBigEndian(static_cast<quint32>(payload.size()), frame.data());
+	frame += payload;
+	return frame;
+}
+
+void ShutdownPlayHistory()
+{
+	PlayHistory::get().Flush();
+	delete g_playHistoryThread;
+	g_playHistoryThread = nullptr;
+}
+
+PlayHistory &PlayHistory::get()
+{
+	static PlayHistory instance;
+	return instance;
+}
+
+bool PlayHistory::ReadSegment(const QString &path, std::vector<PlayRecord> &out)
+{
+	QFile file(path);
+	if (!file.open(QIODevice::ReadOnly))
+		return false;
+
+	// Um segmento é um dia de músicas: poucos KB, lido de uma vez.
+	const QByteArray data = file.readAll();
+	qsizetype offset = 0;
+	while (offset + static_cast<qsizetype>(sizeof(quint32)) <= data.size()) {
+		const quint32 length = qFromBigEndian<quint32>(data.constData() + offset);
+		offset += static_cast<qsizetype>(sizeof(quint32));
+		// Registro cortado no fim (crash durante a gravação): o resto do arquivo é descartado.
+		if (length > PLAY_RECORD_MAX_BYTES || offset + static_cast<qsizetype>(length) > data.size())
+			break;
+
+		QDataStream in(data.mid(offset, length));
+		in.setVersion(QDataStream::Qt_6_0);
+		offset += length;
+
+		quint8 version = 0;
+		PlayRecord record;
+		qint32 duration = 0;
+		qint64 startMs = 0;
+		qint64 endMs = 0;
+		in >> version;
+		if (version != PLAY_RECORD_VERSION)
+			continue;
+		in >> record.account >> record.songId >> record.title >> record.artist >> record.user >> duration >>
+			startMs >> endMs >> record.skipped;
+		if (in.status() != QDataStream::Ok)
+			continue;
+		record.duration = duration;
+		record.startMs = startMs;
+		record.endMs = endMs;
+		out.push_back(std::move(record));
+	}
+	return true;
+}
+
+void PlayHistory::AddToSummary(SegmentSummary &summary, const PlayRecord &record)
+{
+	if (summary.count == 0 || record.startMs < summary.firstStartMs)
+		summary.firstStartMs = record.startMs;
+	summary.lastStartMs = std::max(summary.lastStartMs, record.startMs);
+	summary.count++;
+	const int64_t hour = std::clamp<int64_t>((record.startMs - summary.dayStartMs) / HOUR_MS, 0, 23);
+	summary.playsByHour[static_cast<size_t>(hour)]++;
+	if (!record.user.isEmpty())
+		summary.playsByUser[record.user.toLower()]++;
+	if (!record.account.isEmpty())
+		summary.playsByAccount[record.account]++;
+}
+
+void PlayHistory::Load()
+{
+	// Índice, stat de até MAX_SEGMENTS arquivos e talvez releituras: nada disso no caminho de carga do OBS.
+	PlayHistoryThread()->start([this]() {
+		std::lock_guard<std::mutex> lock(mutex);
+		LoadLocked();
+	});
+}
+
+void PlayHistory::LoadLocked()
+{
+	if (loaded)
+		return;
+	loaded = true;
+	TRACE_SCOPE("PlayHistory::Load", "io");
+
+	const QString dirPath = GetHistoryDir();
+	if (dirPath.isEmpty())
+		return;
+	QDir dir(dirPath);
+
+	QHash<QString, SegmentSummary> indexed;
+	QFile indexFile(dir.filePath(PLAY_HISTORY_INDEX_NAME));
+	if (indexFile.open(QIODevice::ReadOnly)) {
+		QDataStream in(&indexFile);
+		in.setVersion(QDataStream::Qt_6_0);
+		quint32 magic = 0;
+		quint16 version = 0;
+		quint32 count = 0;
+		in >> magic >> version >> count;
+		for (quint32 i = 0; i < count && magic == PLAY_HISTORY_MAGIC && version == PLAY_HISTORY_VERSION &&
+				    in.status() == QDataStream::Ok;
+		     ++i) {
+			SegmentSummary summary;
+			qint64 dayStartMs = 0;
+			qint64 firstStartMs = 0;
+			qint64 lastStartMs = 0;
+			in >> summary.fileName >> dayStartMs >> firstStartMs >> lastStartMs >> summary.count >>
+				summary.bytes;
+			for (uint32_t &hourCount : summary.playsByHour)
+				in >> hourCount;
+			in >> summary.playsByUser >> summary.playsByAccount;
+			summary.dayStartMs = dayStartMs;
+			summary.firstStartMs = firstStartMs;
+			summary.lastStartMs = lastStartMs;
+			if (in.status() == QDataStream::Ok)
+				indexed.insert(summary.fileName, std::move(summary));
+		}
+	}
+
+	// O índice só é confiável para segmentos que não mudaram desde que ele foi salvo.
+	int rescanned = 0;
+	const QStringList files = dir.entryList({"????????.log"}, QDir::Files, QDir::Name);
+	for (const QString &fileName : files) {
+		const QDate day = QDate::fromString(fileName.left(8), "yyyyMMdd");
+		if (!day.isValid())
+			continue;
+
+		const qint64 bytes = QFileInfo(dir.filePath(fileName)).size();
+		auto found = indexed.find(fileName);
+		if (found != indexed.end() && found->bytes == bytes) {
+			segments.push_back(std::move(found.value()));
+		} else {
+			SegmentSummary summary;
+			summary.fileName = fileName;
+			summary.dayStartMs = QDate(1970, 1, 1).daysTo(day) * DAY_MS;
+			summary.bytes = bytes;
+			std::vector<PlayRecord> records;
+			ReadSegment(dir.filePath(fileName), records);
+			for (const PlayRecord &record : records)
+				AddToSummary(summary, record);
+			segments.push_back(std::move(summary));
+			rescanned++;
+		}
+		totalPlays += segments.back().count;
+	}
+
+	int removed = 0;
+	while (segments.size() > MAX_SEGMENTS) {
+		dir.remove(segments.front().fileName);
+		totalPlays -= segments.front().count;
+		segments.erase(segments.begin());
+		removed++;
+	}
+
+	// O anel das recentes vem do fim do log: normalmente só o segmento de hoje.
+	for (auto it = segments.rbegin(); it != segments.rend() && recent.size() < RECENT_CAPACITY; ++it) {
+		std::vector<PlayRecord> records;
+		ReadSegment(dir.filePath(it->fileName), records);
+		for (auto record = records.rbegin(); record != records.rend() && recent.size() < RECENT_CAPACITY;
+		     ++record)
+			recent.push_front(std::move(*record));
+	}
+
+	if (rescanned > 0 || removed > 0)
+		SaveIndexLocked();
+
+	obs_log_info("[Nightbot SR/Plays] Loaded %llu play(s) in %zu segment(s) (%d rescanned, %d expired).",
+		     static_cast<unsigned long long>(totalPlays), segments.size(), rescanned, removed);
+}
+
+void PlayHistory::ObserveQueue(const std::string &account, const QList<SongItem> &queue)
+{
+	const int64_t now = QDateTime::currentMSecsSinceEpoch();
+	const SongItem *current = (!queue.isEmpty() && queue.first().position == 0) ? &queue.first() : nullptr;
+
+	std::lock_guard<std::mutex> lock(mutex);
+	LoadLocked();
+	const bool firstLook = observedAccounts.insert(account).second;
+
+	auto it = playing.find(account);
+	if (it != playing.end()) {
+		if (current && it->second.song.id == current->id) {
+			it->second.lastSeenMs = now;
+			return;
+		}
+		Finish(account, it->second, now);
+		playing.erase(it);
+	}
+
+	if (!current)
+		return;
+
+	Tracking tracking;
+	tracking.song = *current;
+	tracking.startMs = now;
+	tracking.lastSeenMs = now;
+	tracking.joinedLate = firstLook;
+	playing.emplace(account, std::move(tracking));
+}
+
+void PlayHistory::MarkSkipRequested(const std::string &account)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	auto it = playing.find(account);
+	if (it != playing.end())
+		it->second.skipRequested = true;
+}
+
+void PlayHistory::Finish(const std::string &account, const Tracking &tracking, int64_t nowMs)
+{
+	const bool stale = nowMs - tracking.lastSeenMs > STALE_GAP_MS;
+
+	PlayRecord record;
+	record.account = QString::fromStdString(account);
+	record.songId = tracking.song.id;
+	record.title = tracking.song.title;
+	record.artist = tracking.song.artist;
+	record.user = tracking.song.user;
+	record.duration = tracking.song.duration;
+	record.startMs = tracking.startMs;
+	record.endMs = stale ? tracking.lastSeenMs : nowMs;
+	// Sem saber quando começou ou terminou, a música é dada como terminada.
+	const int64_t playedMs = record.endMs - record.startMs;
+	record.skipped = tracking.skipRequested ||
+			 (!tracking.joinedLate && !stale && record.duration > 0 &&
+			  playedMs + FINISH_TOLERANCE_MS < int64_t(record.duration) * 1000);
+	Append(record);
+}
+
+void PlayHistory::Append(const PlayRecord &record)
+{
+	const QString dirPath = GetHistoryDir();
+	if (dirPath.isEmpty())
+		return;
+
+	// Relógio que volta não cria segmento "no passado": o registro vai para o último.
+	const int64_t dayStart = record.startMs - record.startMs % DAY_MS;
+	const bool rolled = segments.empty() || dayStart > segments.back().dayStartMs;
+	if (rolled) {
+		SegmentSummary summary;
+		summary.fileName = SegmentFileName(dayStart);
+		summary.dayStartMs = dayStart;
+		segments.push_back(std::move(summary));
+
+		QStringList expired;
+		while (segments.size() > MAX_SEGMENTS) {
+			expired << segments.front().fileName;
+			totalPlays -= segments.front().count;
+			segments.erase(segments.begin());
+		}
+		if (!expired.isEmpty())
+			PlayHistoryThread()->start([dirPath, expired]() {
+				QDir dir(dirPath);
+				for (const QString &fileName : expired)
+					dir.remove(fileName);
+			});
+	}
+
+	const QByteArray frame = EncodeRecord(record);
+	SegmentSummary &segment = segments.back();
+	AddToSummary(segment, record);
+	segment.bytes += frame.size();
+	totalPlays++;
+	indexDirty = true;
+	appendCount++;
+	recentCache.clear();
+
+	recent.push_back(record);
+	if (recent.size() > RECENT_CAPACITY)
+		recent.pop_front();
+
+	// O índice é salvo quando um dia começa; o segmento de hoje é relido se o OBS cair antes do Flush.
+	if (rolled)
+		SaveIndexLocked();
+
+	obs_log_info("[Nightbot SR/Plays] %s '%s' (%lld s of %d s).", record.skipped ? "Skipped" : "Finished",
+		     record.title.toUtf8().constData(), static_cast<long long>((record.endMs - record.startMs) / 1000),
+		     record.duration);
+
+	PlayHistoryThread()->start([path = QDir(dirPath).filePath(segment.fileName), dirPath, frame]() {
+		TRACE_SCOPE("PlayHistory::Append", "io");
+		QDir().mkpath(dirPath);
+		QFile file(path);
+		if (!file.open(QIODevice::WriteOnly | QIODevice::Append) || file.write(frame) != frame.size())
+			obs_log_warning("[Nightbot SR/Plays] Failed to append to '%s': %s", path.toUtf8().constData(),
+					file.errorString().toUtf8().constData());
+	});
+}
+
+std::vector<PlayRecord> PlayHistory::Query(const std::function<bool(const PlayRecord &)> &match,
+					   const std::function<bool(const SegmentSummary &)> &useSegment, size_t limit)
+{
+	std::vector<PlayRecord> result;
+	QStringList paths;
+	int64_t cutoff;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		LoadLocked();
+		for (auto it = recent.rbegin(); it != recent.rend() && result.size() < limit; ++it)
+			if (match(*it))
+				result.push_back(*it);
+		if (result.size() >= limit || recent.size() >= totalPlays)
+			return result;
+
+		// Tudo a partir do mais antigo do anel já foi visto (e pode nem estar no disco ainda).
+		cutoff = recent.empty() ? std::numeric_limits<int64_t>::max() : recent.front().startMs;
+		const QDir dir(GetHistoryDir());
+		for (auto it = segments.rbegin(); it != segments.rend(); ++it)
+			if (it->count > 0 && it->firstStartMs < cutoff && useSegment(*it))
+				paths << dir.filePath(it->fileName);
+	}
+
+	TRACE_SCOPE("PlayHistory::Query", "io");
+	for (const QString &path : paths) {
+		std::vector<PlayRecord> records;
+		ReadSegment(path, records);
+		for (auto it = records.rbegin(); it != records.rend(); ++it) {
+			if (it->startMs >= cutoff || !match(*it))
+				continue;
+			result.push_back(std::move(*it));
+			if (result.size() >= limit)
+				return result;
+		}
+	}
+	return result;
+}
+
+std::vector<PlayRecord> PlayHistory::Recent(size_t limit, const QString &account)
+{
+	const QString key = account + '\n' + QString::number(limit);
+	uint64_t seenAppends;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		LoadLocked();
+		auto cached = recentCache.constFind(key);
+		if (cached != recentCache.cend())
+			return cached.value();
+		seenAppends = appendCount;
+	}
+
+	std::vector<PlayRecord> result = Query(
+		[&account](const PlayRecord &record) { return account.isEmpty() || record.account == account; },
+		[&account](const SegmentSummary &segment) {
+			return account.isEmpty() || segment.playsByAccount.contains(account);
+		},
+		limit);
+
+	// Uma música gravada durante a leitura pode não estar no resultado: esse não é guardado.
+	std::lock_guard<std::mutex> lock(mutex);
+	if (appendCount == seenAppends)
+		recentCache.insert(key, result);
+	return result;
+}
+
+std::vector<PlayRecord> PlayHistory::ByUser(const QString &user, size_t limit)
+{
+	const QString key = user.toLower();
+	return Query([&key](const PlayRecord &record) { return record.user.toLower() == key; },
+		     [&key](const SegmentSummary &segment) { return segment.playsByUser.contains(key); }, limit);
+}
+
+void PlayHistory::ByUserAsync(const QString &user, size_t limit, QObject *receiver,
+			      std::function<void(const std::vector<PlayRecord> &)> done)
+{
+	QPointer<QObject> guard(receiver);
+	PlayHistoryThread()->start([this, user, limit, guard, done = std::move(done)]() {
+		std::vector<PlayRecord> records = ByUser(user, limit);
+		if (guard)
+			QMetaObject::invokeMethod(
+				guard, [done, records = std::move(records)]() { done(records); }, Qt::QueuedConnection);
+	});
+}
+
+std::vector<std::pair<int64_t, uint32_t>> PlayHistory::PlaysPerHour(int64_t fromMs, int64_t toMs)
+{
+	std::vector<std::pair<int64_t, uint32_t>> result;
+	std::lock_guard<std::mutex> lock(mutex);
+	LoadLocked();
+	for (const SegmentSummary &segment : segments) {
+		if (segment.dayStartMs + DAY_MS <= fromMs || segment.dayStartMs >= toMs)
+			continue;
+		for (size_t hour = 0; hour < segment.playsByHour.size(); ++hour) {
+			const int64_t hourStart = segment.dayStartMs + static_cast<int64_t>(hour) * HOUR_MS;
+			if (segment.playsByHour[hour] > 0 && hourStart + HOUR_MS > fromMs && hourStart < toMs)
+				result.emplace_back(hourStart, segment.playsByHour[hour]);
+		}
+	}
+	return result;
+}
+
+QString PlayHistory::Report()
+{
+	const int64_t now = QDateTime::currentMSecsSinceEpoch();
+	const auto hours = PlaysPerHour(now - DAY_MS, now);
+
+	QString report;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		report = QString("  %1 play(s) in %2 segment(s), %3 in memory\n")
+				 .arg(static_cast<qulonglong>(totalPlays))
+				 .arg(static_cast<qulonglong>(segments.size()))
+				 .arg(static_cast<qulonglong>(recent.size()));
+	}
+	if (hours.empty())
+		return report;
+
+	QStringList perHour;
+	for (const auto &[hourStart, count] : hours)
+		perHour << QString("%1 %2").arg(QDateTime::fromMSecsSinceEpoch(hourStart).toString("HH:00")).arg(count);
+	report += "  last 24 h: " + perHour.join(", ") + "\n";
+	return report;
+}
+
+void PlayHistory::SaveIndexLocked()
+{
+	const QString dirPath = GetHistoryDir();
+	if (dirPath.isEmpty())
+		return;
+	indexDirty = false;
+
+	QByteArray data;
+	QDataStream out(&data, QIODevice::WriteOnly);
+	out.setVersion(QDataStream::Qt_6_0);
+	out << PLAY_HISTORY_MAGIC << PLAY_HISTORY_VERSION << quint32(segments.size());
+	for (const SegmentSummary &summary : segments) {
+		out << summary.fileName << qint64(summary.dayStartMs) << qint64(summary.firstStartMs)
+		    << qint64(summary.lastStartMs) << quint32(summary.count) << summary.bytes;
+		for (uint32_t hourCount : summary.playsByHour)
+			out << quint32(hourCount);
+		out << summary.playsByUser << summary.playsByAccount;
+	}
+
+	PlayHistoryThread()->start([dirPath, data]() {
+		QDir().mkpath(dirPath);
+		QSaveFile file(QDir(dirPath).filePath(PLAY_HISTORY_INDEX_NAME));
+		if (!file.open(QIODevice::WriteOnly)) {
+			obs_log_warning("[Nightbot SR/Plays] Failed to open play history index for writing: %s",
+					file.errorString().toUtf8().constData());
+			return;
+		}
+		file.write(data);
+		if (!file.commit())
+			obs_log_warning("[Nightbot SR/Plays] Failed to write play history index: %s",
+					file.errorString().toUtf8().constData());
+	});
+}
+
+void PlayHistory::Flush()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (indexDirty)
+			SaveIndexLocked();
+	}
+	PlayHistoryThread()->waitForDone();
+}
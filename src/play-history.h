@@ -0,0 +1,132 @@
+#ifndef PLAY_HISTORY_H
+#define PLAY_HISTORY_H
+
+#include <QHash>
+#include <QList>
+#include <QString>
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "song-queue.h"
+
+class QObject;
+
+// Uma música que passou por _currentSong.
+struct PlayRecord {
+	QString account;
+	QString songId;
+	QString title;
+	QString artist;
+	QString user;
+	int duration = 0;
+	int64_t startMs = 0;
+	int64_t endMs = 0;
+	bool skipped = false;
+};
+
+// Histórico do que tocou, em play-history/ na pasta de configuração do plugin.
+//
+// O log só cresce no fim: um segmento por dia (UTC), cada registro com o tamanho na frente,
+// então um registro cortado por um crash só perde ele mesmo. Para cada segmento fica em
+// memória um resumo (intervalo, total, plays por hora e por usuário), salvo em index.bin;
+// as consultas usam o resumo para abrir só os segmentos que interessam. Em memória ficam
+// apenas os resumos e as últimas RECENT_CAPACITY músicas, não importa o tamanho do log.
+// Segmentos além de MAX_SEGMENTS dias são apagados.
+class PlayHistory {
+public:
+	static constexpr size_t RECENT_CAPACITY = 50;
+	static constexpr size_t MAX_SEGMENTS = 400;
+
+	static PlayHistory &get();
+
+	// Lê o índice e o fim do log na thread do histórico. Chamado na carga do plugin; uma chamada
+	// que chegue antes de a leitura terminar espera por ela.
+	void Load();
+
+	// Chamado a cada leitura ao vivo da fila; registra a música anterior quando a atual muda.
+	void ObserveQueue(const std::string &account, const QList<SongItem> &queue);
+	// A próxima troca de música desta conta conta como pulada, não importa o tempo tocado.
+	void MarkSkipRequested(const std::string &account);
+
+	// Mais recentes primeiro. Conta vazia = todas. Só lê o disco se pedir mais que o anel guarda,
+	// e o resultado fica guardado até a próxima música gravada (o dock pede a cada segundo).
+	std::vector<PlayRecord> Recent(size_t limit, const QString &account = QString());
+	// Mais recentes primeiro; abre só os segmentos em que o usuário aparece.
+	std::vector<PlayRecord> ByUser(const QString &user, size_t limit);
+	// ByUser na thread do histórico, para a UI não ler segmentos do disco. "done" roda na thread
+	// de "receiver", pela fila de eventos; não roda se ele já tiver sido destruído.
+	void ByUserAsync(const QString &user, size_t limit, QObject *receiver,
+			 std::function<void(const std::vector<PlayRecord> &)> done);
+	// (início da hora, plays) entre fromMs e toMs, só com os resumos.
+	std::vector<std::pair<int64_t, uint32_t>> PlaysPerHour(int64_t fromMs, int64_t toMs);
+
+	QString Report();
+	// Espera as gravações pendentes e salva o índice.
+	void Flush();
+
+	PlayHistory(PlayHistory const &) = delete;
+	void operator=(PlayHistory const &) = delete;
+
+private:
+	PlayHistory() = default;
+
+	struct SegmentSummary {
+		QString fileName;
+		int64_t dayStartMs = 0;
+		int64_t firstStartMs = 0;
+		int64_t lastStartMs = 0;
+		uint32_t count = 0;
+		// Tamanho do arquivo quando o resumo foi feito; se não bater na carga, o segmento é relido.
+		qint64 bytes = 0;
+		std::array<uint32_t, 24> playsByHour{};
+		// Chave: usuário em minúsculas.
+		QHash<QString, uint32_t> playsByUser;
+		QHash<QString, uint32_t> playsByAccount;
+	};
+
+	struct Tracking {
+		SongItem song;
+		int64_t startMs = 0;
+		int64_t lastSeenMs = 0;
+		// Já tocava quando a observação começou: o início real é desconhecido.
+		bool joinedLate = false;
+		bool skipRequested = false;
+	};
+
+	// Com o mutex travado; só a primeira chamada lê o disco.
+	void LoadLocked();
+	void Finish(const std::string &account, const Tracking &tracking, int64_t nowMs);
+	void Append(const PlayRecord &record);
+	// Primeiro o anel; só então os segmentos aceitos por useSegment, do mais novo para o mais antigo.
+	std::vector<PlayRecord> Query(const std::function<bool(const PlayRecord &)> &match,
+				      const std::function<bool(const SegmentSummary &)> &useSegment, size_t limit);
+	static void AddToSummary(SegmentSummary &summary, const PlayRecord &record);
+	static bool ReadSegment(const QString &path, std::vector<PlayRecord> &out);
+	void SaveIndexLocked();
+
+	std::mutex mutex;
+	bool loaded = false;
+	bool indexDirty = false;
+	// Do mais antigo para o mais novo.
+	std::vector<SegmentSummary> segments;
+	std::deque<PlayRecord> recent;
+	uint64_t totalPlays = 0;
+	std::unordered_map<std::string, Tracking> playing;
+	std::unordered_set<std::string> observedAccounts;
+	// Resultados de Recent por "conta\nlimite"; zerados a cada Append.
+	QHash<QString, std::vector<PlayRecord>> recentCache;
+	uint64_t appendCount = 0;
+};
+
+void ShutdownPlayHistory();
+
+#endif // PLAY_HISTORY_H
@@ -0,0 +1,252 @@
+#include "plugin-log.h"
+#include "plugin-support.h"
+
+#include <util/base.h>
+#include <util/platform.h>
+
+#include <QStringList>
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <iterator>
+
+// Mensagens mais longas são cortadas; nenhuma da camada de rede chega perto disso.
+static const size_t MESSAGE_MAX = 1024;
+
+static const char *LEVEL_NAMES[] = {"debug", "info", "warning", "error"};
+
+static int ObsLevel(LogLevel level)
+{
+	switch (level) {
+	case LogLevel::Error:
+		return LOG_ERROR;
+	case LogLevel::Warning:
+		return LOG_WARNING;
+	default:
+		// O OBS só grava LOG_DEBUG com --verbose; quem liga o debug do plugin quer as linhas no log normal.
+		return LOG_INFO;
+	}
+}
+
+static void LogLine(int obsLevel, const char *format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	blogva(obsLevel, format, args);
+	va_end(args);
+}
+
+static uint64_t HashText(const char *text)
+{
+	// FNV-1a; colisões são conferidas pelo texto.
+	uint64_t hash = 1469598103934665603ull;
+	for (const char *c = text; *c; ++c) {
+		hash ^= static_cast<unsigned char>(*c);
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+static std::string RepeatedSuffix(uint32_t count)
+{
+	return " (repeated " + std::to_string(count) + " more time(s))";
+}
+
+PluginLog &PluginLog::get()
+{
+	static PluginLog instance;
+	return instance;
+}
+
+PluginLog::PluginLog()
+{
+	for (size_t i = 0; i < static_cast<size_t>(LogCategory::Count); ++i)
+		configuredLevels[i] = LogLevel::Info;
+
+	const QString spec = qEnvironmentVariable("NIGHTBOT_SR_LOG_LEVELS");
+	for (const QString &entry : spec.split(',', Qt::SkipEmptyParts)) {
+		const QStringList parts = entry.split('=');
+		if (parts.size() != 2)
+			continue;
+		for (size_t level = 0; level < std::size(LEVEL_NAMES); ++level) {
+			if (parts[1].trimmed().compare(LEVEL_NAMES[level], Qt::CaseInsensitive) != 0)
+				continue;
+			for (size_t i = 0; i < static_cast<size_t>(LogCategory::Count); ++i) {
+				if (parts[0].trimmed().compare(Tag(static_cast<LogCategory>(i)), Qt::CaseInsensitive) == 0)
+					configuredLevels[i] = static_cast<LogLevel>(level);
+			}
+		}
+	}
+
+	for (size_t i = 0; i < static_cast<size_t>(LogCategory::Count); ++i)
+		levels[i].store(static_cast<int>(configuredLevels[i]));
+}
+
+const char *PluginLog::Tag(LogCategory category)
+{
+	switch (category) {
+	case LogCategory::Api:
+		return "API";
+	case LogCategory::Http:
+		return "HTTP";
+	case LogCategory::Push:
+		return "Push";
+	default:
+		return "Log";
+	}
+}
+
+std::string PluginLog::Line(LogCategory category, const std::string &text)
+{
+	return std::string("[Nightbot SR/") + Tag(category) + "] " + text;
+}
+
+void PluginLog::SetLevel(LogCategory category, LogLevel level)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	configuredLevels[static_cast<size_t>(category)] = level;
+	levels[static_cast<size_t>(category)].store(static_cast<int>(level));
+}
+
+void PluginLog::SetRequestDebug(bool enabled)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	for (LogCategory category : {LogCategory::Api, LogCategory::Http}) {
+		const size_t index = static_cast<size_t>(category);
+		levels[index].store(static_cast<int>(enabled ? LogLevel::Debug : configuredLevels[index]));
+	}
+}
+
+void PluginLog::Write(LogCategory category, LogLevel level, const char *format, ...)
+{
+	char message[MESSAGE_MAX];
+	va_list args;
+	va_start(args, format);
+	vsnprintf(message, sizeof(message), format, args);
+	va_end(args);
+	Emit(category, level, message);
+}
+
+bool PluginLog::TakeToken(CategoryState &state, uint64_t nowNs)
+{
+	if (state.lastRefillNs != 0)
+		state.tokens = std::min(TOKEN_BURST, state.tokens + static_cast<double>(nowNs - state.lastRefillNs) /
+									    1e9 * TOKENS_PER_SECOND);
+	state.lastRefillNs = nowNs;
+	if (state.tokens < 1.0)
+		return false;
+	state.tokens -= 1.0;
+	return true;
+}
+
+void PluginLog::CollectExpired(uint64_t nowNs, bool all, Lines &out)
+{
+	for (size_t i = 0; i < states.size(); ++i) {
+		for (Repeat &repeat : states[i].repeats) {
+			if (repeat.suppressed == 0 || (!all && nowNs - repeat.lastEmitNs < REPEAT_WINDOW_NS))
+				continue;
+			out.emplace_back(repeat.obsLevel,
+					 Line(static_cast<LogCategory>(i), repeat.text + RepeatedSuffix(repeat.suppressed)));
+			// O resumo conta como a mensagem: se ela continuar, sai de novo só na próxima janela.
+			repeat.suppressed = 0;
+			repeat.lastEmitNs = nowNs;
+		}
+	}
+}
+
+void PluginLog::Emit(LogCategory category, LogLevel level, const char *message)
+{
+	const uint64_t nowNs = os_gettime_ns();
+	Lines lines;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		CollectExpired(nowNs, false, lines);
+
+		if (level != LogLevel::Debug) {
+			CategoryState &state = states[static_cast<size_t>(category)];
+			const uint64_t hash = HashText(message);
+			Repeat *slot = nullptr;
+			Repeat *oldest = &state.repeats[0];
+			for (Repeat &repeat : state.repeats) {
+				if (repeat.lastEmitNs != 0 && repeat.hash == hash && repeat.text == message) {
+					slot = &repeat;
+					break;
+				}
+				if (repeat.lastEmitNs < oldest->lastEmitNs)
+					oldest = &repeat;
+			}
+
+			if (slot && nowNs - slot->lastEmitNs < REPEAT_WINDOW_NS) {
+				slot->suppressed++;
+				collapsed.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+			if (!TakeToken(state, nowNs)) {
+				state.dropped++;
+				dropped.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+			if (state.dropped > 0) {
+				lines.emplace_back(LOG_WARNING, Line(category, std::to_string(state.dropped) +
+										       " message(s) dropped by the log rate limit."));
+				state.dropped = 0;
+			}
+
+			if (!slot) {
+				slot = oldest;
+				// Quem sai da tabela leva o resumo junto.
+				if (slot->suppressed > 0)
+					lines.emplace_back(slot->obsLevel,
+							   Line(category, slot->text + RepeatedSuffix(slot->suppressed)));
+				slot->hash = hash;
+				slot->text = message;
+			}
+			slot->suppressed = 0;
+			slot->lastEmitNs = nowNs;
+			slot->obsLevel = ObsLevel(level);
+		}
+
+		lines.emplace_back(ObsLevel(level), Line(category, message));
+	}
+
+	for (const auto &line : lines)
+		LogLine(line.first, "%s", line.second.c_str());
+	written.fetch_add(lines.size(), std::memory_order_relaxed);
+}
+
+void PluginLog::Flush()
+{
+	Lines lines;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		CollectExpired(os_gettime_ns(), true, lines);
+		for (size_t i = 0; i < states.size(); ++i) {
+			if (states[i].dropped == 0)
+				continue;
+			lines.emplace_back(LOG_WARNING, Line(static_cast<LogCategory>(i),
+							     std::to_string(states[i].dropped) +
+								     " message(s) dropped by the log rate limit."));
+			states[i].dropped = 0;
+		}
+	}
+
+	for (const auto &line : lines)
+		LogLine(line.first, "%s", line.second.c_str());
+	written.fetch_add(lines.size(), std::memory_order_relaxed);
+}
+
+QString PluginLog::Report() const
+{
+	QStringList levelText;
+	for (size_t i = 0; i < static_cast<size_t>(LogCategory::Count); ++i)
+		levelText << QString("%1=%2")
+				     .arg(QString(Tag(static_cast<LogCategory>(i))).toLower(),
+					  LEVEL_NAMES[std::clamp(levels[i].load(), 0, 3)]);
+
+	return QString("  %1 line(s) written, %2 repeat(s) collapsed, %3 dropped by rate limit\n  levels: %4\n")
+		.arg(static_cast<qulonglong>(written.load()))
+		.arg(static_cast<qulonglong>(collapsed.load()))
+		.arg(static_cast<qulonglong>(dropped.load()))
+		.arg(levelText.join(' '));
+}
@@ -0,0 +1,95 @@
+#ifndef PLUGIN_LOG_H
+#define PLUGIN_LOG_H
+
+#include <QString>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Log da camada de rede, na frente do blogva do OBS.
+//
+//  - Cada categoria tem um nível mínimo; abaixo dele PLUGIN_LOG não formata nem avalia os argumentos.
+//  - Mensagens iguais dentro de REPEAT_WINDOW_NS saem uma vez; as repetições viram uma linha
+//    "(repeated N times)" no fim da janela.
+//  - Um token bucket por categoria limita o resto; o que for descartado é contado e avisado.
+//  - Debug (uma linha por requisição) não passa pelo bucket: quem liga quer ver tudo.
+// NIGHTBOT_SR_LOG_LEVELS="api=debug,push=warning" muda os níveis na inicialização.
+enum class LogCategory { Api, Http, Push, Count };
+enum class LogLevel { Debug, Info, Warning, Error };
+
+class PluginLog {
+public:
+	static constexpr uint64_t REPEAT_WINDOW_NS = 60ull * 1000 * 1000 * 1000;
+	static constexpr double TOKENS_PER_SECOND = 0.5;
+	static constexpr double TOKEN_BURST = 20.0;
+	static constexpr size_t REPEAT_SLOTS = 8;
+
+	static PluginLog &get();
+
+	bool Enabled(LogCategory category, LogLevel level) const
+	{
+		return static_cast<int>(level) >= levels[static_cast<size_t>(category)].load(std::memory_order_relaxed);
+	}
+	void Write(LogCategory category, LogLevel level, const char *format, ...);
+
+	void SetLevel(LogCategory category, LogLevel level);
+	// Liga/desliga o log de cada requisição (API e HTTP em Debug) sem mexer nas outras categorias.
+	void SetRequestDebug(bool enabled);
+	// Escreve os resumos de repetição pendentes (no fim da janela e ao descarregar o plugin).
+	void Flush();
+
+	QString Report() const;
+
+	PluginLog(PluginLog const &) = delete;
+	void operator=(PluginLog const &) = delete;
+
+private:
+	PluginLog();
+
+	struct Repeat {
+		uint64_t hash = 0;
+		uint64_t lastEmitNs = 0;
+		uint32_t suppressed = 0;
+		int obsLevel = 0;
+		std::string text;
+	};
+	struct CategoryState {
+		double tokens = TOKEN_BURST;
+		uint64_t lastRefillNs = 0;
+		uint32_t dropped = 0;
+		std::array<Repeat, REPEAT_SLOTS> repeats;
+	};
+	using Lines = std::vector<std::pair<int, std::string>>;
+
+	void Emit(LogCategory category, LogLevel level, const char *message);
+	// Resumos das repetições cuja janela passou, de todas as categorias. Com o mutex travado.
+	void CollectExpired(uint64_t nowNs, bool all, Lines &out);
+	bool TakeToken(CategoryState &state, uint64_t nowNs);
+
+	static const char *Tag(LogCategory category);
+	static std::string Line(LogCategory category, const std::string &text);
+
+	std::array<std::atomic<int>, static_cast<size_t>(LogCategory::Count)> levels;
+	LogLevel configuredLevels[static_cast<size_t>(LogCategory::Count)];
+
+	mutable std::mutex mutex;
+	std::array<CategoryState, static_cast<size_t>(LogCategory::Count)> states;
+
+	std::atomic<uint64_t> written{0};
+	std::atomic<uint64_t> collapsed{0};
+	std::atomic<uint64_t> dropped{0};
+};
+
+// Os argumentos só são avaliados se a categoria aceitar o nível.
+#define PLUGIN_LOG(category, level, ...)                                       \
+	do {                                                                   \
+		if (PluginLog::get().Enabled(category, level))                 \
+			PluginLog::get().Write(category, level, __VA_ARGS__); \
+	} while (0)
+
+#endif // PLUGIN_LOG_H
@@ -25,10 +25,19 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 #include "plugin-support.h"
 #include "nightbot-auth.h"
 #include "nightbot-api.h"
+#include "nightbot-session.h"
 #include "nightbot-dock.h"
 #include "nightbot-settings.h"
 #include "SettingsManager.h"
-#include <curl/curl.h>
+#include "polling-gate.h"
+#include "trace-recorder.h"
+#include "metrics-server.h"
+#include "ui-stall-detector.h"
+#include "request-history.h"
+#include "play-history.h"
+#include "thumbnail-cache.h"
+#include "plugin-log.h"
+#include <util/platform.h>
 
 static obs_hotkey_id g_nightbot_resume_hotkey_id;
 static obs_hotkey_id g_nightbot_pause_hotkey_id;
@@ -39,10 +48,15 @@ static obs_hotkey_id g_nightbot_skip_hotkey_id;
 #define HOTKEY_SKIP_ID "nightbot_sr.skip"
 
 extern void FreeSettingsManager();
+extern void EnsureNightbotNetwork();
 extern void ShutdownNightbotAPI();
+extern void ShutdownQueueCache();
 
 NightbotDock *g_dock_widget = nullptr;
 
+static uint64_t g_load_start_ns = 0;
+static QMetaObject::Connection g_first_data_connection;
+
 OBS_DECLARE_MODULE()
 OBS_MODULE_USE_DEFAULT_LOCALE(PLUGIN_NAME, "en-US")
 MODULE_EXPORT const char *obs_module_description(void)
@@ -69,6 +83,7 @@ static void save_hotkeys(obs_data_t *save_data, bool saving, void *private_data)
 	obs_data_array_release(skip_hotkey);
 
 	SettingsManager::get().Save();
+	SettingsManager::get().Flush();
 }
 
 static void hotkey_pause_song(void *data, obs_hotkey_id id, obs_hotkey_t *hotkey, bool pressed)
@@ -77,6 +92,7 @@ static void hotkey_pause_song(void *data, obs_hotkey_id id, obs_hotkey_t *hotkey
 	Q_UNUSED(id);
 	Q_UNUSED(hotkey);
 	if (pressed) {
+		TRACE_SCOPE("Pause hotkey", "hotkey");
 		obs_log_info("Pause hotkey pressed");
 		NightbotAPI::get().ControlPause();
 		if (g_dock_widget)
@@ -90,6 +106,7 @@ static void hotkey_resume_song(void *data, obs_hotkey_id id, obs_hotkey_t *hotke
 	Q_UNUSED(id);
 	Q_UNUSED(hotkey);
 	if (pressed) {
+		TRACE_SCOPE("Resume hotkey", "hotkey");
 		obs_log_info("Resume hotkey pressed");
 		NightbotAPI::get().ControlPlay();
 		if (g_dock_widget)
@@ -103,7 +120,9 @@ static void hotkey_skip_song(void *data, obs_hotkey_id id, obs_hotkey_t *hotkey,
 	Q_UNUSED(id);
 	Q_UNUSED(hotkey);
 	if (pressed) {
+		TRACE_SCOPE("Skip hotkey", "hotkey");
 		obs_log_info("Skip hotkey pressed");
+		PlayHistory::get().MarkSkipRequested(SessionManager::get().Active()->Id());
 		NightbotAPI::get().ControlSkip();
 	}
 }
@@ -115,6 +134,59 @@ static void show_settings_dialog(void *private_data)
 	dialog.exec();
 }
 
+static void start_plugin()
+{
+	static bool started = false;
+	if (started)
+		return;
+	started = true;
+
+	uint64_t start_ns = os_gettime_ns();
+	EnsureNightbotNetwork();
+
+	if (NightbotAuth::get().IsAuthenticated()) {
+		g_first_data_connection = QObject::connect(
+			&NightbotAPI::get(), &NightbotAPI::songQueueFetched, g_dock_widget, [](const QList<SongItem> &) {
+				QObject::disconnect(g_first_data_connection);
+				obs_log_info("[Nightbot SR] Time to first data: %.1f ms after module load.",
+					     static_cast<double>(os_gettime_ns() - g_load_start_ns) / 1000000.0);
+			});
+
+		// Fila, configurações do SR e usuário são buscados em paralelo no pool da API.
+		NightbotAPI::get().FetchUserInfo();
+	}
+
+	if (g_dock_widget)
+		g_dock_widget->Start();
+
+	ApplyMetricsPort(SettingsManager::get().GetSnapshot()->metricsPort);
+	UiStallDetector::get().SetThresholdMs(SettingsManager::get().GetSnapshot()->uiStallThresholdMs);
+	PluginLog::get().SetRequestDebug(SettingsManager::get().GetSnapshot()->networkDebugLog);
+	QObject::connect(&SettingsManager::get(), &SettingsManager::snapshotChanged, g_dock_widget, []() {
+		auto snapshot = SettingsManager::get().GetSnapshot();
+		ApplyMetricsPort(snapshot->metricsPort);
+		UiStallDetector::get().SetThresholdMs(snapshot->uiStallThresholdMs);
+		PluginLog::get().SetRequestDebug(snapshot->networkDebugLog);
+	});
+	UiStallDetector::get().StartWatchdog();
+
+	obs_log_info("[Nightbot SR] Deferred startup took %.1f ms.",
+		     static_cast<double>(os_gettime_ns() - start_ns) / 1000000.0);
+}
+
+static void on_frontend_event(enum obs_frontend_event event, void *private_data)
+{
+	Q_UNUSED(private_data);
+
+	if (event == OBS_FRONTEND_EVENT_FINISHED_LOADING) {
+		PollingGate::get().SyncOutputState();
+		start_plugin();
+		return;
+	}
+
+	PollingGate::get().HandleFrontendEvent(event);
+}
+
 const char *obs_module_get_name(void)
 {
 	return get_obs_text("Nightbot.PluginName");
@@ -122,9 +194,15 @@ const char *obs_module_get_name(void)
 
 bool obs_module_load(void)
 {
-	curl_global_init(CURL_GLOBAL_ALL);
+	g_load_start_ns = os_gettime_ns();
+
+	// NIGHTBOT_SR_TRACE=<arquivo>: grava o trace desde o carregamento e salva ao descarregar o plugin.
+	if (!qEnvironmentVariableIsEmpty("NIGHTBOT_SR_TRACE"))
+		TraceRecorder::get().Start();
 
 	SettingsManager::get().Load();
+	SessionManager::get().Load();
+	PlayHistory::get().Load();
 
 	g_dock_widget = new NightbotDock();
     obs_frontend_add_dock_by_id("nightbot_sr", get_obs_text("Nightbot.DockTitle"), g_dock_widget);
@@ -132,11 +210,8 @@ bool obs_module_load(void)
 	obs_frontend_add_tools_menu_item(
 		get_obs_text("Nightbot.Settings"), show_settings_dialog, nullptr);
 
-	if (NightbotAuth::get().IsAuthenticated()) {
-		NightbotAPI::get().FetchSongQueue(get_obs_text(
-			"Nightbot.Queue.PlaylistUser"));
-		NightbotAPI::get().FetchSRSettings();
-	}
+	// Rede, autenticação e primeiras buscas ficam para depois do carregamento do OBS.
+	obs_frontend_add_event_callback(on_frontend_event, nullptr);
 
 	g_nightbot_resume_hotkey_id = obs_hotkey_register_frontend(
 		HOTKEY_RESUME_ID, obs_module_text("Nightbot.Hotkey.Resume"), hotkey_resume_song, nullptr);
@@ -164,22 +239,37 @@ bool obs_module_load(void)
 	obs_hotkey_load(g_nightbot_skip_hotkey_id, nightbot_skip_hotkey);
 	obs_data_array_release(nightbot_skip_hotkey);
 
-	obs_log_info("[Nightbot SR] Plugin loaded successfully (version %s)", PLUGIN_VERSION);
+	obs_log_info("[Nightbot SR] Plugin loaded successfully (version %s) in %.1f ms", PLUGIN_VERSION,
+		     static_cast<double>(os_gettime_ns() - g_load_start_ns) / 1000000.0);
 	return true;
 }
 
 void obs_module_unload(void)
 {
+	obs_frontend_remove_event_callback(on_frontend_event, nullptr);
+
 	obs_hotkey_unregister(g_nightbot_resume_hotkey_id);
 	obs_hotkey_unregister(g_nightbot_pause_hotkey_id);
 	obs_hotkey_unregister(g_nightbot_skip_hotkey_id);
 
+	UiStallDetector::get().StopWatchdog();
+	ShutdownMetricsServer();
+	// Antes da API: as buscas de miniatura usam o mesmo transporte HTTP.
+	ShutdownThumbnailCache();
 	ShutdownNightbotAPI();
+	ShutdownQueueCache();
+	ShutdownRequestHistory();
+	ShutdownPlayHistory();
 	FreeSettingsManager();
+	// Resumos de repetição que ainda não saíram.
+	PluginLog::get().Flush();
 
-	g_dock_widget = nullptr;
+	if (TraceRecorder::Enabled() && !qEnvironmentVariableIsEmpty("NIGHTBOT_SR_TRACE")) {
+		TraceRecorder::get().Stop();
+		TraceRecorder::get().Save(qEnvironmentVariable("NIGHTBOT_SR_TRACE"));
+	}
 
-	curl_global_cleanup();
+	g_dock_widget = nullptr;
 
 	obs_log_info("[Nightbot SR] Plugin unloaded");
 }
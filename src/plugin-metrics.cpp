@@ -0,0 +1,203 @@
+#include "plugin-metrics.h"
+#include "trace-recorder.h"
+#include "ui-stall-detector.h"
+#include "api-scheduler.h"
+
+#include <QDateTime>
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+PluginMetrics &PluginMetrics::get()
+{
+	static PluginMetrics instance;
+	return instance;
+}
+
+static const double QUANTILES[] = {0.5, 0.95, 0.99};
+
+static QByteArray Seconds(uint64_t us)
+{
+	return QByteArray::number(static_cast<double>(us) / 1000000.0, 'g', 6);
+}
+
+static void Header(QByteArray &out, const char *name, const char *type, const char *help)
+{
+	out += QByteArray("# HELP ") + name + " " + help + "\n";
+	out += QByteArray("# TYPE ") + name + " " + type + "\n";
+}
+
+static void Sample(QByteArray &out, const char *name, const QByteArray &labels, const QByteArray &value)
+{
+	out += name;
+	if (!labels.isEmpty())
+		out += "{" + labels + "}";
+	out += " " + value + "\n";
+}
+
+static void Summary(QByteArray &out, const char *name, const QByteArray &labels, const LatencyHistogram &histogram,
+		    uint64_t sumUs)
+{
+	const QByteArray prefix = labels.isEmpty() ? QByteArray() : labels + ",";
+	for (double quantile : QUANTILES)
+		Sample(out, name, prefix + "quantile=\"" + QByteArray::number(quantile) + "\"",
+		       Seconds(histogram.Percentile(quantile * 100.0)));
+
+	const QByteArray base(name);
+	Sample(out, (base + "_sum").constData(), labels, Seconds(sumUs));
+	Sample(out, (base + "_count").constData(), labels, QByteArray::number(histogram.Count()));
+}
+
+static QByteArray LaneLabel(ApiScheduler::Lane lane)
+{
+	return QByteArray("lane=\"") + ApiScheduler::LaneName(lane) + "\"";
+}
+
+QByteArray RenderPrometheusMetrics()
+{
+	QByteArray out;
+	out.reserve(8192);
+
+	struct EndpointRow {
+		QByteArray label;
+		uint64_t requests, errors, reused, sent, received, sumUs;
+		const LatencyHistogram *total;
+		std::map<long, uint64_t> statuses;
+	};
+	std::vector<EndpointRow> rows;
+
+	// Copia os números sob o lock e formata depois; os histogramas nunca são liberados.
+	TransportStats::get().ForEachEndpoint([&rows](const std::string &endpoint, const EndpointStats &stats) {
+		rows.push_back({"endpoint=\"" + QByteArray::fromStdString(endpoint) + "\"",
+				stats.requests.load(std::memory_order_relaxed), stats.errors.load(std::memory_order_relaxed),
+				stats.reused.load(std::memory_order_relaxed), stats.bytesSent.load(std::memory_order_relaxed),
+				stats.bytesReceived.load(std::memory_order_relaxed),
+				stats.totalUsSum.load(std::memory_order_relaxed), &stats.total, stats.statuses});
+	});
+
+	Header(out, "nightbot_http_requests_total", "counter", "HTTP requests sent to the Nightbot API and backend.");
+	for (const auto &row : rows)
+		Sample(out, "nightbot_http_requests_total", row.label, QByteArray::number(row.requests));
+
+	Header(out, "nightbot_http_responses_total", "counter", "HTTP responses by status (-1 = transport error).");
+	for (const auto &row : rows) {
+		for (const auto &[status, count] : row.statuses)
+			Sample(out, "nightbot_http_responses_total",
+			       row.label + ",status=\"" + QByteArray::number(static_cast<qlonglong>(status)) + "\"",
+			       QByteArray::number(count));
+	}
+
+	Header(out, "nightbot_http_errors_total", "counter", "Requests that failed or returned HTTP 4xx/5xx.");
+	for (const auto &row : rows)
+		Sample(out, "nightbot_http_errors_total", row.label, QByteArray::number(row.errors));
+
+	Header(out, "nightbot_http_reused_connections_total", "counter", "Requests served on a reused connection.");
+	for (const auto &row : rows)
+		Sample(out, "nightbot_http_reused_connections_total", row.label, QByteArray::number(row.reused));
+
+	Header(out, "nightbot_http_sent_bytes_total", "counter", "Request body bytes sent.");
+	for (const auto &row : rows)
+		Sample(out, "nightbot_http_sent_bytes_total", row.label, QByteArray::number(row.sent));
+
+	Header(out, "nightbot_http_received_bytes_total", "counter", "Response body bytes received.");
+	for (const auto &row : rows)
+		Sample(out, "nightbot_http_received_bytes_total", row.label, QByteArray::number(row.received));
+
+	Header(out, "nightbot_http_request_duration_seconds", "summary", "Total request time as reported by curl.");
+	for (const auto &row : rows)
+		Summary(out, "nightbot_http_request_duration_seconds", row.label, *row.total, row.sumUs);
+
+	PluginMetrics &metrics = PluginMetrics::get();
+
+	Header(out, "nightbot_http_retries_total", "counter", "Requests retried after a token refresh.");
+	Sample(out, "nightbot_http_retries_total", {},
+	       QByteArray::number(metrics.requestRetries.load(std::memory_order_relaxed)));
+
+	Header(out, "nightbot_token_refreshes_total", "counter", "Access token refresh attempts.");
+	Sample(out, "nightbot_token_refreshes_total", "result=\"success\"",
+	       QByteArray::number(metrics.tokenRefreshes.load(std::memory_order_relaxed)));
+	Sample(out, "nightbot_token_refreshes_total", "result=\"failure\"",
+	       QByteArray::number(metrics.tokenRefreshFailures.load(std::memory_order_relaxed)));
+
+	const ApiScheduler::Lane lanes[] = {ApiScheduler::Lane::Interactive, ApiScheduler::Lane::Background};
+	ApiScheduler &scheduler = ApiScheduler::get();
+
+	Header(out, "nightbot_api_tasks_total", "counter", "API tasks submitted per scheduler lane.");
+	for (ApiScheduler::Lane lane : lanes)
+		Sample(out, "nightbot_api_tasks_total", LaneLabel(lane),
+		       QByteArray::number(scheduler.Stats(lane).submitted.load(std::memory_order_relaxed)));
+
+	Header(out, "nightbot_api_tasks_coalesced_total", "counter", "Tasks merged into one already waiting.");
+	for (ApiScheduler::Lane lane : lanes)
+		Sample(out, "nightbot_api_tasks_coalesced_total", LaneLabel(lane),
+		       QByteArray::number(scheduler.Stats(lane).coalesced.load(std::memory_order_relaxed)));
+
+	Header(out, "nightbot_api_queue_depth", "gauge", "API tasks waiting for a worker.");
+	for (ApiScheduler::Lane lane : lanes)
+		Sample(out, "nightbot_api_queue_depth", LaneLabel(lane),
+		       QByteArray::number(static_cast<qlonglong>(scheduler.Stats(lane).queued.load(std::memory_order_relaxed))));
+
+	Header(out, "nightbot_api_queue_wait_seconds", "summary", "Time API tasks waited for a worker.");
+	for (ApiScheduler::Lane lane : lanes) {
+		const ApiScheduler::LaneStats &stats = scheduler.Stats(lane);
+		Summary(out, "nightbot_api_queue_wait_seconds", LaneLabel(lane), stats.waitUs,
+			stats.waitUsSum.load(std::memory_order_relaxed));
+	}
+
+	Header(out, "nightbot_queue_length", "gauge", "Songs in the queue, including the current one.");
+	Sample(out, "nightbot_queue_length", {},
+	       QByteArray::number(static_cast<qlonglong>(metrics.queueLength.load(std::memory_order_relaxed))));
+
+	const int64_t lastUpdate = metrics.lastQueueUpdateMs.load(std::memory_order_relaxed);
+	if (lastUpdate > 0) {
+		Header(out, "nightbot_queue_snapshot_age_seconds", "gauge", "Time since the queue was last fetched.");
+		Sample(out, "nightbot_queue_snapshot_age_seconds", {},
+		       QByteArray::number(static_cast<double>(QDateTime::currentMSecsSinceEpoch() - lastUpdate) / 1000.0,
+					  'f', 3));
+	}
+
+	Header(out, "nightbot_poll_interval_seconds", "gauge", "Effective queue polling interval (0 = paused).");
+	Sample(out, "nightbot_poll_interval_seconds", {},
+	       QByteArray::number(static_cast<double>(metrics.pollIntervalMs.load(std::memory_order_relaxed)) / 1000.0,
+				  'f', 3));
+
+	Header(out, "nightbot_push_connected", "gauge", "1 while the push update channel is connected.");
+	Sample(out, "nightbot_push_connected", {},
+	       QByteArray::number(static_cast<qlonglong>(metrics.pushConnected.load(std::memory_order_relaxed))));
+
+	Header(out, "nightbot_push_events_total", "counter", "Queue change events received on the push channel.");
+	Sample(out, "nightbot_push_events_total", {},
+	       QByteArray::number(metrics.pushEvents.load(std::memory_order_relaxed)));
+
+	Header(out, "nightbot_push_reconnects_total", "counter", "Push channel reconnect attempts.");
+	Sample(out, "nightbot_push_reconnects_total", {},
+	       QByteArray::number(metrics.pushReconnects.load(std::memory_order_relaxed)));
+
+	Header(out, "nightbot_ui_update_duration_seconds", "summary", "Time spent updating the dock for a new queue.");
+	Summary(out, "nightbot_ui_update_duration_seconds", {}, metrics.uiUpdateUs,
+		metrics.uiUpdateUsSum.load(std::memory_order_relaxed));
+
+	UiStallDetector &stalls = UiStallDetector::get();
+
+	Header(out, "nightbot_ui_slot_duration_seconds", "summary", "Plugin work per invocation on the OBS UI thread.");
+	Summary(out, "nightbot_ui_slot_duration_seconds", {}, stalls.slotUs,
+		stalls.busyNsTotal.load(std::memory_order_relaxed) / 1000);
+
+	Header(out, "nightbot_ui_stalls_total", "counter", "UI thread invocations longer than the stall threshold.");
+	Sample(out, "nightbot_ui_stalls_total", {}, QByteArray::number(stalls.stalls.load(std::memory_order_relaxed)));
+
+	const uint64_t lagByPlugin = stalls.lagEventsByPlugin.load(std::memory_order_relaxed);
+	const uint64_t lagTotal = std::max(stalls.lagEvents.load(std::memory_order_relaxed), lagByPlugin);
+	Header(out, "nightbot_ui_lag_events_total", "counter", "Times the OBS UI event loop lagged by 50 ms or more.");
+	Sample(out, "nightbot_ui_lag_events_total", "cause=\"plugin\"", QByteArray::number(lagByPlugin));
+	Sample(out, "nightbot_ui_lag_events_total", "cause=\"other\"", QByteArray::number(lagTotal - lagByPlugin));
+
+	Header(out, "nightbot_cache_memory_bytes", "gauge", "Approximate memory held by plugin caches.");
+	Sample(out, "nightbot_cache_memory_bytes", "cache=\"queue\"",
+	       QByteArray::number(metrics.queueMemoryBytes.load(std::memory_order_relaxed)));
+	Sample(out, "nightbot_cache_memory_bytes", "cache=\"trace\"",
+	       QByteArray::number(static_cast<qulonglong>(TraceRecorder::get().MemoryBytes())));
+
+	return out;
+}
@@ -0,0 +1,46 @@
+#ifndef PLUGIN_METRICS_H
+#define PLUGIN_METRICS_H
+
+#include "transport-stats.h"
+
+#include <QByteArray>
+
+#include <atomic>
+#include <cstdint>
+
+// Contadores e medidores do plugin fora do transporte HTTP. Escritos de qualquer
+// thread com operações atômicas; lidos pelo /metrics e pela aba de diagnóstico.
+struct PluginMetrics {
+	static PluginMetrics &get();
+
+	std::atomic<uint64_t> requestRetries{0};
+	std::atomic<uint64_t> tokenRefreshes{0};
+	std::atomic<uint64_t> tokenRefreshFailures{0};
+
+	std::atomic<int64_t> queueLength{0};
+	// Época em ms da última fila recebida da API; 0 = nenhuma ainda.
+	std::atomic<int64_t> lastQueueUpdateMs{0};
+	// Intervalo efetivo das consultas; 0 = pausado.
+	std::atomic<int64_t> pollIntervalMs{0};
+	// Estimativa da memória ocupada pela fila exibida no dock.
+	std::atomic<uint64_t> queueMemoryBytes{0};
+
+	// Canal de push: 1 enquanto conectado.
+	std::atomic<int64_t> pushConnected{0};
+	std::atomic<uint64_t> pushEvents{0};
+	std::atomic<uint64_t> pushReconnects{0};
+
+	LatencyHistogram uiUpdateUs;
+	std::atomic<uint64_t> uiUpdateUsSum{0};
+
+	void RecordUiUpdate(uint64_t durationUs)
+	{
+		uiUpdateUs.Record(durationUs);
+		uiUpdateUsSum.fetch_add(durationUs, std::memory_order_relaxed);
+	}
+};
+
+// Texto no formato de exposição do Prometheus (0.0.4) com todas as métricas do plugin.
+QByteArray RenderPrometheusMetrics();
+
+#endif // PLUGIN_METRICS_H
@@ -0,0 +1,91 @@
+#include "polling-gate.h"
+#include "SettingsManager.h"
+
+#include <algorithm>
+
+PollingGate &PollingGate::get()
+{
+	static PollingGate instance;
+	return instance;
+}
+
+void PollingGate::HandleFrontendEvent(enum obs_frontend_event event)
+{
+	bool changed = true;
+
+	switch (event) {
+	case OBS_FRONTEND_EVENT_STREAMING_STARTED:
+		streaming = true;
+		break;
+	case OBS_FRONTEND_EVENT_STREAMING_STOPPED:
+		streaming = false;
+		break;
+	case OBS_FRONTEND_EVENT_RECORDING_STARTED:
+		recording = true;
+		break;
+	case OBS_FRONTEND_EVENT_RECORDING_STOPPED:
+		recording = false;
+		break;
+	case OBS_FRONTEND_EVENT_VIRTUALCAM_STARTED:
+		virtualcam = true;
+		break;
+	case OBS_FRONTEND_EVENT_VIRTUALCAM_STOPPED:
+		virtualcam = false;
+		break;
+	default:
+		changed = false;
+		break;
+	}
+
+	if (changed)
+		emit stateChanged();
+}
+
+void PollingGate::SyncOutputState()
+{
+	streaming = obs_frontend_streaming_active();
+	recording = obs_frontend_recording_active();
+	virtualcam = obs_frontend_virtualcam_active();
+	emit stateChanged();
+}
+
+void PollingGate::SetDockVisible(bool visible)
+{
+	if (dockVisible == visible)
+		return;
+
+	dockVisible = visible;
+	emit stateChanged();
+}
+
+bool PollingGate::IsLive() const
+{
+	return streaming || recording || virtualcam;
+}
+
+bool PollingGate::HasNowPlayingOutputs(const SettingsSnapshot &settings) const
+{
+	return !settings.nowPlayingSource.empty() ||
+	       (settings.nowPlayingToFileEnabled && !settings.nowPlayingToFilePath.isEmpty());
+}
+
+int PollingGate::EffectiveIntervalMs(int baseIntervalMs, const SettingsSnapshot &settings) const
+{
+	// Ninguém está vendo a fila e nada depende dela: não há por que consultar a API.
+	if (!dockVisible && settings.pollPauseWhenHidden && !HasNowPlayingOutputs(settings))
+		return 0;
+
+	if (IsLive())
+		return baseIntervalMs;
+
+	return baseIntervalMs * std::max(1, settings.pollIdleMultiplier);
+}
+
+const char *PollingGate::Describe(const SettingsSnapshot &settings) const
+{
+	if (!dockVisible && settings.pollPauseWhenHidden && !HasNowPlayingOutputs(settings))
+		return "paused: dock hidden and no now-playing outputs";
+	if (IsLive())
+		return "live";
+	return "idle";
+}
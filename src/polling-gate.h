@@ -0,0 +1,44 @@
+#ifndef POLLING_GATE_H
+#define POLLING_GATE_H
+
+#include <QObject>
+#include <obs-frontend-api.h>
+
+struct SettingsSnapshot;
+
+// Decide a frequência de atualização da fila a partir do estado do OBS
+// (transmitindo, gravando, câmera virtual) e da visibilidade do dock.
+class PollingGate : public QObject {
+	Q_OBJECT
+
+public:
+	static PollingGate &get();
+
+	void HandleFrontendEvent(enum obs_frontend_event event);
+	void SyncOutputState();
+	void SetDockVisible(bool visible);
+
+	bool IsLive() const;
+	bool IsDockVisible() const { return dockVisible; }
+
+	// Intervalo efetivo em ms para o intervalo base configurado; 0 = pausado.
+	int EffectiveIntervalMs(int baseIntervalMs, const SettingsSnapshot &settings) const;
+	const char *Describe(const SettingsSnapshot &settings) const;
+
+signals:
+	void stateChanged();
+
+private:
+	PollingGate() = default;
+
+	bool HasNowPlayingOutputs(const SettingsSnapshot &settings) const;
+
+	bool streaming = false;
+	bool recording = false;
+	bool virtualcam = false;
+	// Um dock que o OBS restaura fechado nunca recebe show/hide: começa fechado, e o próprio dock
+	// confirma o estado real em NightbotDock::Start.
+	bool dockVisible = false;
+};
+
+#endif // POLLING_GATE_H
@@ -0,0 +1,215 @@
+#include "queue-cache.h"
+#include "plugin-support.h"
+
+#include <obs-module.h>
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QThreadPool>
+
+static const char *QUEUE_CACHE_FILE_NAME = "queue-cache.bin";
+
+// 'NBQC'
+static const quint32 QUEUE_CACHE_MAGIC = 0x4E425143;
+static const quint16 QUEUE_CACHE_VERSION = 2;
+
+static QThreadPool *g_cacheWriteThread = nullptr;
+
+void ShutdownQueueCache()
+{
+	if (g_cacheWriteThread) {
+		g_cacheWriteThread->waitForDone();
+		delete g_cacheWriteThread;
+		g_cacheWriteThread = nullptr;
+	}
+}
+
+static QThreadPool *WriteThread()
+{
+	if (!g_cacheWriteThread) {
+		g_cacheWriteThread = new QThreadPool();
+		g_cacheWriteThread->setMaxThreadCount(1);
+	}
+	return g_cacheWriteThread;
+}
+
+static QString GetCachePath()
+{
+	char *path = obs_module_config_path(QUEUE_CACHE_FILE_NAME);
+	QString result = path ? QString::fromUtf8(path) : QString();
+	bfree(path);
+	return result;
+}
+
+static bool SameQueue(const QList<SongItem> &a, const QList<SongItem> &b)
+{
+	if (a.size() != b.size())
+		return false;
+
+	for (qsizetype i = 0; i < a.size(); ++i) {
+		if (a.at(i).id != b.at(i).id || a.at(i).position != b.at(i).position)
+			return false;
+	}
+	return true;
+}
+
+QueueCache &QueueCache::get()
+{
+	static QueueCache instance;
+	return instance;
+}
+
+bool QueueCache::Load(const std::string &account, QueueCacheData &out)
+{
+	QString path = GetCachePath();
+	QFile file(path);
+	if (path.isEmpty() || !file.open(QIODevice::ReadOnly))
+		return false;
+
+	QDataStream in(&file);
+	in.setVersion(QDataStream::Qt_6_0);
+
+	quint32 magic = 0;
+	quint16 version = 0;
+	in >> magic >> version;
+	if (magic != QUEUE_CACHE_MAGIC || version != QUEUE_CACHE_VERSION) {
+		obs_log_info("[Nightbot SR/Cache] Ignoring queue cache with unknown format (version %u).", version);
+		return false;
+	}
+
+	QueueCacheData cached;
+	QByteArray cachedAccount;
+	qint32 volume = -1;
+	quint32 count = 0;
+	in >> cachedAccount >> cached.savedAtMs >> cached.srEnabled >> volume >> count;
+	cached.account = cachedAccount.toStdString();
+	cached.volume = volume;
+
+	for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+		SongItem item;
+		qint32 position = 0;
+		qint32 duration = 0;
+		in >> item.id >> item.title >> item.artist >> item.user >> position >> duration;
+		item.position = position;
+		item.duration = duration;
+		cached.queue.append(item);
+	}
+
+	if (in.status() != QDataStream::Ok) {
+		obs_log_warning("[Nightbot SR/Cache] Queue cache is truncated or corrupt. Ignoring it.");
+		return false;
+	}
+
+	// Mesmo de outra conta, os dados ficam: assim Forget sabe de quem é o arquivo.
+	data = cached;
+	loaded = true;
+	if (cached.account != account) {
+		obs_log_info("[Nightbot SR/Cache] Queue cache belongs to account %s, not %s. Ignoring it.",
+			     cached.account.c_str(), account.c_str());
+		return false;
+	}
+
+	out = cached;
+	return true;
+}
+
+void QueueCache::SwitchTo(const std::string &account)
+{
+	if (loaded && data.account == account)
+		return;
+
+	data = QueueCacheData();
+	data.account = account;
+	loaded = false;
+}
+
+void QueueCache::StoreQueue(const std::string &account, const QList<SongItem> &queue)
+{
+	SwitchTo(account);
+	if (loaded && SameQueue(data.queue, queue))
+		return;
+
+	data.queue = queue;
+	ScheduleWrite();
+}
+
+void QueueCache::StoreSRStatus(const std::string &account, bool isEnabled)
+{
+	SwitchTo(account);
+	if (loaded && data.srEnabled == isEnabled)
+		return;
+
+	data.srEnabled = isEnabled;
+	ScheduleWrite();
+}
+
+void QueueCache::StoreVolume(const std::string &account, int volume)
+{
+	SwitchTo(account);
+	if (loaded && data.volume == volume)
+		return;
+
+	data.volume = volume;
+	ScheduleWrite();
+}
+
+void QueueCache::Forget(const std::string &account)
+{
+	if (account.empty() || data.account != account)
+		return;
+
+	obs_log_info("[Nightbot SR/Cache] Deleting the queue cache of account %s.", account.c_str());
+	data = QueueCacheData();
+	loaded = false;
+
+	// Na mesma thread das gravações: uma gravação já na fila não recria o arquivo depois.
+	WriteThread()->start([]() {
+		QString path = GetCachePath();
+		if (!path.isEmpty())
+			QFile::remove(path);
+	});
+}
+
+void QueueCache::ScheduleWrite()
+{
+	loaded = true;
+	data.savedAtMs = QDateTime::currentMSecsSinceEpoch();
+
+	// A lista é compartilhada implicitamente; a cópia aqui é barata.
+	QueueCacheData snapshot = data;
+	WriteThread()->start([snapshot]() {
+		QString path = GetCachePath();
+		if (path.isEmpty())
+			return;
+
+		QDir dir = QFileInfo(path).dir();
+		if (!dir.exists())
+			dir.mkpath(".");
+
+		QSaveFile file(path);
+		if (!file.open(QIODevice::WriteOnly)) {
+			obs_log_warning("[Nightbot SR/Cache] Failed to open queue cache for writing: %s",
+					file.errorString().toUtf8().constData());
+			return;
+		}
+
+		QDataStream out(&file);
+		out.setVersion(QDataStream::Qt_6_0);
+		out << QUEUE_CACHE_MAGIC << QUEUE_CACHE_VERSION;
+		out << QByteArray::fromStdString(snapshot.account) << snapshot.savedAtMs << snapshot.srEnabled
+		    << qint32(snapshot.volume) << quint32(snapshot.queue.size());
+		for (const SongItem &item : snapshot.queue) {
+			out << item.id << item.title << item.artist << item.user << qint32(item.position)
+			    << qint32(item.duration);
+		}
+
+		if (!file.commit()) {
+			obs_log_warning("[Nightbot SR/Cache] Failed to write queue cache: %s",
+					file.errorString().toUtf8().constData());
+		}
+	});
+}
@@ -0,0 +1,54 @@
+#ifndef QUEUE_CACHE_H
+#define QUEUE_CACHE_H
+
+#include <QList>
+#include <QtGlobal>
+
+#include <string>
+
+#include "nightbot-api.h"
+
+// Último estado conhecido da fila, salvo em disco para que o dock tenha algo
+// para mostrar logo que o OBS abre, antes da primeira resposta da API.
+// Um só arquivo, da conta que estava ativa; a fila de uma conta nunca aparece em outra.
+struct QueueCacheData {
+	// NightbotSession::Id() da conta dona dos dados.
+	std::string account;
+	QList<SongItem> queue;
+	bool srEnabled = false;
+	int volume = -1;
+	qint64 savedAtMs = 0;
+};
+
+class QueueCache {
+public:
+	static QueueCache &get();
+
+	// false se não houver cache, ou se ele for de outra conta.
+	bool Load(const std::string &account, QueueCacheData &out);
+
+	// Dados de outra conta substituem o cache inteiro.
+	void StoreQueue(const std::string &account, const QList<SongItem> &queue);
+	void StoreSRStatus(const std::string &account, bool isEnabled);
+	void StoreVolume(const std::string &account, int volume);
+
+	// Conta dona do cache; vazio se não houver.
+	const std::string &Account() const { return data.account; }
+	// Apaga o cache, se for dessa conta (logout, conta removida ou desconectada).
+	void Forget(const std::string &account);
+
+	QueueCache(QueueCache const &) = delete;
+	void operator=(QueueCache const &) = delete;
+
+private:
+	QueueCache() = default;
+
+	// Começa um cache vazio se os dados guardados forem de outra conta.
+	void SwitchTo(const std::string &account);
+	void ScheduleWrite();
+
+	QueueCacheData data;
+	bool loaded = false;
+};
+
+#endif // QUEUE_CACHE_H
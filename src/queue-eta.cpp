@@ -0,0 +1,102 @@
+#include "queue-eta.h"
+
+#include <algorithm>
+
+size_t QueueEta::Update(const QList<SongItem> &queue, int64_t nowMs)
+{
+	const bool nowHasCurrent = !queue.isEmpty() && queue.first().position == 0;
+	const QString previousHead = ids.empty() ? QString() : ids.front();
+
+	// A fila andou: o que ficou antes da nova primeira música sai do começo, sem mexer no resto.
+	if (!queue.isEmpty()) {
+		const QString &head = queue.first().id;
+		size_t drop = 0;
+		while (drop < ids.size() && ids[drop] != head)
+			++drop;
+		if (drop < ids.size()) {
+			const auto offset = static_cast<std::ptrdiff_t>(drop);
+			ids.erase(ids.begin(), ids.begin() + offset);
+			durations.erase(durations.begin(), durations.begin() + offset);
+			ends.erase(ends.begin(), ends.begin() + offset);
+		}
+	}
+
+	const size_t count = static_cast<size_t>(queue.size());
+	size_t same = 0;
+	while (same < ids.size() && same < count) {
+		const SongItem &item = queue.at(static_cast<qsizetype>(same));
+		if (ids[same] != item.id || durations[same] != std::max(0, item.duration))
+			break;
+		++same;
+	}
+
+	ids.resize(same);
+	durations.resize(same);
+	ends.resize(same);
+	for (size_t i = same; i < count; ++i) {
+		const SongItem &item = queue.at(static_cast<qsizetype>(i));
+		const int duration = std::max(0, item.duration);
+		ids.push_back(item.id);
+		durations.push_back(duration);
+		ends.push_back((ends.empty() ? 0 : ends.back()) + duration);
+	}
+
+	// Música nova tocando: o relógio dela começa agora.
+	if (nowHasCurrent && (!hasCurrent || ids.front() != previousHead)) {
+		currentStartMs = nowMs;
+		pausedTotalMs = 0;
+		pausedAtMs = nowMs;
+	}
+	hasCurrent = nowHasCurrent;
+	return same;
+}
+
+void QueueEta::SetPaused(bool pause, int64_t nowMs)
+{
+	if (pause == paused)
+		return;
+	if (pause)
+		pausedAtMs = nowMs;
+	else
+		pausedTotalMs += nowMs - pausedAtMs;
+	paused = pause;
+}
+
+int64_t QueueEta::CurrentRemainingSeconds(int64_t nowMs) const
+{
+	if (!hasCurrent || ids.empty())
+		return -1;
+	const int64_t elapsedMs = (paused ? pausedAtMs : nowMs) - currentStartMs - pausedTotalMs;
+	// Passou da duração (anúncio, atraso do player): fica em zero até a fila andar.
+	return std::max<int64_t>(0, durations.front() - elapsedMs / 1000);
+}
+
+int64_t QueueEta::HeadSeconds(int64_t nowMs) const
+{
+	return hasCurrent ? CurrentRemainingSeconds(nowMs) : durations.front();
+}
+
+int64_t QueueEta::SecondsUntil(size_t index, int64_t nowMs) const
+{
+	if (index == 0 || index >= ids.size())
+		return 0;
+	return HeadSeconds(nowMs) + ends[index - 1] - ends.front();
+}
+
+int64_t QueueEta::TotalRemainingSeconds(int64_t nowMs) const
+{
+	if (ids.empty())
+		return 0;
+	return HeadSeconds(nowMs) + ends.back() - ends.front();
+}
+
+QString QueueEta::FormatSeconds(int64_t seconds)
+{
+	seconds = std::max<int64_t>(0, seconds);
+	if (seconds < 3600)
+		return QStringLiteral("%1:%2").arg(seconds / 60).arg(seconds % 60, 2, 10, QLatin1Char('0'));
+	return QStringLiteral("%1:%2:%3")
+		.arg(seconds / 3600)
+		.arg((seconds / 60) % 60, 2, 10, QLatin1Char('0'))
+		.arg(seconds % 60, 2, 10, QLatin1Char('0'));
+}
@@ -0,0 +1,51 @@
+#ifndef QUEUE_ETA_H
+#define QUEUE_ETA_H
+
+#include <QList>
+#include <QString>
+
+#include <cstdint>
+#include <deque>
+
+#include "song-queue.h"
+
+// Quando cada música da fila deve começar, sem consultar a API.
+//
+// Guarda a soma acumulada das durações. Quando a fila anda, as músicas que saíram do começo
+// são só descartadas (as somas das outras continuam valendo, já que a conta usa diferenças);
+// quando algo entra, sai ou muda de lugar, só é refeito o trecho a partir da primeira
+// diferença. A posição da música atual é estimada pelo relógio local a partir de quando ela
+// apareceu como atual, descontando as pausas feitas pelo dock.
+class QueueEta {
+public:
+	// Retorna o primeiro índice recalculado (== tamanho da fila se nada mudou).
+	size_t Update(const QList<SongItem> &queue, int64_t nowMs);
+	void SetPaused(bool paused, int64_t nowMs);
+
+	size_t Size() const { return ids.size(); }
+	// Segundos até a música no índice "index" começar; 0 para a que está tocando.
+	int64_t SecondsUntil(size_t index, int64_t nowMs) const;
+	// Quanto falta da música atual (-1 se nada estiver tocando).
+	int64_t CurrentRemainingSeconds(int64_t nowMs) const;
+	// Até o fim da fila, incluindo o resto da música atual.
+	int64_t TotalRemainingSeconds(int64_t nowMs) const;
+
+	// "m:ss", ou "h:mm:ss" a partir de uma hora.
+	static QString FormatSeconds(int64_t seconds);
+
+private:
+	// Tempo até a segunda música da fila começar.
+	int64_t HeadSeconds(int64_t nowMs) const;
+
+	std::deque<QString> ids;
+	std::deque<int> durations;
+	// ends[i] = soma das durações até i, inclusive, a partir de uma base qualquer.
+	std::deque<int64_t> ends;
+	bool hasCurrent = false;
+	int64_t currentStartMs = 0;
+	int64_t pausedAtMs = 0;
+	int64_t pausedTotalMs = 0;
+	bool paused = false;
+};
+
+#endif // QUEUE_ETA_H
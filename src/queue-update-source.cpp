@@ -0,0 +1,301 @@
+#include "queue-update-source.h"
+#include "nightbot-auth.h"
+#include "plugin-metrics.h"
+#include "plugin-log.h"
+#include "SettingsManager.h"
+#include "plugin-support.h"
+
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QRandomGenerator>
+#include <QTimer>
+#include <QUrl>
+
+#include <algorithm>
+
+// Backoff de reconexão do push: 1 s, 2 s, 4 s... até 60 s, mais até 25% de jitter.
+static const int PUSH_BACKOFF_INITIAL_MS = 1000;
+static const int PUSH_BACKOFF_MAX_MS = 60000;
+// O servidor manda um comentário a cada ~15 s; três perdidos derrubam a conexão.
+static const int PUSH_IDLE_TIMEOUT_MS = 45000;
+// Uma linha SSE maior que isso indica um servidor quebrado, não um evento legítimo.
+static const qsizetype PUSH_MAX_LINE = 64 * 1024;
+
+static bool IsLoopback(const QUrl &url)
+{
+	const QString host = url.host().toLower();
+	return host == "localhost" || host == "127.0.0.1" || host == "::1";
+}
+
+// Sem TLS, só na própria máquina (o mock); qualquer outro endereço precisa de https.
+static bool PushUrlAllowed(const QUrl &url)
+{
+	return url.isValid() && (url.scheme() == "https" || (url.scheme() == "http" && IsLoopback(url)));
+}
+
+// O token do Nightbot só vai para a própria API (mesmo esquema, host e porta de api_base_url),
+// nunca para um relay de terceiros.
+static bool SendsNightbotToken(const QUrl &url)
+{
+	const QUrl api(QString::fromStdString(SettingsManager::get().GetSnapshot()->apiBaseUrl));
+	return PushUrlAllowed(url) && url.scheme() == api.scheme() &&
+	       url.host().compare(api.host(), Qt::CaseInsensitive) == 0 && url.port() == api.port();
+}
+
+PollingUpdateSource::PollingUpdateSource(QObject *parent) : QueueUpdateSource(parent), timer(new QTimer(this))
+{
+	connect(timer, &QTimer::timeout, this, &PollingUpdateSource::refreshRequested);
+}
+
+void PollingUpdateSource::SetIntervalMs(int newIntervalMs)
+{
+	if (newIntervalMs == intervalMs && (newIntervalMs == 0 || timer->isActive()))
+		return;
+
+	intervalMs = newIntervalMs;
+	if (intervalMs > 0)
+		timer->start(intervalMs);
+	else
+		timer->stop();
+}
+
+void PollingUpdateSource::Start()
+{
+	if (intervalMs > 0 && !timer->isActive())
+		timer->start(intervalMs);
+}
+
+void PollingUpdateSource::Stop()
+{
+	timer->stop();
+}
+
+bool PollingUpdateSource::IsActive() const
+{
+	return timer->isActive();
+}
+
+PushUpdateSource::PushUpdateSource(QObject *parent)
+	: QueueUpdateSource(parent),
+	  network(new QNetworkAccessManager(this)),
+	  reconnectTimer(new QTimer(this)),
+	  idleTimer(new QTimer(this))
+{
+	reconnectTimer->setSingleShot(true);
+	idleTimer->setSingleShot(true);
+	idleTimer->setInterval(PUSH_IDLE_TIMEOUT_MS);
+
+	connect(reconnectTimer, &QTimer::timeout, this, &PushUpdateSource::Connect);
+	connect(idleTimer, &QTimer::timeout, this, [this]() {
+		PLUGIN_LOG(LogCategory::Push, LogLevel::Warning, "No data for %d s; reconnecting.",
+			   PUSH_IDLE_TIMEOUT_MS / 1000);
+		if (reply)
+			reply->abort();
+	});
+}
+
+PushUpdateSource::~PushUpdateSource()
+{
+	// Quem escuta pode já estar sendo destruído junto com o dock.
+	blockSignals(true);
+	Stop();
+}
+
+void PushUpdateSource::SetUrl(const QString &newUrl)
+{
+	if (newUrl == url)
+		return;
+
+	const bool wasRunning = running;
+	url = newUrl;
+	if (!url.isEmpty() && !PushUrlAllowed(QUrl(url)))
+		PLUGIN_LOG(LogCategory::Push, LogLevel::Warning,
+			   "Ignoring push URL '%s': only https, or http on localhost, is accepted.",
+			   url.toUtf8().constData());
+	Stop();
+	if (wasRunning)
+		Start();
+}
+
+void PushUpdateSource::Start()
+{
+	if (running || url.isEmpty() || !PushUrlAllowed(QUrl(url)))
+		return;
+
+	running = true;
+	backoffMs = PUSH_BACKOFF_INITIAL_MS;
+	Connect();
+}
+
+void PushUpdateSource::Stop()
+{
+	if (!running)
+		return;
+
+	running = false;
+	reconnectTimer->stop();
+	if (reply)
+		reply->abort();
+}
+
+void PushUpdateSource::Reconnect()
+{
+	lastEventId.clear();
+	if (!running)
+		return;
+
+	Stop();
+	Start();
+}
+
+void PushUpdateSource::Connect()
+{
+	if (!running || reply)
+		return;
+
+	QNetworkRequest request{QUrl(url)};
+	request.setRawHeader("Accept", "text/event-stream");
+	request.setRawHeader("Cache-Control", "no-cache");
+	request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::AlwaysNetwork);
+	const std::string token = SendsNightbotToken(request.url()) ? NightbotAuth::get().GetAccessToken() : "";
+	if (!token.empty())
+		request.setRawHeader("Authorization", QByteArray("Bearer ") + token.c_str());
+	if (!lastEventId.isEmpty())
+		request.setRawHeader("Last-Event-ID", lastEventId);
+
+	buffer.clear();
+	eventName.clear();
+	eventData.clear();
+
+	reply = network->get(request);
+	connect(reply, &QNetworkReply::metaDataChanged, this, &PushUpdateSource::OnMetaDataChanged);
+	connect(reply, &QNetworkReply::readyRead, this, &PushUpdateSource::OnReadyRead);
+	connect(reply, &QNetworkReply::finished, this, &PushUpdateSource::OnFinished);
+	idleTimer->start();
+}
+
+void PushUpdateSource::OnMetaDataChanged()
+{
+	if (!reply || connected)
+		return;
+
+	const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+	const QByteArray contentType = reply->header(QNetworkRequest::ContentTypeHeader).toByteArray();
+	if (status != 200 || !contentType.startsWith("text/event-stream")) {
+		PLUGIN_LOG(LogCategory::Push, LogLevel::Warning, "%s answered HTTP %d (%s); not an event stream.",
+			   url.toUtf8().constData(), status, contentType.constData());
+		reply->abort();
+		return;
+	}
+
+	backoffMs = std::max(PUSH_BACKOFF_INITIAL_MS, retryMs);
+	SetConnected(true);
+	// O que mudou enquanto o canal estava fora só chega por uma busca completa.
+	emit refreshRequested();
+}
+
+void PushUpdateSource::OnReadyRead()
+{
+	if (!reply)
+		return;
+
+	idleTimer->start();
+	buffer += reply->readAll();
+
+	qsizetype newline;
+	while ((newline = buffer.indexOf('\n')) >= 0) {
+		QByteArray line = buffer.left(newline);
+		buffer.remove(0, newline + 1);
+		if (line.endsWith('\r'))
+			line.chop(1);
+		ProcessLine(line);
+	}
+
+	if (buffer.size() > PUSH_MAX_LINE) {
+		PLUGIN_LOG(LogCategory::Push, LogLevel::Warning, "Event line too long; dropping the connection.");
+		reply->abort();
+	}
+}
+
+void PushUpdateSource::ProcessLine(const QByteArray &line)
+{
+	if (line.isEmpty()) {
+		DispatchEvent();
+		return;
+	}
+	// Comentário: usado pelo servidor como heartbeat.
+	if (line.startsWith(':'))
+		return;
+
+	const qsizetype colon = line.indexOf(':');
+	const QByteArray field = colon < 0 ? line : line.left(colon);
+	QByteArray value = colon < 0 ? QByteArray() : line.mid(colon + 1);
+	if (value.startsWith(' '))
+		value.remove(0, 1);
+
+	if (field == "event")
+		eventName = value;
+	else if (field == "data")
+		eventData += value + '\n';
+	else if (field == "id")
+		lastEventId = value;
+	else if (field == "retry")
+		retryMs = std::clamp(value.toInt(), 0, PUSH_BACKOFF_MAX_MS);
+}
+
+void PushUpdateSource::DispatchEvent()
+{
+	const QByteArray name = eventName.isEmpty() ? QByteArray("message") : eventName;
+	const bool hasData = !eventData.isEmpty();
+	eventName.clear();
+	eventData.clear();
+
+	if (name == "ping" || (name == "message" && !hasData))
+		return;
+
+	PluginMetrics::get().pushEvents.fetch_add(1, std::memory_order_relaxed);
+	emit refreshRequested();
+}
+
+void PushUpdateSource::OnFinished()
+{
+	QNetworkReply *finished = reply;
+	reply = nullptr;
+	idleTimer->stop();
+	if (finished) {
+		if (running && finished->error() != QNetworkReply::NoError &&
+		    finished->error() != QNetworkReply::OperationCanceledError)
+			PLUGIN_LOG(LogCategory::Push, LogLevel::Info, "Connection closed: %s",
+				   finished->errorString().toUtf8().constData());
+		finished->deleteLater();
+	}
+
+	SetConnected(false);
+	if (running)
+		ScheduleReconnect();
+}
+
+void PushUpdateSource::ScheduleReconnect()
+{
+	const int jitter = QRandomGenerator::global()->bounded(backoffMs / 4 + 1);
+	reconnectTimer->start(backoffMs + jitter);
+	PLUGIN_LOG(LogCategory::Push, LogLevel::Info, "Reconnecting in %d ms.", backoffMs + jitter);
+	PluginMetrics::get().pushReconnects.fetch_add(1, std::memory_order_relaxed);
+	backoffMs = std::min(backoffMs * 2, PUSH_BACKOFF_MAX_MS);
+}
+
+void PushUpdateSource::SetConnected(bool value)
+{
+	if (connected == value)
+		return;
+
+	connected = value;
+	PluginMetrics::get().pushConnected.store(value ? 1 : 0, std::memory_order_relaxed);
+	if (value)
+		PLUGIN_LOG(LogCategory::Push, LogLevel::Info, "Connected to %s; polling drops to periodic resync.",
+			   url.toUtf8().constData());
+	else
+		PLUGIN_LOG(LogCategory::Push, LogLevel::Info, "Disconnected; falling back to polling.");
+	emit activeChanged(value);
+}
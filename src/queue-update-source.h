@@ -0,0 +1,99 @@
+#ifndef QUEUE_UPDATE_SOURCE_H
+#define QUEUE_UPDATE_SOURCE_H
+
+#include <QByteArray>
+#include <QObject>
+#include <QString>
+
+class QNetworkAccessManager;
+class QNetworkReply;
+class QTimer;
+
+// Origem dos avisos de que a fila pode ter mudado. Quem escuta refreshRequested busca a
+// fila pela API; as fontes não carregam dados, então a busca continua sendo o único caminho.
+class QueueUpdateSource : public QObject {
+	Q_OBJECT
+
+public:
+	using QObject::QObject;
+
+	virtual void Start() = 0;
+	virtual void Stop() = 0;
+	virtual bool IsActive() const = 0;
+	virtual const char *Name() const = 0;
+
+signals:
+	void refreshRequested();
+	void activeChanged(bool active);
+};
+
+// Consulta periódica. O intervalo é decidido por fora (PollingGate, estado do push).
+class PollingUpdateSource : public QueueUpdateSource {
+	Q_OBJECT
+
+public:
+	explicit PollingUpdateSource(QObject *parent = nullptr);
+
+	// Reinicia o timer só quando o intervalo muda, para não atrasar a próxima consulta. 0 = parado.
+	void SetIntervalMs(int intervalMs);
+	int IntervalMs() const { return intervalMs; }
+
+	void Start() override;
+	void Stop() override;
+	bool IsActive() const override;
+	const char *Name() const override { return "polling"; }
+
+private:
+	QTimer *timer;
+	int intervalMs = 0;
+};
+
+// Canal de push via Server-Sent Events (um relay do Nightbot ou o mock local).
+// Cada evento vira um pedido de atualização; ao (re)conectar pede uma ressincronização.
+// Sem dados por muito tempo a conexão é considerada morta e refeita com backoff exponencial.
+class PushUpdateSource : public QueueUpdateSource {
+	Q_OBJECT
+
+public:
+	explicit PushUpdateSource(QObject *parent = nullptr);
+	~PushUpdateSource() override;
+
+	// URL vazia desliga o canal. Trocar a URL com o canal ligado reconecta.
+	void SetUrl(const QString &url);
+	QString Url() const { return url; }
+	// As credenciais mudaram (troca de conta): reconecta sem retomar do último evento visto.
+	void Reconnect();
+
+	void Start() override;
+	void Stop() override;
+	bool IsActive() const override { return connected; }
+	const char *Name() const override { return "push"; }
+
+private:
+	void Connect();
+	void OnMetaDataChanged();
+	void OnReadyRead();
+	void OnFinished();
+	void ScheduleReconnect();
+	void ProcessLine(const QByteArray &line);
+	void DispatchEvent();
+	void SetConnected(bool value);
+
+	QNetworkAccessManager *network;
+	QNetworkReply *reply = nullptr;
+	QTimer *reconnectTimer;
+	QTimer *idleTimer;
+
+	QString url;
+	bool running = false;
+	bool connected = false;
+	int backoffMs = 0;
+	int retryMs = 0;
+
+	QByteArray buffer;
+	QByteArray eventName;
+	QByteArray eventData;
+	QByteArray lastEventId;
+};
+
+#endif // QUEUE_UPDATE_SOURCE_H
@@ -0,0 +1,412 @@
+#include "request-history.h"
+#include "trace-recorder.h"
+#include "plugin-support.h"
+
+#include <obs-module.h>
+
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QThreadPool>
+#include <QTimer>
+
+#include <algorithm>
+
+static const char *REQUEST_HISTORY_FILE_NAME = "request-history.bin";
+
+// 'NBRH'
+static const quint32 REQUEST_HISTORY_MAGIC = 0x4E425248;
+static const quint16 REQUEST_HISTORY_VERSION = 1;
+
+// Registros chegam em rajadas (cada consulta da fila): uma gravação a cada 30 s no máximo.
+static const int REQUEST_HISTORY_WRITE_DELAY_MS = 30000;
+// Consultas longas não precisam de todos os trigramas para achar a entrada certa.
+static const size_t MAX_QUERY_TRIGRAMS = 32;
+
+static QThreadPool *g_historyThread = nullptr;
+
+static QThreadPool *HistoryThread()
+{
+	if (!g_historyThread) {
+		g_historyThread = new QThreadPool();
+		g_historyThread->setMaxThreadCount(1);
+	}
+	return g_historyThread;
+}
+
+static QString GetHistoryPath()
+{
+	char *path = obs_module_config_path(REQUEST_HISTORY_FILE_NAME);
+	QString result = path ? QString::fromUtf8(path) : QString();
+	bfree(path);
+	return result;
+}
+
+static uint64_t Trigram(const QChar *c)
+{
+	return (uint64_t(c[0].unicode()) << 32) | (uint64_t(c[1].unicode()) << 16) | uint64_t(c[2].unicode());
+}
+
+void ShutdownRequestHistory()
+{
+	RequestHistory::get().Flush(true);
+	delete g_historyThread;
+	g_historyThread = nullptr;
+}
+
+QString HistoryIndex::Normalize(const QString &text)
+{
+	const QString decomposed = text.normalized(QString::NormalizationForm_D);
+	QString result;
+	result.reserve(decomposed.size() + 1);
+	result += ' ';
+	for (const QChar c : decomposed) {
+		if (c.category() == QChar::Mark_NonSpacing)
+			continue;
+		if (c.isLetterOrNumber())
+			result += c.toLower();
+		else if (!result.endsWith(' '))
+			result += ' ';
+	}
+	if (result.size() > 1 && result.endsWith(' '))
+		result.chop(1);
+	return result;
+}
+
+bool HistoryIndex::Add(const QString &text, const QString &label, uint32_t uses, int64_t lastUsedMs)
+{
+	const QString key = text.trimmed().toLower();
+	if (key.isEmpty())
+		return false;
+
+	auto found = byKey.constFind(key);
+	if (found != byKey.constEnd()) {
+		Entry &entry = entries[found.value()];
+		entry.uses += uses;
+		entry.lastUsedMs = std::max(entry.lastUsedMs, lastUsedMs);
+		return false;
+	}
+
+	Entry entry;
+	entry.text = text.trimmed();
+	entry.label = label.isEmpty() ? entry.text : label;
+	entry.normalized = Normalize(entry.label);
+	entry.uses = uses;
+	entry.lastUsedMs = lastUsedMs;
+
+	const uint32_t id = static_cast<uint32_t>(entries.size());
+	entries.push_back(std::move(entry));
+	byKey.insert(key, id);
+	IndexEntry(id);
+	return true;
+}
+
+void HistoryIndex::IndexEntry(uint32_t id)
+{
+	const QString &normalized = entries[id].normalized;
+	for (qsizetype i = 0; i + 3 <= normalized.size(); ++i) {
+		std::vector<uint32_t> &list = postings[Trigram(normalized.constData() + i)];
+		// Ids entram em ordem crescente: repetição na mesma entrada só pode ser o último.
+		if (list.empty() || list.back() != id)
+			list.push_back(id);
+	}
+	scratch.resize(entries.size(), 0);
+}
+
+std::vector<const HistoryIndex::Entry *> HistoryIndex::Suggest(const QString &query, int limit) const
+{
+	TRACE_SCOPE("HistoryIndex::Suggest", "ui");
+	std::vector<const Entry *> result;
+	const QString normalized = Normalize(query);
+	if (normalized.size() < 3 || limit <= 0)
+		return result;
+
+	std::vector<uint64_t> trigrams;
+	for (qsizetype i = 0; i + 3 <= normalized.size() && trigrams.size() < MAX_QUERY_TRIGRAMS; ++i) {
+		const uint64_t trigram = Trigram(normalized.constData() + i);
+		if (std::find(trigrams.begin(), trigrams.end(), trigram) == trigrams.end())
+			trigrams.push_back(trigram);
+	}
+
+	std::vector<uint32_t> touched;
+	for (uint64_t trigram : trigrams) {
+		auto it = postings.constFind(trigram);
+		if (it == postings.constEnd())
+			continue;
+		for (uint32_t id : it.value())
+			if (scratch[id]++ == 0)
+				touched.push_back(id);
+	}
+
+	// Uma ou duas letras trocadas derrubam até três trigramas; dois terços ainda aceita.
+	const size_t total = trigrams.size();
+	const size_t needed = total <= 2 ? total : std::max<size_t>(2, (total * 2 + 2) / 3);
+
+	struct Candidate {
+		const Entry *entry;
+		int quality;
+		uint8_t matched;
+	};
+	auto better = [](const Candidate &a, const Candidate &b) {
+		if (a.quality != b.quality)
+			return a.quality > b.quality;
+		if (a.matched != b.matched)
+			return a.matched > b.matched;
+		if (a.entry->uses != b.entry->uses)
+			return a.entry->uses > b.entry->uses;
+		return a.entry->lastUsedMs > b.entry->lastUsedMs;
+	};
+
+	// Heap com as "limit" melhores; a pior fica na frente. Prefixos curtos casam com quase
+	// tudo, então ordenar todos os candidatos custaria mais que a própria contagem.
+	const size_t keep = static_cast<size_t>(limit);
+	std::vector<Candidate> best;
+	best.reserve(keep);
+	for (uint32_t id : touched) {
+		const uint8_t matched = scratch[id];
+		scratch[id] = 0;
+		if (matched < needed)
+			continue;
+
+		const Entry &entry = entries[id];
+		int quality = 0;
+		if (matched == total) {
+			if (entry.normalized.startsWith(normalized))
+				quality = 2;
+			else if (total == 1 || entry.normalized.contains(normalized))
+				quality = 1;
+		}
+
+		const Candidate candidate{&entry, quality, matched};
+		if (best.size() < keep) {
+			best.push_back(candidate);
+			std::push_heap(best.begin(), best.end(), better);
+		} else if (better(candidate, best.front())) {
+			std::pop_heap(best.begin(), best.end(), better);
+			best.back() = candidate;
+			std::push_heap(best.begin(), best.end(), better);
+		}
+	}
+	std::sort_heap(best.begin(), best.end(), better);
+
+	result.reserve(best.size());
+	for (const Candidate &candidate : best)
+		result.push_back(candidate.entry);
+	return result;
+}
+
+void HistoryIndex::Trim(size_t keep)
+{
+	if (entries.size() <= keep)
+		return;
+
+	std::vector<Entry> kept = std::move(entries);
+	std::nth_element(kept.begin(), kept.begin() + static_cast<std::ptrdiff_t>(keep), kept.end(),
+			 [](const Entry &a, const Entry &b) { return a.lastUsedMs > b.lastUsedMs; });
+	kept.resize(keep);
+
+	Clear();
+	for (const Entry &entry : kept)
+		Add(entry.text, entry.label, entry.uses, entry.lastUsedMs);
+}
+
+void HistoryIndex::Clear()
+{
+	entries.clear();
+	byKey.clear();
+	postings.clear();
+	scratch.clear();
+}
+
+QByteArray HistoryIndex::Serialize(const std::vector<Entry> &entries)
+{
+	QByteArray raw;
+	QDataStream out(&raw, QIODevice::WriteOnly);
+	out.setVersion(QDataStream::Qt_6_0);
+	out << quint32(entries.size());
+	for (const Entry &entry : entries) {
+		// O rótulo só é gravado quando difere do texto (buscas digitadas são a maioria).
+		out << entry.text << (entry.label == entry.text ? QString() : entry.label) << quint32(entry.uses)
+		    << qint64(entry.lastUsedMs);
+	}
+
+	QByteArray data;
+	QDataStream header(&data, QIODevice::WriteOnly);
+	header << REQUEST_HISTORY_MAGIC << REQUEST_HISTORY_VERSION;
+	data += qCompress(raw, 9);
+	return data;
+}
+
+bool HistoryIndex::Deserialize(const QByteArray &data, HistoryIndex &out)
+{
+	QDataStream header(data);
+	quint32 magic = 0;
+	quint16 version = 0;
+	header >> magic >> version;
+	if (magic != REQUEST_HISTORY_MAGIC || version != REQUEST_HISTORY_VERSION)
+		return false;
+
+	const QByteArray raw = qUncompress(data.mid(sizeof(magic) + sizeof(version)));
+	QDataStream in(raw);
+	in.setVersion(QDataStream::Qt_6_0);
+
+	quint32 count = 0;
+	in >> count;
+	for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+		QString text;
+		QString label;
+		quint32 uses = 0;
+		qint64 lastUsedMs = 0;
+		in >> text >> label >> uses >> lastUsedMs;
+		if (in.status() == QDataStream::Ok)
+			out.Add(text, label, uses, lastUsedMs);
+	}
+	return in.status() == QDataStream::Ok;
+}
+
+RequestHistory &RequestHistory::get()
+{
+	static RequestHistory instance;
+	return instance;
+}
+
+void RequestHistory::Preload()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (state != State::Unloaded)
+			return;
+		state = State::Loading;
+	}
+
+	HistoryThread()->start([this]() {
+		TRACE_SCOPE("RequestHistory::Load", "io");
+		const uint64_t startMs = static_cast<uint64_t>(QDateTime::currentMSecsSinceEpoch());
+
+		// O índice é montado fora do mutex; a UI segue sugerindo nada até a troca.
+		HistoryIndex loaded;
+		QFile file(GetHistoryPath());
+		if (file.open(QIODevice::ReadOnly) && !HistoryIndex::Deserialize(file.readAll(), loaded)) {
+			obs_log_warning("[Nightbot SR/History] Request history is corrupt or from another version. "
+					"Starting a new one.");
+			loaded.Clear();
+		}
+
+		std::lock_guard<std::mutex> lock(mutex);
+		index = std::move(loaded);
+		state = State::Ready;
+		for (const PendingRecord &record : pending)
+			Apply(record);
+		pending.clear();
+
+		obs_log_info("[Nightbot SR/History] Loaded %zu entries in %llu ms.", index.Size(),
+			     static_cast<unsigned long long>(QDateTime::currentMSecsSinceEpoch()) - startMs);
+	});
+}
+
+void RequestHistory::RecordQuery(const QString &query)
+{
+	Record({query, QString(), true, QDateTime::currentMSecsSinceEpoch()});
+}
+
+void RequestHistory::RecordTracks(const QList<SongItem> &queue)
+{
+	const int64_t now = QDateTime::currentMSecsSinceEpoch();
+	for (const SongItem &item : queue) {
+		if (item.url.isEmpty())
+			continue;
+		const QString label = item.artist.isEmpty() ? item.title : item.title + " - " + item.artist;
+		Record({item.url, label, false, now});
+	}
+}
+
+void RequestHistory::Record(const PendingRecord &record)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (state != State::Ready) {
+			pending.push_back(record);
+		} else {
+			Apply(record);
+		}
+	}
+	Preload();
+}
+
+void RequestHistory::Apply(const PendingRecord &record)
+{
+	const bool added = index.Add(record.text, record.label, record.countUse ? 1 : 0, record.atMs);
+	if (!added && !record.countUse)
+		return;
+
+	// Deixa o histórico passar um pouco do limite para não refazer o índice a cada entrada nova.
+	if (index.Size() > MAX_ENTRIES + MAX_ENTRIES / 10)
+		index.Trim(MAX_ENTRIES);
+
+	dirty = true;
+	if (!writeScheduled) {
+		writeScheduled = true;
+		// Pode ser chamado de uma thread da API: o timer é criado na thread da UI.
+		QMetaObject::invokeMethod(
+			QCoreApplication::instance(),
+			[]() {
+				QTimer::singleShot(REQUEST_HISTORY_WRITE_DELAY_MS, QCoreApplication::instance(),
+						   []() { RequestHistory::get().Flush(false); });
+			},
+			Qt::QueuedConnection);
+	}
+}
+
+QList<HistoryIndex::Entry> RequestHistory::Suggest(const QString &query, int limit)
+{
+	QList<HistoryIndex::Entry> result;
+	std::unique_lock<std::mutex> lock(mutex, std::try_to_lock);
+	if (!lock.owns_lock() || state != State::Ready)
+		return result;
+
+	for (const HistoryIndex::Entry *entry : index.Suggest(query, limit))
+		result.append(*entry);
+	return result;
+}
+
+void RequestHistory::Flush(bool wait)
+{
+	std::vector<HistoryIndex::Entry> snapshot;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		writeScheduled = false;
+		if (!dirty || state != State::Ready)
+			return;
+		dirty = false;
+		// As strings são compartilhadas implicitamente; a cópia só mexe em contadores.
+		snapshot = index.Entries();
+	}
+
+	HistoryThread()->start([snapshot = std::move(snapshot)]() {
+		const QString path = GetHistoryPath();
+		if (path.isEmpty())
+			return;
+
+		QDir dir = QFileInfo(path).dir();
+		if (!dir.exists())
+			dir.mkpath(".");
+
+		QSaveFile file(path);
+		if (!file.open(QIODevice::WriteOnly)) {
+			obs_log_warning("[Nightbot SR/History] Failed to open request history for writing: %s",
+					file.errorString().toUtf8().constData());
+			return;
+		}
+		file.write(HistoryIndex::Serialize(snapshot));
+		if (!file.commit())
+			obs_log_warning("[Nightbot SR/History] Failed to write request history: %s",
+					file.errorString().toUtf8().constData());
+	});
+
+	if (wait)
+		HistoryThread()->waitForDone();
+}
@@ -0,0 +1,109 @@
+#ifndef REQUEST_HISTORY_H
+#define REQUEST_HISTORY_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QString>
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "song-queue.h"
+
+// Índice de buscas feitas e músicas vistas na fila, para sugerir enquanto se digita.
+//
+// Cada entrada é normalizada (minúsculas, sem acentos, pontuação vira espaço, um espaço no
+// início) e quebrada em trigramas. O espaço inicial faz " ab" marcar começo de palavra, então
+// duas letras já bastam para achar prefixos. A busca conta, por entrada, quantos trigramas da
+// consulta ela tem: todas = contém o texto; dois terços ou mais = erro de digitação tolerado.
+// Não é thread-safe; RequestHistory cuida do acesso.
+class HistoryIndex {
+public:
+	struct Entry {
+		// O que vai para o Nightbot: a busca digitada ou a URL da música.
+		QString text;
+		// O que aparece na lista ("Título - Artista" para músicas vistas na fila).
+		QString label;
+		QString normalized;
+		uint32_t uses = 0;
+		int64_t lastUsedMs = 0;
+	};
+
+	static QString Normalize(const QString &text);
+
+	// Soma um uso se o texto já existir. Retorna true se a entrada é nova.
+	bool Add(const QString &text, const QString &label, uint32_t uses, int64_t lastUsedMs);
+	// Até "limit" entradas, melhores primeiro: prefixo, depois contém, depois parecido; empates por uso.
+	std::vector<const Entry *> Suggest(const QString &query, int limit) const;
+
+	size_t Size() const { return entries.size(); }
+	const std::vector<Entry> &Entries() const { return entries; }
+	// Mantém só as "keep" entradas usadas mais recentemente e refaz o índice.
+	void Trim(size_t keep);
+	void Clear();
+
+	static QByteArray Serialize(const std::vector<Entry> &entries);
+	static bool Deserialize(const QByteArray &data, HistoryIndex &out);
+
+private:
+	void IndexEntry(uint32_t id);
+
+	std::vector<Entry> entries;
+	QHash<QString, uint32_t> byKey;
+	QHash<uint64_t, std::vector<uint32_t>> postings;
+	// Contadores reaproveitados entre buscas (zerados ao fim de cada uma).
+	mutable std::vector<uint8_t> scratch;
+};
+
+// Histórico persistente (request-history.bin na pasta de configuração do plugin, comprimido).
+// Carrega em segundo plano na primeira vez que é usado; até lá as sugestões vêm vazias e o que
+// for registrado espera numa lista. Gravação adiada e agrupada, fora da thread da UI.
+class RequestHistory {
+public:
+	static constexpr size_t MAX_ENTRIES = 100000;
+
+	static RequestHistory &get();
+
+	// Começa a carregar o arquivo, se ainda não começou.
+	void Preload();
+	// Busca que o Nightbot aceitou.
+	void RecordQuery(const QString &query);
+	// Músicas da fila com URL, para poder pedi-las de novo pela URL.
+	void RecordTracks(const QList<SongItem> &queue);
+	// Nunca bloqueia a thread da UI: vazio enquanto o arquivo carrega.
+	QList<HistoryIndex::Entry> Suggest(const QString &query, int limit);
+
+	// Grava o que estiver pendente e espera a gravação terminar.
+	void Flush(bool wait);
+
+	RequestHistory(RequestHistory const &) = delete;
+	void operator=(RequestHistory const &) = delete;
+
+private:
+	RequestHistory() = default;
+
+	struct PendingRecord {
+		QString text;
+		QString label;
+		bool countUse;
+		int64_t atMs;
+	};
+
+	void Record(const PendingRecord &record);
+	void Apply(const PendingRecord &record);
+
+	enum class State { Unloaded, Loading, Ready };
+
+	std::mutex mutex;
+	State state = State::Unloaded;
+	HistoryIndex index;
+	std::vector<PendingRecord> pending;
+	bool dirty = false;
+	bool writeScheduled = false;
+};
+
+void ShutdownRequestHistory();
+
+#endif // REQUEST_HISTORY_H
@@ -0,0 +1,110 @@
+#include "song-queue.h"
+#include "trace-recorder.h"
+
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonParseError>
+
+#include <algorithm>
+
+static SongItem ParseSongObject(const QJsonObject &songObj)
+{
+	SongItem item;
+	item.id = songObj["_id"].toString();
+	item.position = songObj["_position"].toInt();
+	QJsonObject trackObj = songObj["track"].toObject();
+	item.title = trackObj["title"].toString();
+	item.artist = trackObj["artist"].toString();
+	item.url = trackObj["url"].toString();
+	item.provider = trackObj["provider"].toString();
+	item.providerId = trackObj["providerId"].toString();
+	item.duration = trackObj["duration"].toInt();
+	return item;
+}
+
+bool ParseSongQueue(const QByteArray &json, const QString &playlistUserText, SongQueueParseResult &result)
+{
+	TRACE_SCOPE("ParseSongQueue", "json");
+	QJsonParseError parseError;
+	QJsonDocument doc = QJsonDocument::fromJson(json, &parseError);
+	if (doc.isNull() || !doc.isObject())
+		return false;
+
+	QJsonObject rootObj = doc.object();
+
+	if (rootObj.contains("_requestsEnabled")) {
+		result.hasRequestsEnabled = true;
+		result.requestsEnabled = rootObj["_requestsEnabled"].toBool();
+	}
+
+	const auto queueArray = rootObj["queue"].toArray();
+	result.queue.reserve(queueArray.size() + 1);
+
+	if (rootObj.contains("_currentSong") && rootObj["_currentSong"].isObject()) {
+		QJsonObject songObj = rootObj["_currentSong"].toObject();
+		SongItem item = ParseSongObject(songObj);
+		item.position = 0;
+		if (songObj.contains("user") && songObj["user"].isObject()) {
+			item.user = songObj["user"].toObject()["displayName"].toString();
+		} else {
+			item.user = playlistUserText;
+		}
+		result.queue.append(item);
+	}
+
+	for (const QJsonValue value : queueArray) {
+		QJsonObject songObj = value.toObject();
+		SongItem item = ParseSongObject(songObj);
+		item.user = songObj["user"].toObject()["displayName"].toString();
+		result.queue.append(item);
+	}
+
+	SortSongQueue(result.queue);
+	return true;
+}
+
+void SortSongQueue(QList<SongItem> &queue)
+{
+	// A API normalmente já devolve a fila em ordem; evita o sort nesse caso.
+	auto byPosition = [](const SongItem &a, const SongItem &b) {
+		return a.position < b.position;
+	};
+	if (!std::is_sorted(queue.begin(), queue.end(), byPosition))
+		std::sort(queue.begin(), queue.end(), byPosition);
+}
+
+SongQueueDiff DiffSongQueue(const QList<SongItem> &previous, const QList<SongItem> &current)
+{
+	SongQueueDiff diff;
+
+	const QString previousCurrent = (!previous.isEmpty() && previous.first().position == 0) ? previous.first().id
+												   : QString();
+	const QString currentCurrent = (!current.isEmpty() && current.first().position == 0) ? current.first().id
+												: QString();
+	diff.currentChanged = previousCurrent != currentCurrent;
+
+	QHash<QString, int> previousPositions;
+	previousPositions.reserve(previous.size());
+	for (const SongItem &item : previous)
+		previousPositions.insert(item.id, item.position);
+
+	for (qsizetype i = 0; i < current.size(); ++i) {
+		const SongItem &item = current.at(i);
+		auto it = previousPositions.find(item.id);
+		if (it == previousPositions.end()) {
+			diff.added.append(item.id);
+			diff.addedIndexes.append(i);
+			continue;
+		}
+		if (it.value() != item.position)
+			diff.moved++;
+		previousPositions.erase(it);
+	}
+
+	for (auto it = previousPositions.cbegin(); it != previousPositions.cend(); ++it)
+		diff.removed.append(it.key());
+
+	return diff;
+}
@@ -0,0 +1,47 @@
+#ifndef SONG_QUEUE_H
+#define SONG_QUEUE_H
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+struct SongItem {
+	QString id;
+	QString title;
+	QString artist;
+	QString user;
+	// Link da música no provedor; não vai para o cache da fila, assim como provider/providerId.
+	QString url;
+	// "youtube", "soundcloud"... e o id da faixa nele (usado para a miniatura).
+	QString provider;
+	QString providerId;
+	int position;
+	int duration;
+};
+
+struct SongQueueParseResult {
+	QList<SongItem> queue;
+	bool hasRequestsEnabled = false;
+	bool requestsEnabled = false;
+};
+
+// Diferença entre duas leituras da fila, em O(n), identificando as músicas pelo id.
+struct SongQueueDiff {
+	QStringList added;
+	// Posição em "current" de cada id de added, para quem precisa da música sem procurar na fila.
+	QList<qsizetype> addedIndexes;
+	QStringList removed;
+	int moved = 0;
+	bool currentChanged = false;
+
+	bool IsEmpty() const { return added.isEmpty() && removed.isEmpty() && moved == 0 && !currentChanged; }
+};
+
+// Interpreta a resposta de GET /1/song_requests/queue. A música atual (se houver)
+// fica na posição 0. Retorna false se o JSON for inválido.
+bool ParseSongQueue(const QByteArray &json, const QString &playlistUserText, SongQueueParseResult &result);
+void SortSongQueue(QList<SongItem> &queue);
+SongQueueDiff DiffSongQueue(const QList<SongItem> &previous, const QList<SongItem> &current);
+
+#endif // SONG_QUEUE_H
@@ -1,11 +1,23 @@
 #include "song-request-dialog.h"
 #include "nightbot-api.h"
+#include "bulk-importer.h"
+#include "request-history.h"
 #include "plugin-support.h"
+#include "ui-stall-detector.h"
 
 #include <QVBoxLayout>
+#include <QHBoxLayout>
 #include <QLineEdit>
 #include <QPushButton>
 #include <QLabel>
+#include <QFileDialog>
+#include <QProgressBar>
+#include <QPlainTextEdit>
+#include <QCompleter>
+#include <QAbstractItemView>
+#include <QStandardItemModel>
+
+static const int SUGGESTION_LIMIT = 8;
 
 SongRequestDialog::SongRequestDialog(QWidget *parent) : QDialog(parent)
 {
@@ -19,6 +31,16 @@ SongRequestDialog::SongRequestDialog(QWidget *parent) : QDialog(parent)
 		get_obs_text("Nightbot.SongRequest.Placeholder"));
 	layout->addWidget(songInput);
 
+	// As sugestões já chegam filtradas e ordenadas pelo histórico; o completer só exibe.
+	// O texto mostrado é o rótulo, o inserido (UserRole) é a busca ou a URL da música.
+	RequestHistory::get().Preload();
+	suggestions = new QStandardItemModel(this);
+	completer = new QCompleter(suggestions, this);
+	completer->setCompletionMode(QCompleter::UnfilteredPopupCompletion);
+	completer->setCompletionRole(Qt::UserRole);
+	songInput->setCompleter(completer);
+	connect(songInput, &QLineEdit::textEdited, this, &SongRequestDialog::onQueryEdited);
+
 	submitButton =
 		new QPushButton(get_obs_text("Nightbot.SongRequest.Submit"));
 	layout->addWidget(submitButton);
@@ -27,31 +49,148 @@ SongRequestDialog::SongRequestDialog(QWidget *parent) : QDialog(parent)
 	statusLabel->setWordWrap(true);
 	layout->addWidget(statusLabel);
 
+	// --- Importação de uma lista ---
+	importButton = new QPushButton(get_obs_text("Nightbot.SongRequest.Import"));
+	importButton->setToolTip(get_obs_text("Nightbot.SongRequest.Import.Tooltip"));
+	cancelImportButton = new QPushButton(get_obs_text("Nightbot.SongRequest.Import.Cancel"));
+	resumeImportButton = new QPushButton(get_obs_text("Nightbot.SongRequest.Import.Resume"));
+
+	QHBoxLayout *importLayout = new QHBoxLayout();
+	importLayout->addWidget(importButton);
+	importLayout->addWidget(cancelImportButton);
+	importLayout->addWidget(resumeImportButton);
+	layout->addLayout(importLayout);
+
+	importProgress = new QProgressBar();
+	layout->addWidget(importProgress);
+
+	importStatusLabel = new QLabel();
+	importStatusLabel->setWordWrap(true);
+	layout->addWidget(importStatusLabel);
+
+	importErrors = new QPlainTextEdit();
+	importErrors->setReadOnly(true);
+	importErrors->setMaximumHeight(120);
+	layout->addWidget(importErrors);
+
 	setLayout(layout);
 
 	connect(submitButton, &QPushButton::clicked, this,
 		&SongRequestDialog::onSubmitClicked);
 	connect(&NightbotAPI::get(), &NightbotAPI::songAdded, this,
 		&SongRequestDialog::onSongAdded);
+
+	connect(importButton, &QPushButton::clicked, this, &SongRequestDialog::onImportClicked);
+	connect(cancelImportButton, &QPushButton::clicked, this, []() { BulkImporter::get().Cancel(); });
+	connect(resumeImportButton, &QPushButton::clicked, this, []() { BulkImporter::get().Resume(true); });
+	connect(&BulkImporter::get(), &BulkImporter::progressChanged, this, &SongRequestDialog::UpdateImportUI);
+	connect(&BulkImporter::get(), &BulkImporter::finished, this, &SongRequestDialog::UpdateImportUI);
+
+	// Uma importação continua com a janela fechada; ao reabrir, o progresso volta a aparecer.
+	UpdateImportUI();
 }
 
 void SongRequestDialog::onSubmitClicked()
 {
+	UI_SLOT_SCOPE("SongRequestDialog::onSubmitClicked");
 	QString query = songInput->text().trimmed();
 	if (!query.isEmpty()) {
 		statusLabel->setText(
 			get_obs_text("Nightbot.SongRequest.Submitting"));
 		submitButton->setEnabled(false);
+		submittedQuery = query;
 		NightbotAPI::get().AddSong(query);
 	}
 }
 
 void SongRequestDialog::onSongAdded(bool success, const QString &message)
 {
+	UI_SLOT_SCOPE("SongRequestDialog::onSongAdded");
 	submitButton->setEnabled(true);
 	if (success) {
+		RequestHistory::get().RecordQuery(submittedQuery);
 		accept(); // Fecha a janela em caso de sucesso
 	} else {
 		statusLabel->setText(QString("<font color='red'>%1</font>").arg(message));
 	}
 }
+
+void SongRequestDialog::onQueryEdited(const QString &text)
+{
+	UI_SLOT_SCOPE("SongRequestDialog::onQueryEdited");
+	suggestions->clear();
+	for (const HistoryIndex::Entry &entry : RequestHistory::get().Suggest(text, SUGGESTION_LIMIT)) {
+		QStandardItem *item = new QStandardItem(entry.label);
+		item->setData(entry.text, Qt::UserRole);
+		item->setToolTip(entry.text);
+		suggestions->appendRow(item);
+	}
+
+	if (suggestions->rowCount() > 0)
+		completer->complete();
+	else
+		completer->popup()->hide();
+}
+
+void SongRequestDialog::onImportClicked()
+{
+	const QString path = QFileDialog::getOpenFileName(this, get_obs_text("Nightbot.SongRequest.Import"), "",
+							  "Song lists (*.txt *.csv);;All Files (*)");
+	if (path.isEmpty())
+		return;
+
+	QString error;
+	const QStringList queries = BulkImporter::ParseFile(path, &error);
+	if (!error.isEmpty() || queries.isEmpty()) {
+		if (error.isEmpty())
+			error = get_obs_text("Nightbot.SongRequest.Import.Empty");
+		importStatusLabel->setText(QString("<font color='red'>%1</font>").arg(error));
+		importStatusLabel->show();
+		return;
+	}
+
+	if (!BulkImporter::get().Start(queries)) {
+		importStatusLabel->setText(
+			QString("<font color='red'>%1</font>").arg(get_obs_text("Nightbot.SongRequest.Import.Busy")));
+		importStatusLabel->show();
+		return;
+	}
+	UpdateImportUI();
+}
+
+void SongRequestDialog::UpdateImportUI()
+{
+	UI_SLOT_SCOPE("SongRequestDialog::UpdateImportUI");
+	const BulkImporter::Progress progress = BulkImporter::get().GetProgress();
+	const bool hasImport = progress.total > 0;
+
+	importButton->setEnabled(!progress.running);
+	cancelImportButton->setVisible(progress.running);
+	resumeImportButton->setVisible(!progress.running && (progress.pending > 0 || progress.failed > 0));
+	importProgress->setVisible(hasImport);
+	importStatusLabel->setVisible(hasImport);
+
+	if (!hasImport) {
+		importErrors->hide();
+		shownImportErrors = 0;
+		return;
+	}
+
+	importProgress->setRange(0, progress.total);
+	importProgress->setValue(progress.added + progress.failed);
+	importStatusLabel->setText(QString(get_obs_text("Nightbot.SongRequest.Import.Progress"))
+					   .arg(progress.added)
+					   .arg(progress.total)
+					   .arg(progress.failed));
+
+	// A lista de erros só é refeita quando o número de falhas muda.
+	if (shownImportErrors == progress.failed)
+		return;
+	shownImportErrors = progress.failed;
+
+	QStringList lines;
+	for (const BulkImporter::Item &item : BulkImporter::get().FailedItems())
+		lines << QString("%1 - %2").arg(item.query, item.error);
+	importErrors->setPlainText(lines.join('\n'));
+	importErrors->setVisible(!lines.isEmpty());
+}
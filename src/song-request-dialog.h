@@ -6,6 +6,10 @@
 class QLineEdit;
 class QPushButton;
 class QLabel;
+class QProgressBar;
+class QPlainTextEdit;
+class QCompleter;
+class QStandardItemModel;
 
 class SongRequestDialog : public QDialog {
 	Q_OBJECT
@@ -16,11 +20,25 @@ public:
 private slots:
 	void onSubmitClicked();
 	void onSongAdded(bool success, const QString &message);
+	void onImportClicked();
+	void onQueryEdited(const QString &text);
+	void UpdateImportUI();
 
 private:
 	QLineEdit *songInput;
 	QPushButton *submitButton;
 	QLabel *statusLabel;
+	QCompleter *completer;
+	QStandardItemModel *suggestions;
+	QString submittedQuery;
+
+	QPushButton *importButton;
+	QPushButton *cancelImportButton;
+	QPushButton *resumeImportButton;
+	QProgressBar *importProgress;
+	QLabel *importStatusLabel;
+	QPlainTextEdit *importErrors;
+	int shownImportErrors = -1;
 };
 
 #endif // SONG_REQUEST_DIALOG_H
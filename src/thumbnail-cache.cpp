@@ -0,0 +1,200 @@
+#include "thumbnail-cache.h"
+#include "http-transport.h"
+#include "plugin-support.h"
+
+#include <obs-module.h>
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMetaObject>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QThreadPool>
+
+#include <atomic>
+
+static const char *THUMBNAIL_DIR_NAME = "thumbnails";
+// Guardadas com o dobro da resolução da tabela, para telas de alta densidade.
+static const int THUMBNAIL_SCALE = 2;
+// A lista de faixas sem miniatura só evita pedir de novo na mesma sessão; passou disso, recomeça.
+static const qsizetype MISSING_LIMIT = 1000;
+
+static QThreadPool *g_thumbnailPool = nullptr;
+static std::atomic<bool> g_thumbnailStopping{false};
+
+static QThreadPool *ThumbnailPool()
+{
+	if (!g_thumbnailPool) {
+		g_thumbnailPool = new QThreadPool();
+		g_thumbnailPool->setMaxThreadCount(ThumbnailCache::CONCURRENCY);
+	}
+	return g_thumbnailPool;
+}
+
+static QString GetThumbnailDir()
+{
+	char *path = obs_module_config_path(THUMBNAIL_DIR_NAME);
+	QString result = path ? QString::fromUtf8(path) : QString();
+	bfree(path);
+	return result;
+}
+
+// Mantém só os arquivos usados mais recentemente (ler uma miniatura atualiza a data dela).
+static void PruneDisk(const QString &dirPath)
+{
+	QDir dir(dirPath);
+	if (dirPath.isEmpty() || !dir.exists())
+		return;
+
+	const QFileInfoList files = dir.entryInfoList({"*.jpg"}, QDir::Files, QDir::Time);
+	int removed = 0;
+	for (qsizetype i = ThumbnailCache::DISK_MAX_FILES; i < files.size(); ++i) {
+		if (QFile::remove(files.at(i).absoluteFilePath()))
+			++removed;
+	}
+	if (removed > 0)
+		obs_log_info("[Nightbot SR/Thumbnails] Removed %d least recently used thumbnail(s) from disk.",
+			     removed);
+}
+
+void ShutdownThumbnailCache()
+{
+	g_thumbnailStopping = true;
+	if (g_thumbnailPool) {
+		// O que não começou é descartado; as buscas em andamento terminam (o curl tem timeout).
+		g_thumbnailPool->clear();
+		delete g_thumbnailPool;
+		g_thumbnailPool = nullptr;
+	}
+}
+
+ThumbnailCache &ThumbnailCache::get()
+{
+	static ThumbnailCache instance;
+	return instance;
+}
+
+ThumbnailCache::ThumbnailCache() : dir(GetThumbnailDir())
+{
+	memory.setMaxCost(MEMORY_BUDGET_BYTES);
+}
+
+QString ThumbnailCache::KeyFor(const SongItem &item)
+{
+	// O id vira nome de arquivo e parte da URL: só o formato dos ids do YouTube passa.
+	static const QRegularExpression youtubeId("^[A-Za-z0-9_-]{6,32}$");
+	if (item.provider.compare("youtube", Qt::CaseInsensitive) != 0 || !youtubeId.match(item.providerId).hasMatch())
+		return QString();
+	return "youtube-" + item.providerId;
+}
+
+QString ThumbnailCache::RemoteUrl(const SongItem &item)
+{
+	// 320x180, sem as faixas pretas do default.jpg.
+	return QStringLiteral("https://i.ytimg.com/vi/%1/mqdefault.jpg").arg(item.providerId);
+}
+
+QPixmap ThumbnailCache::Find(const QString &key)
+{
+	const QPixmap *pixmap = key.isEmpty() ? nullptr : memory.object(key);
+	return pixmap ? *pixmap : QPixmap();
+}
+
+void ThumbnailCache::Request(const QList<SongItem> &items)
+{
+	pending.clear();
+	pendingUrls.clear();
+	for (const SongItem &item : items) {
+		const QString key = KeyFor(item);
+		if (key.isEmpty() || memory.contains(key) || inFlight.contains(key) || missing.contains(key) ||
+		    pendingUrls.contains(key))
+			continue;
+		pending << key;
+		pendingUrls.insert(key, RemoteUrl(item));
+	}
+	StartNext();
+}
+
+void ThumbnailCache::StartNext()
+{
+	while (inFlight.size() < CONCURRENCY && !pending.isEmpty()) {
+		const QString key = pending.takeFirst();
+		const QString url = pendingUrls.take(key);
+		const bool prune = !diskPruned;
+		diskPruned = true;
+		inFlight.insert(key);
+
+		ThumbnailPool()->start([key, url, prune, dirPath = dir]() {
+			if (prune)
+				PruneDisk(dirPath);
+			bool permanent = false;
+			const QImage image = Load(dirPath, key, url, permanent);
+			if (g_thumbnailStopping)
+				return;
+			QMetaObject::invokeMethod(
+				&ThumbnailCache::get(),
+				[key, image, permanent]() { ThumbnailCache::get().OnLoaded(key, image, permanent); },
+				Qt::QueuedConnection);
+		});
+	}
+}
+
+QImage ThumbnailCache::Load(const QString &dirPath, const QString &key, const QString &url, bool &permanent)
+{
+	const QString path = dirPath.isEmpty() ? QString() : dirPath + "/" + key + ".jpg";
+	if (!path.isEmpty()) {
+		QImage cached;
+		if (cached.load(path, "JPG")) {
+			QFile file(path);
+			if (file.open(QIODevice::ReadWrite))
+				file.setFileTime(QDateTime::currentDateTimeUtc(), QFileDevice::FileModificationTime);
+			return cached;
+		}
+	}
+
+	HttpRequest request = {url.toStdString(), "GET"};
+	request.statsKey = "GET thumbnail";
+	const HttpResponse response = HttpTransportPerform(request);
+	// Rede fora ou servidor sobrecarregado: pode dar certo num próximo pedido.
+	permanent = !response.curl_error && response.http_code != 429 && response.http_code < 500;
+	if (response.curl_error || response.http_code != 200)
+		return QImage();
+
+	QImage full;
+	if (!full.loadFromData(QByteArray::fromStdString(response.body)))
+		return QImage();
+
+	// Preenche o quadro inteiro e corta o que sobrar, para todas as linhas terem o mesmo tamanho.
+	const int width = WIDTH * THUMBNAIL_SCALE;
+	const int height = HEIGHT * THUMBNAIL_SCALE;
+	const QImage expanded = full.scaled(width, height, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
+	const QImage scaled =
+		expanded.copy((expanded.width() - width) / 2, (expanded.height() - height) / 2, width, height);
+
+	if (!path.isEmpty() && QDir().mkpath(dirPath)) {
+		QSaveFile out(path);
+		if (out.open(QIODevice::WriteOnly) && scaled.save(&out, "JPG", 85))
+			out.commit();
+	}
+	return scaled;
+}
+
+void ThumbnailCache::OnLoaded(const QString &key, const QImage &image, bool permanent)
+{
+	inFlight.remove(key);
+	if (image.isNull()) {
+		if (permanent) {
+			if (missing.size() >= MISSING_LIMIT)
+				missing.clear();
+			missing.insert(key);
+		}
+	} else {
+		QPixmap *pixmap = new QPixmap(QPixmap::fromImage(image));
+		pixmap->setDevicePixelRatio(THUMBNAIL_SCALE);
+		memory.insert(key, pixmap, static_cast<qsizetype>(image.sizeInBytes()));
+		emit thumbnailReady(key);
+	}
+	StartNext();
+}
@@ -0,0 +1,73 @@
+#ifndef THUMBNAIL_CACHE_H
+#define THUMBNAIL_CACHE_H
+
+#include <QCache>
+#include <QHash>
+#include <QImage>
+#include <QObject>
+#include <QPixmap>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+#include "song-queue.h"
+
+// Miniaturas das músicas da fila.
+//
+// Memória: um QCache LRU limitado em bytes, com a imagem já reduzida ao tamanho da tabela.
+// Disco: um arquivo por faixa em "thumbnails/" na pasta de configuração do plugin, já reduzido,
+// limitado em quantidade de arquivos (os menos usados saem primeiro).
+// Rede: pelo transporte HTTP compartilhado, poucas de cada vez; a leitura, a decodificação e a
+// redução acontecem fora da thread da UI. Só quem está na tela é pedido: um novo Request
+// descarta os pedidos que ainda não começaram.
+// Só na thread da UI, exceto as tarefas internas.
+class ThumbnailCache : public QObject {
+	Q_OBJECT
+
+public:
+	static constexpr int WIDTH = 48;
+	static constexpr int HEIGHT = 27;
+	static constexpr int CONCURRENCY = 3;
+	static constexpr qsizetype MEMORY_BUDGET_BYTES = 4 * 1024 * 1024;
+	static constexpr int DISK_MAX_FILES = 2000;
+
+	static ThumbnailCache &get();
+
+	// Chave da faixa ("youtube-<id>"), ou vazia se o provedor não tiver miniatura conhecida.
+	static QString KeyFor(const SongItem &item);
+
+	// Imagem já na memória, ou nula.
+	QPixmap Find(const QString &key);
+	// Passa a buscar só estas músicas (as que ainda não estão na memória).
+	void Request(const QList<SongItem> &items);
+
+	ThumbnailCache(ThumbnailCache const &) = delete;
+	void operator=(ThumbnailCache const &) = delete;
+
+signals:
+	void thumbnailReady(const QString &key);
+
+private:
+	ThumbnailCache();
+
+	void StartNext();
+	// "permanent": a falha não muda tentando de novo (404, imagem inválida).
+	void OnLoaded(const QString &key, const QImage &image, bool permanent);
+
+	static QString RemoteUrl(const SongItem &item);
+	// Disco ou rede; roda numa thread do pool.
+	static QImage Load(const QString &dirPath, const QString &key, const QString &url, bool &permanent);
+
+	const QString dir;
+	QCache<QString, QPixmap> memory;
+	QStringList pending;
+	QHash<QString, QString> pendingUrls;
+	QSet<QString> inFlight;
+	// Faixas sem miniatura nesta sessão (404, imagem inválida); não são pedidas de novo.
+	QSet<QString> missing;
+	bool diskPruned = false;
+};
+
+void ShutdownThumbnailCache();
+
+#endif // THUMBNAIL_CACHE_H
@@ -0,0 +1,167 @@
+#include "trace-recorder.h"
+#include "plugin-support.h"
+
+#include <QCoreApplication>
+#include <QSaveFile>
+#include <QThread>
+
+#include <algorithm>
+#include <chrono>
+
+// ~64k eventos (~3 MB); o mais antigo é sobrescrito quando o buffer enche.
+static const size_t TRACE_RING_CAPACITY = 1 << 16;
+
+std::atomic<bool> TraceRecorder::enabled(false);
+
+static std::atomic<uint32_t> g_nextTraceThreadId(1);
+static thread_local uint32_t t_traceThreadId = 0;
+
+TraceRecorder &TraceRecorder::get()
+{
+	static TraceRecorder instance;
+	return instance;
+}
+
+uint64_t TraceRecorder::NowNs()
+{
+	return static_cast<uint64_t>(
+		std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+			.count());
+}
+
+void TraceRecorder::Start()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	ring.assign(TRACE_RING_CAPACITY, TraceEvent());
+	next = 0;
+	count = 0;
+	originNs = NowNs();
+	enabled.store(true, std::memory_order_relaxed);
+	obs_log_info("[Nightbot SR/Trace] Tracing started.");
+}
+
+void TraceRecorder::Stop()
+{
+	enabled.store(false, std::memory_order_relaxed);
+	obs_log_info("[Nightbot SR/Trace] Tracing stopped (%zu events).", EventCount());
+}
+
+size_t TraceRecorder::EventCount() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return count;
+}
+
+size_t TraceRecorder::MemoryBytes() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return ring.capacity() * sizeof(TraceEvent);
+}
+
+uint32_t TraceRecorder::CurrentThreadId()
+{
+	if (t_traceThreadId)
+		return t_traceThreadId;
+
+	t_traceThreadId = g_nextTraceThreadId.fetch_add(1, std::memory_order_relaxed);
+
+	QThread *thread = QThread::currentThread();
+	std::string name;
+	if (QCoreApplication::instance() && thread == QCoreApplication::instance()->thread())
+		name = "OBS UI";
+	else if (thread && !thread->objectName().isEmpty())
+		name = thread->objectName().toStdString() + " #" + std::to_string(t_traceThreadId);
+	else
+		name = "Thread #" + std::to_string(t_traceThreadId);
+
+	// Chamado com o mutex já travado por Push().
+	threadNames[t_traceThreadId] = name;
+	return t_traceThreadId;
+}
+
+void TraceRecorder::Push(const TraceEvent &event)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if (ring.empty())
+		return;
+
+	TraceEvent stored = event;
+	stored.tid = CurrentThreadId();
+	ring[next] = stored;
+	next = (next + 1) % ring.size();
+	count = std::min(count + 1, ring.size());
+}
+
+void TraceRecorder::Complete(const char *name, const char *category, uint64_t startNs, uint64_t endNs,
+			     const char *argName, int64_t argValue)
+{
+	if (!Enabled())
+		return;
+	Push({name, category, argName, argValue, startNs, endNs, 0, EventType::Complete});
+}
+
+void TraceRecorder::Async(const char *name, const char *category, uint64_t startNs, uint64_t endNs)
+{
+	if (!Enabled())
+		return;
+	Push({name, category, nullptr, 0, startNs, endNs, 0, EventType::Async});
+}
+
+static QByteArray Micros(uint64_t ns, uint64_t originNs)
+{
+	double us = ns > originNs ? static_cast<double>(ns - originNs) / 1000.0 : 0.0;
+	return QByteArray::number(us, 'f', 3);
+}
+
+bool TraceRecorder::Save(const QString &path) const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	QSaveFile file(path);
+	if (!file.open(QIODevice::WriteOnly)) {
+		obs_log_error("[Nightbot SR/Trace] Could not write trace to '%s'.", path.toUtf8().constData());
+		return false;
+	}
+
+	const QByteArray pid = QByteArray::number(QCoreApplication::applicationPid());
+	QByteArray out;
+	out.reserve(static_cast<qsizetype>(count * 160 + 1024));
+	out += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+	bool first = true;
+	auto separator = [&]() {
+		if (!first)
+			out += ",\n";
+		first = false;
+	};
+
+	for (const auto &[tid, name] : threadNames) {
+		separator();
+		out += "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":" + pid + ",\"tid\":" + QByteArray::number(tid) +
+		       ",\"args\":{\"name\":\"" + QByteArray::fromStdString(name) + "\"}}";
+	}
+
+	const size_t start = (next + ring.size() - count) % std::max<size_t>(ring.size(), 1);
+	for (size_t i = 0; i < count; ++i) {
+		const TraceEvent &event = ring[(start + i) % ring.size()];
+		const QByteArray common = QByteArray("\"name\":\"") + event.name + "\",\"cat\":\"" + event.category +
+					  "\",\"pid\":" + pid + ",\"tid\":" + QByteArray::number(event.tid);
+
+		separator();
+		if (event.type == EventType::Complete) {
+			out += "{\"ph\":\"X\"," + common + ",\"ts\":" + Micros(event.startNs, originNs) +
+			       ",\"dur\":" + Micros(event.endNs, event.startNs);
+			if (event.argName)
+				out += QByteArray(",\"args\":{\"") + event.argName + "\":" + QByteArray::number(event.argValue) + "}";
+			out += "}";
+		} else {
+			const QByteArray id = QByteArray::number(static_cast<qulonglong>(i));
+			out += "{\"ph\":\"b\"," + common + ",\"id\":" + id + ",\"ts\":" + Micros(event.startNs, originNs) + "},\n";
+			out += "{\"ph\":\"e\"," + common + ",\"id\":" + id + ",\"ts\":" + Micros(event.endNs, originNs) + "}";
+		}
+	}
+
+	out += "\n]}\n";
+	file.write(out);
+	return file.commit();
+}
@@ -0,0 +1,92 @@
+#ifndef TRACE_RECORDER_H
+#define TRACE_RECORDER_H
+
+#include <QString>
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Grava spans no formato trace_event do Chrome (abre no Perfetto ou about://tracing).
+// Os eventos vão para um buffer circular em memória; desligado, o custo é um load atômico.
+// Nomes e categorias precisam ser literais: só o ponteiro é guardado.
+class TraceRecorder {
+public:
+	static TraceRecorder &get();
+
+	static bool Enabled() { return enabled.load(std::memory_order_relaxed); }
+	static uint64_t NowNs();
+
+	void Start();
+	void Stop();
+	size_t EventCount() const;
+	size_t MemoryBytes() const;
+	bool Save(const QString &path) const;
+
+	// Span síncrono na thread atual ("X").
+	void Complete(const char *name, const char *category, uint64_t startNs, uint64_t endNs,
+		      const char *argName = nullptr, int64_t argValue = 0);
+	// Span assíncrono ("b"/"e"), em trilha própria: esperas entre threads (fila do pool, entrega de sinais).
+	void Async(const char *name, const char *category, uint64_t startNs, uint64_t endNs);
+
+private:
+	TraceRecorder() = default;
+
+	enum class EventType : uint8_t { Complete, Async };
+
+	struct TraceEvent {
+		const char *name;
+		const char *category;
+		const char *argName;
+		int64_t argValue;
+		uint64_t startNs;
+		uint64_t endNs;
+		uint32_t tid;
+		EventType type;
+	};
+
+	void Push(const TraceEvent &event);
+	uint32_t CurrentThreadId();
+
+	static std::atomic<bool> enabled;
+
+	mutable std::mutex mutex;
+	std::vector<TraceEvent> ring;
+	size_t next = 0;
+	size_t count = 0;
+	uint64_t originNs = 0;
+	std::map<uint32_t, std::string> threadNames;
+};
+
+class TraceScope {
+public:
+	TraceScope(const char *name, const char *category)
+		: name(name),
+		  category(category),
+		  startNs(TraceRecorder::Enabled() ? TraceRecorder::NowNs() : 0)
+	{
+	}
+
+	~TraceScope()
+	{
+		if (startNs && TraceRecorder::Enabled())
+			TraceRecorder::get().Complete(name, category, startNs, TraceRecorder::NowNs());
+	}
+
+	TraceScope(const TraceScope &) = delete;
+	TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+	const char *name;
+	const char *category;
+	uint64_t startNs;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name, category) TraceScope TRACE_CONCAT(traceScope, __LINE__)(name, category)
+
+#endif // TRACE_RECORDER_H
@@ -0,0 +1,228 @@
+#include "transport-stats.h"
+
+#include <QStringList>
+
+#include <algorithm>
+#include <cmath>
+
+static const uint64_t HISTOGRAM_MAX_VALUE = (uint64_t(1) << LatencyHistogram::MAX_MAGNITUDE) - 1;
+
+int LatencyHistogram::BucketIndex(uint64_t value)
+{
+	value = std::min(value, HISTOGRAM_MAX_VALUE);
+	if (value < 2 * SUB_BUCKETS)
+		return static_cast<int>(value);
+
+	int magnitude = 5;
+	while ((value >> (magnitude + 1)) != 0)
+		magnitude++;
+
+	int shift = magnitude - 4;
+	return (magnitude - 3) * SUB_BUCKETS + static_cast<int>((value >> shift) - SUB_BUCKETS);
+}
+
+uint64_t LatencyHistogram::BucketUpperBound(int index)
+{
+	if (index < 2 * SUB_BUCKETS)
+		return static_cast<uint64_t>(index);
+
+	int shift = index / SUB_BUCKETS - 1;
+	uint64_t sub = static_cast<uint64_t>(index % SUB_BUCKETS + SUB_BUCKETS);
+	return ((sub + 1) << shift) - 1;
+}
+
+void LatencyHistogram::Record(uint64_t value)
+{
+	buckets[static_cast<size_t>(BucketIndex(value))].fetch_add(1, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::Count() const
+{
+	uint64_t count = 0;
+	for (const auto &bucket : buckets)
+		count += bucket.load(std::memory_order_relaxed);
+	return count;
+}
+
+uint64_t LatencyHistogram::Percentile(double percentile) const
+{
+	uint64_t count = Count();
+	if (count == 0)
+		return 0;
+
+	uint64_t rank = static_cast<uint64_t>(std::ceil(percentile / 100.0 * static_cast<double>(count)));
+	rank = std::clamp<uint64_t>(rank, 1, count);
+
+	uint64_t seen = 0;
+	for (int i = 0; i < BUCKET_COUNT; ++i) {
+		seen += buckets[static_cast<size_t>(i)].load(std::memory_order_relaxed);
+		if (seen >= rank)
+			return BucketUpperBound(i);
+	}
+	return HISTOGRAM_MAX_VALUE;
+}
+
+void LatencyHistogram::Reset()
+{
+	for (auto &bucket : buckets)
+		bucket.store(0, std::memory_order_relaxed);
+}
+
+TransportStats &TransportStats::get()
+{
+	static TransportStats instance;
+	return instance;
+}
+
+static bool LooksLikeId(const std::string &segment)
+{
+	return segment.size() >= 12 &&
+	       std::any_of(segment.begin(), segment.end(), [](char c) { return c >= '0' && c <= '9'; });
+}
+
+std::string TransportStats::EndpointKey(const std::string &method, const std::string &url)
+{
+	size_t scheme = url.find("://");
+	size_t pathStart = url.find('/', scheme == std::string::npos ? 0 : scheme + 3);
+	std::string path = pathStart == std::string::npos ? "/" : url.substr(pathStart);
+	path = path.substr(0, path.find('?'));
+
+	std::string key = method + " ";
+	size_t start = 1;
+	while (start <= path.size()) {
+		size_t end = path.find('/', start);
+		if (end == std::string::npos)
+			end = path.size();
+		std::string segment = path.substr(start, end - start);
+		key += "/" + (LooksLikeId(segment) ? std::string(":id") : segment);
+		start = end + 1;
+	}
+	return key;
+}
+
+void TransportStats::Record(const std::string &endpoint, const TransportSample &sample)
+{
+	EndpointStats *entry;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		auto &stats = endpoints[endpoint];
+		if (!stats)
+			stats = std::make_unique<EndpointStats>();
+		stats->statuses[sample.status]++;
+		entry = stats.get();
+	}
+
+	// As entradas nunca são removidas (Reset só zera), então o ponteiro continua válido fora do lock.
+	EndpointStats &stats = *entry;
+	stats.requests.fetch_add(1, std::memory_order_relaxed);
+	if (sample.failed)
+		stats.errors.fetch_add(1, std::memory_order_relaxed);
+	if (sample.reusedConnection)
+		stats.reused.fetch_add(1, std::memory_order_relaxed);
+	stats.bytesSent.fetch_add(sample.bytesSent, std::memory_order_relaxed);
+	stats.bytesReceived.fetch_add(sample.bytesReceived, std::memory_order_relaxed);
+	stats.totalUsSum.fetch_add(sample.totalUs, std::memory_order_relaxed);
+
+	stats.nameLookup.Record(sample.nameLookupUs);
+	stats.connect.Record(sample.connectUs);
+	if (sample.appConnectUs > 0)
+		stats.appConnect.Record(sample.appConnectUs);
+	stats.startTransfer.Record(sample.startTransferUs);
+	stats.total.Record(sample.totalUs);
+	stats.bodySize.Record(sample.bytesReceived);
+}
+
+static QString FormatMs(uint64_t us)
+{
+	return QString::number(static_cast<double>(us) / 1000.0, 'f', 1) + " ms";
+}
+
+static QString FormatBytes(uint64_t bytes)
+{
+	if (bytes < 1024)
+		return QString::number(bytes) + " B";
+	if (bytes < 1024 * 1024)
+		return QString::number(static_cast<double>(bytes) / 1024.0, 'f', 1) + " KB";
+	return QString::number(static_cast<double>(bytes) / (1024.0 * 1024.0), 'f', 1) + " MB";
+}
+
+static QString Percent(uint64_t part, uint64_t whole)
+{
+	return QString::number(whole ? 100.0 * static_cast<double>(part) / static_cast<double>(whole) : 0.0, 'f', 1) + "%";
+}
+
+static QString TimingLine(const char *label, const LatencyHistogram &histogram)
+{
+	if (histogram.Count() == 0)
+		return QString("  %1 -").arg(QString::fromLatin1(label), -10);
+
+	return QString("  %1 p50 %2  p95 %3  p99 %4")
+		.arg(QString::fromLatin1(label), -10)
+		.arg(FormatMs(histogram.Percentile(50)), 10)
+		.arg(FormatMs(histogram.Percentile(95)), 10)
+		.arg(FormatMs(histogram.Percentile(99)), 10);
+}
+
+QString TransportStats::Report() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	QStringList lines;
+	for (const auto &[endpoint, stats] : endpoints) {
+		uint64_t requests = stats->requests.load(std::memory_order_relaxed);
+		if (requests == 0)
+			continue;
+
+		uint64_t errors = stats->errors.load(std::memory_order_relaxed);
+		uint64_t reused = stats->reused.load(std::memory_order_relaxed);
+
+		lines << QString::fromStdString(endpoint);
+		lines << QString("  requests %1, errors %2 (%3), reused connections %4")
+				 .arg(requests)
+				 .arg(errors)
+				 .arg(Percent(errors, requests))
+				 .arg(Percent(reused, requests));
+		lines << QString("  sent %1, received %2, body p50 %3  p95 %4")
+				 .arg(FormatBytes(stats->bytesSent.load(std::memory_order_relaxed)))
+				 .arg(FormatBytes(stats->bytesReceived.load(std::memory_order_relaxed)))
+				 .arg(FormatBytes(stats->bodySize.Percentile(50)))
+				 .arg(FormatBytes(stats->bodySize.Percentile(95)));
+		// Tempos do curl são acumulados desde o início da requisição.
+		lines << TimingLine("total", stats->total);
+		lines << TimingLine("first byte", stats->startTransfer);
+		lines << TimingLine("tls", stats->appConnect);
+		lines << TimingLine("connect", stats->connect);
+		lines << TimingLine("dns", stats->nameLookup);
+		lines << QString();
+	}
+
+	return lines.join('\n');
+}
+
+void TransportStats::Reset()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	for (auto &entry : endpoints) {
+		EndpointStats &stats = *entry.second;
+		stats.requests.store(0, std::memory_order_relaxed);
+		stats.errors.store(0, std::memory_order_relaxed);
+		stats.reused.store(0, std::memory_order_relaxed);
+		stats.bytesSent.store(0, std::memory_order_relaxed);
+		stats.bytesReceived.store(0, std::memory_order_relaxed);
+		stats.totalUsSum.store(0, std::memory_order_relaxed);
+		stats.statuses.clear();
+		stats.nameLookup.Reset();
+		stats.connect.Reset();
+		stats.appConnect.Reset();
+		stats.startTransfer.Reset();
+		stats.total.Reset();
+		stats.bodySize.Reset();
+	}
+}
+
+void TransportStats::ForEachEndpoint(const std::function<void(const std::string &, const EndpointStats &)> &visit) const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	for (const auto &[endpoint, stats] : endpoints)
+		visit(endpoint, *stats);
+}
@@ -0,0 +1,88 @@
+#ifndef TRANSPORT_STATS_H
+#define TRANSPORT_STATS_H
+
+#include <QString>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+// Histograma log-linear no estilo HDR: 16 sub-faixas por potência de 2 (~6% de erro),
+// de 1 até 2^26 (~67 s em microssegundos). Gravar é só um incremento atômico.
+class LatencyHistogram {
+public:
+	static constexpr int SUB_BUCKETS = 16;
+	static constexpr int MAX_MAGNITUDE = 26;
+	static constexpr int BUCKET_COUNT = (MAX_MAGNITUDE - 3) * SUB_BUCKETS;
+
+	void Record(uint64_t value);
+	uint64_t Count() const;
+	uint64_t Percentile(double percentile) const;
+	void Reset();
+
+	static int BucketIndex(uint64_t value);
+	static uint64_t BucketUpperBound(int index);
+
+private:
+	std::array<std::atomic<uint32_t>, BUCKET_COUNT> buckets{};
+};
+
+struct TransportSample {
+	long status = 0;
+	bool failed = false;
+	bool reusedConnection = false;
+	uint64_t nameLookupUs = 0;
+	uint64_t connectUs = 0;
+	uint64_t appConnectUs = 0;
+	uint64_t startTransferUs = 0;
+	uint64_t totalUs = 0;
+	uint64_t bytesSent = 0;
+	uint64_t bytesReceived = 0;
+};
+
+struct EndpointStats {
+	std::atomic<uint64_t> requests{0};
+	std::atomic<uint64_t> errors{0};
+	std::atomic<uint64_t> reused{0};
+	std::atomic<uint64_t> bytesSent{0};
+	std::atomic<uint64_t> bytesReceived{0};
+	std::atomic<uint64_t> totalUsSum{0};
+	// Respostas por status HTTP (-1 = erro do curl). Protegido pelo mutex do TransportStats.
+	std::map<long, uint64_t> statuses;
+
+	LatencyHistogram nameLookup;
+	LatencyHistogram connect;
+	LatencyHistogram appConnect;
+	LatencyHistogram startTransfer;
+	LatencyHistogram total;
+	LatencyHistogram bodySize;
+};
+
+// Estatísticas por endpoint ("GET /1/song_requests/queue"), alimentadas pelo transporte HTTP.
+class TransportStats {
+public:
+	static TransportStats &get();
+
+	// Troca IDs no caminho por ":id" para que DELETE/promote de músicas diferentes caiam no mesmo endpoint.
+	static std::string EndpointKey(const std::string &method, const std::string &url);
+
+	void Record(const std::string &endpoint, const TransportSample &sample);
+	QString Report() const;
+	void Reset();
+	// Percorre os endpoints com o lock travado; o callback não pode chamar o TransportStats.
+	void ForEachEndpoint(const std::function<void(const std::string &, const EndpointStats &)> &visit) const;
+
+private:
+	TransportStats() = default;
+
+
+	mutable std::mutex mutex;
+	std::map<std::string, std::unique_ptr<EndpointStats>> endpoints;
+};
+
+#endif // TRANSPORT_STATS_H
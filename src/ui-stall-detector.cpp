@@ -0,0 +1,260 @@
+#include "ui-stall-detector.h"
+#include "plugin-support.h"
+
+#include <util/platform.h>
+
+#include <QCoreApplication>
+#include <QStringList>
+#include <QThread>
+
+#include <chrono>
+
+static const uint64_t NS_PER_MS = 1000000;
+static const uint64_t NS_PER_SECOND = 1000000000;
+// Pulsos do watchdog; 50 ms equivalem a ~3 quadros perdidos numa UI a 60 Hz.
+static const int WATCHDOG_INTERVAL_MS = 50;
+static const uint64_t WATCHDOG_LAG_NS = 50 * NS_PER_MS;
+// No máximo um aviso de travamento por segundo; os demais só são contados.
+static const uint64_t STALL_LOG_INTERVAL_NS = NS_PER_SECOND;
+
+static double Ms(uint64_t ns)
+{
+	return static_cast<double>(ns) / static_cast<double>(NS_PER_MS);
+}
+
+UiStallDetector &UiStallDetector::get()
+{
+	static UiStallDetector instance;
+	return instance;
+}
+
+void UiStallDetector::SetThresholdMs(int thresholdMs)
+{
+	thresholdUs.store(thresholdMs * 1000, std::memory_order_relaxed);
+}
+
+int UiStallDetector::GetThresholdMs() const
+{
+	return thresholdUs.load(std::memory_order_relaxed) / 1000;
+}
+
+bool UiStallDetector::OnUiThread()
+{
+	// 0 = ainda não verificado, 1 = thread da UI, 2 = outra thread.
+	static thread_local int state = 0;
+	if (state == 0) {
+		QCoreApplication *app = QCoreApplication::instance();
+		if (!app)
+			return false;
+		state = app->thread() == QThread::currentThread() ? 1 : 2;
+	}
+	return state == 1;
+}
+
+void UiStallDetector::Enter(const char *name)
+{
+	if (depth++ == 0) {
+		frame.name = name;
+		frame.phaseCount = 0;
+	}
+}
+
+void UiStallDetector::Leave(const char *name, uint64_t startNs, uint64_t nowNs)
+{
+	const uint64_t durationNs = nowNs - startNs;
+	if (--depth > 0) {
+		if (frame.phaseCount < MAX_PHASES)
+			frame.phases[frame.phaseCount++] = {name, durationNs};
+		return;
+	}
+
+	FinishFrame(durationNs, nowNs);
+}
+
+void UiStallDetector::FinishFrame(uint64_t durationNs, uint64_t nowNs)
+{
+	slotInvocations.fetch_add(1, std::memory_order_relaxed);
+	busyNsTotal.fetch_add(durationNs, std::memory_order_relaxed);
+	slotUs.Record(durationNs / 1000);
+	AddToBudget(nowNs, durationNs);
+
+	const int threshold = thresholdUs.load(std::memory_order_relaxed);
+	if (threshold <= 0 || durationNs < static_cast<uint64_t>(threshold) * 1000)
+		return;
+
+	stalls.fetch_add(1, std::memory_order_relaxed);
+	if (lastStallLogNs != 0 && nowNs - lastStallLogNs < STALL_LOG_INTERVAL_NS) {
+		suppressedStallLogs++;
+		return;
+	}
+	lastStallLogNs = nowNs;
+
+	// As fases aparecem na ordem em que terminaram (as internas antes das externas).
+	QStringList breakdown;
+	for (int i = 0; i < frame.phaseCount; i++) {
+		const Phase &phase = frame.phases[i];
+		breakdown << QString("%1 %2 ms")
+				     .arg(QString::fromLatin1(phase.name))
+				     .arg(Ms(phase.durationNs), 0, 'f', 2);
+	}
+	if (frame.phaseCount == 0)
+		breakdown << QString("no phases recorded");
+
+	QString suppressed;
+	if (suppressedStallLogs > 0)
+		suppressed = QString(" (%1 more since last report)").arg(suppressedStallLogs);
+	suppressedStallLogs = 0;
+
+	obs_log_warning("[Nightbot SR/Stall] %s blocked the UI thread for %.2f ms (threshold %d ms): %s%s", frame.name,
+			Ms(durationNs), threshold / 1000, breakdown.join(", ").toUtf8().constData(),
+			suppressed.toUtf8().constData());
+}
+
+void UiStallDetector::AddToBudget(uint64_t nowNs, uint64_t durationNs)
+{
+	const uint64_t second = nowNs / NS_PER_SECOND;
+	const size_t index = static_cast<size_t>(second % BUDGET_WINDOW_SECONDS);
+
+	if (budgetSecond[index].load(std::memory_order_relaxed) != second) {
+		budgetSecond[index].store(second, std::memory_order_relaxed);
+		budgetNs[index].store(0, std::memory_order_relaxed);
+	}
+	const uint64_t used = budgetNs[index].fetch_add(durationNs, std::memory_order_relaxed) + durationNs;
+
+	if (used > BUDGET_NS_PER_SECOND && lastOverBudgetSecond != second) {
+		lastOverBudgetSecond = second;
+		obs_log_warning("[Nightbot SR/Stall] Plugin used %.1f ms of the UI thread within one second "
+				"(budget %.0f ms).",
+				Ms(used), Ms(BUDGET_NS_PER_SECOND));
+	}
+}
+
+uint64_t UiStallDetector::BudgetUsedNs(uint64_t nowNs) const
+{
+	const uint64_t second = nowNs / NS_PER_SECOND;
+	uint64_t total = 0;
+	for (size_t i = 0; i < budgetNs.size(); i++) {
+		const uint64_t bucketSecond = budgetSecond[i].load(std::memory_order_relaxed);
+		if (bucketSecond + BUDGET_WINDOW_SECONDS > second)
+			total += budgetNs[i].load(std::memory_order_relaxed);
+	}
+	return total;
+}
+
+void UiStallDetector::StartWatchdog()
+{
+	std::lock_guard<std::mutex> lock(watchdogMutex);
+	if (watchdog.joinable() || !QCoreApplication::instance())
+		return;
+
+	// Os pulsos são entregues a este objeto: destruí-lo descarta os que ainda estão na fila.
+	heartbeatContext = new QObject();
+	heartbeatContext->moveToThread(QCoreApplication::instance()->thread());
+	heartbeatInFlight.store(false);
+	watchdogStop = false;
+	watchdog = std::thread([this]() { WatchdogLoop(); });
+}
+
+void UiStallDetector::StopWatchdog()
+{
+	{
+		std::lock_guard<std::mutex> lock(watchdogMutex);
+		if (!watchdog.joinable())
+			return;
+		watchdogStop = true;
+	}
+	watchdogWake.notify_all();
+	watchdog.join();
+
+	delete heartbeatContext;
+	heartbeatContext = nullptr;
+}
+
+void UiStallDetector::WatchdogLoop()
+{
+	std::unique_lock<std::mutex> lock(watchdogMutex);
+	while (!watchdogStop) {
+		watchdogWake.wait_for(lock, std::chrono::milliseconds(WATCHDOG_INTERVAL_MS));
+		if (watchdogStop)
+			break;
+
+		// Um pulso por vez: enquanto a UI não processar o anterior, o atraso continua sendo medido por ele.
+		if (heartbeatInFlight.exchange(true))
+			continue;
+
+		const uint64_t postedNs = os_gettime_ns();
+		const uint64_t busyAtPost = busyNsTotal.load(std::memory_order_relaxed);
+		QMetaObject::invokeMethod(
+			heartbeatContext, [this, postedNs, busyAtPost]() { OnHeartbeat(postedNs, busyAtPost); },
+			Qt::QueuedConnection);
+	}
+}
+
+void UiStallDetector::OnHeartbeat(uint64_t postedNs, uint64_t busyAtPost)
+{
+	heartbeatInFlight.store(false);
+
+	const uint64_t lagNs = os_gettime_ns() - postedNs;
+	if (lagNs < WATCHDOG_LAG_NS)
+		return;
+
+	lagEvents.fetch_add(1, std::memory_order_relaxed);
+
+	// Tempo dos slots do plugin concluídos enquanto o pulso esperava na fila. Um slot que começou
+	// antes do pulso conta inteiro, por isso o valor é limitado ao próprio atraso.
+	uint64_t pluginNs = busyNsTotal.load(std::memory_order_relaxed) - busyAtPost;
+	if (pluginNs > lagNs)
+		pluginNs = lagNs;
+
+	if (pluginNs * 2 < lagNs)
+		return;
+
+	lagEventsByPlugin.fetch_add(1, std::memory_order_relaxed);
+	obs_log_warning("[Nightbot SR/Stall] OBS UI was unresponsive for %.1f ms; plugin work accounts for %.1f ms.",
+			Ms(lagNs), Ms(pluginNs));
+}
+
+QString UiStallDetector::Report() const
+{
+	const uint64_t invocations = slotInvocations.load(std::memory_order_relaxed);
+	const uint64_t usedNs = BudgetUsedNs(os_gettime_ns());
+
+	QString report;
+	report += QString("  slots %1, over %2 ms: %3, busy %4 ms total\n")
+			  .arg(invocations)
+			  .arg(GetThresholdMs())
+			  .arg(stalls.load(std::memory_order_relaxed))
+			  .arg(Ms(busyNsTotal.load(std::memory_order_relaxed)), 0, 'f', 1);
+	if (slotUs.Count() > 0)
+		report += QString("  slot p50 %1 ms  p95 %2 ms  p99 %3 ms\n")
+				  .arg(static_cast<double>(slotUs.Percentile(50)) / 1000.0, 0, 'f', 2)
+				  .arg(static_cast<double>(slotUs.Percentile(95)) / 1000.0, 0, 'f', 2)
+				  .arg(static_cast<double>(slotUs.Percentile(99)) / 1000.0, 0, 'f', 2);
+	const double windowNs = static_cast<double>(BUDGET_WINDOW_SECONDS * NS_PER_SECOND);
+	const double usedPercent = 100.0 * static_cast<double>(usedNs) / windowNs;
+	const double budgetPercent = 100.0 * static_cast<double>(BUDGET_NS_PER_SECOND) / static_cast<double>(NS_PER_SECOND);
+	report += QString("  last %1 s: %2 ms (%3% of the UI thread, budget %4%)\n")
+			  .arg(BUDGET_WINDOW_SECONDS)
+			  .arg(Ms(usedNs), 0, 'f', 1)
+			  .arg(usedPercent, 0, 'f', 3)
+			  .arg(budgetPercent, 0, 'f', 1);
+	report += QString("  UI lag events %1 (%2 caused by the plugin)\n")
+			  .arg(lagEvents.load(std::memory_order_relaxed))
+			  .arg(lagEventsByPlugin.load(std::memory_order_relaxed));
+	return report;
+}
+
+UiSlotScope::UiSlotScope(const char *name) : name(name), startNs(0)
+{
+	if (!UiStallDetector::OnUiThread())
+		return;
+
+	startNs = os_gettime_ns();
+	UiStallDetector::get().Enter(name);
+}
+
+UiSlotScope::~UiSlotScope()
+{
+	if (startNs)
+		UiStallDetector::get().Leave(name, startNs, os_gettime_ns());
+}
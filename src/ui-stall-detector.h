@@ -0,0 +1,109 @@
+#ifndef UI_STALL_DETECTOR_H
+#define UI_STALL_DETECTOR_H
+
+#include "trace-recorder.h"
+#include "transport-stats.h"
+
+#include <QString>
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+class QObject;
+
+// Mede o tempo que os slots do plugin passam na thread da UI do OBS.
+//
+//  - Cada UI_SLOT_SCOPE externo vira uma "invocação"; escopos aninhados viram fases dela.
+//  - Invocações acima do limite (padrão 4 ms) são registradas no log com as fases.
+//  - Um orçamento móvel soma o tempo de UI do plugin por segundo nos últimos 60 s.
+//  - O watchdog mede o atraso do event loop da UI e diz se o plugin estava ocupando a thread.
+class UiStallDetector {
+public:
+	static constexpr int MAX_PHASES = 8;
+	static constexpr int BUDGET_WINDOW_SECONDS = 60;
+	// Orçamento por segundo: 1% da thread da UI.
+	static constexpr uint64_t BUDGET_NS_PER_SECOND = 10 * 1000 * 1000;
+
+	static UiStallDetector &get();
+
+	void SetThresholdMs(int thresholdMs);
+	int GetThresholdMs() const;
+
+	void StartWatchdog();
+	void StopWatchdog();
+
+	// Usados por UiSlotScope, sempre na thread da UI.
+	static bool OnUiThread();
+	void Enter(const char *name);
+	void Leave(const char *name, uint64_t startNs, uint64_t nowNs);
+
+	QString Report() const;
+
+	LatencyHistogram slotUs;
+	std::atomic<uint64_t> slotInvocations{0};
+	std::atomic<uint64_t> busyNsTotal{0};
+	std::atomic<uint64_t> stalls{0};
+	std::atomic<uint64_t> lagEvents{0};
+	std::atomic<uint64_t> lagEventsByPlugin{0};
+
+private:
+	UiStallDetector() = default;
+
+	struct Phase {
+		const char *name;
+		uint64_t durationNs;
+	};
+
+	struct Frame {
+		const char *name = nullptr;
+		Phase phases[MAX_PHASES];
+		int phaseCount = 0;
+	};
+
+	void FinishFrame(uint64_t durationNs, uint64_t nowNs);
+	void AddToBudget(uint64_t nowNs, uint64_t durationNs);
+	uint64_t BudgetUsedNs(uint64_t nowNs) const;
+	void WatchdogLoop();
+	void OnHeartbeat(uint64_t postedNs, uint64_t busyAtPost);
+
+	std::atomic<int> thresholdUs{4000};
+
+	// Estado da invocação corrente; só a thread da UI mexe.
+	Frame frame;
+	int depth = 0;
+	uint64_t lastStallLogNs = 0;
+	uint64_t suppressedStallLogs = 0;
+
+	// Um balde por segundo; o índice do segundo fica junto para descartar baldes antigos.
+	std::array<std::atomic<uint64_t>, BUDGET_WINDOW_SECONDS> budgetNs{};
+	std::array<std::atomic<uint64_t>, BUDGET_WINDOW_SECONDS> budgetSecond{};
+	uint64_t lastOverBudgetSecond = 0;
+
+	std::thread watchdog;
+	std::mutex watchdogMutex;
+	std::condition_variable watchdogWake;
+	bool watchdogStop = false;
+	std::atomic<bool> heartbeatInFlight{false};
+	QObject *heartbeatContext = nullptr;
+};
+
+class UiSlotScope {
+public:
+	explicit UiSlotScope(const char *name);
+	~UiSlotScope();
+
+	UiSlotScope(const UiSlotScope &) = delete;
+	UiSlotScope &operator=(const UiSlotScope &) = delete;
+
+private:
+	const char *name;
+	uint64_t startNs;
+};
+
+#define UI_SLOT_SCOPE(name) UiSlotScope TRACE_CONCAT(uiSlotScope, __LINE__)(name)
+
+#endif // UI_STALL_DETECTOR_H
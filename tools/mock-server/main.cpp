@@ -0,0 +1,696 @@
+/*
+Nightbot SR OBS Plugin - servidor mock
+Imita a API do Nightbot e o backend de refresh-token para testes offline,
+com injeção de latência, erros HTTP, corpos truncados e conexões travadas.
+*/
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QList>
+#include <QMap>
+#include <QPointer>
+#include <QRandomGenerator>
+#include <QSet>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+
+#include <algorithm>
+#include <deque>
+#include <optional>
+
+struct MockSong {
+	QString id;
+	QString title;
+	QString artist;
+	QString user;
+	QString providerId;
+	int duration = 0;
+	qint64 createdAt = 0;
+};
+
+struct FaultConfig {
+	int latencyMs = 0;
+	int jitterMs = 0;
+	double errorRate = 0.0;
+	QList<int> errorStatus{500};
+	double truncateRate = 0.0;
+	double stallRate = 0.0;
+};
+
+struct MockRequest {
+	QByteArray method;
+	QByteArray path;
+	QHash<QByteArray, QByteArray> headers;
+	QByteArray body;
+	bool keepAlive = true;
+};
+
+struct MockReply {
+	int status = 200;
+	QByteArray body;
+	QList<QPair<QByteArray, QByteArray>> headers;
+};
+
+enum class FaultKind { None, Status, Truncate, Stall };
+
+struct Fault {
+	FaultKind kind = FaultKind::None;
+	int status = 0;
+	int latencyMs = -1;
+};
+
+static QByteArray StatusText(int status)
+{
+	switch (status) {
+	case 200:
+		return "OK";
+	case 204:
+		return "No Content";
+	case 400:
+		return "Bad Request";
+	case 401:
+		return "Unauthorized";
+	case 404:
+		return "Not Found";
+	case 429:
+		return "Too Many Requests";
+	case 500:
+		return "Internal Server Error";
+	case 502:
+		return "Bad Gateway";
+	case 503:
+		return "Service Unavailable";
+	default:
+		return "Unknown";
+	}
+}
+
+static MockReply JsonReply(int status, const QJsonObject &object)
+{
+	MockReply reply;
+	reply.status = status;
+	reply.body = QJsonDocument(object).toJson(QJsonDocument::Compact);
+	reply.headers.append({"Content-Type", "application/json; charset=utf-8"});
+	return reply;
+}
+
+static MockReply ErrorReply(int status, const QString &message)
+{
+	QJsonObject object;
+	object["status"] = status;
+	object["message"] = message;
+	return JsonReply(status, object);
+}
+
+class MockServer {
+public:
+	MockServer(const FaultConfig &defaults, int tokenTtlSeconds) : faults(defaults), tokenTtl(tokenTtlSeconds)
+	{
+		tokenIssuedAt = QDateTime::currentSecsSinceEpoch();
+		QObject::connect(&server, &QTcpServer::newConnection, &server, [this]() { OnConnection(); });
+
+		// Comentários SSE mantêm as conexões de /events vivas e alimentam o timeout do cliente.
+		heartbeat.setInterval(15000);
+		QObject::connect(&heartbeat, &QTimer::timeout, &server, [this]() {
+			for (QTcpSocket *subscriber : std::as_const(subscribers))
+				subscriber->write(": ping\n\n");
+		});
+		heartbeat.start();
+	}
+
+	bool Listen(quint16 port) { return server.listen(QHostAddress::LocalHost, port); }
+	quint16 Port() const { return server.serverPort(); }
+
+	void Seed(int count)
+	{
+		for (int i = 0; i < count; ++i)
+			queue.append(MakeSong(QStringLiteral("Seeded Song %1").arg(nextId), QStringLiteral("viewer_%1").arg(i % 7)));
+		if (!current && !queue.isEmpty())
+			current = queue.takeFirst();
+	}
+
+private:
+	struct Connection {
+		QByteArray buffer;
+		bool busy = false;
+	};
+
+	void OnConnection()
+	{
+		while (QTcpSocket *socket = server.nextPendingConnection()) {
+			connections.insert(socket, Connection());
+			QObject::connect(socket, &QTcpSocket::readyRead, socket, [this, socket]() {
+				connections[socket].buffer.append(socket->readAll());
+				ProcessBuffer(socket);
+			});
+			QObject::connect(socket, &QTcpSocket::disconnected, socket, [this, socket]() {
+				connections.remove(socket);
+				subscribers.remove(socket);
+				socket->deleteLater();
+			});
+		}
+	}
+
+	bool TakeRequest(QByteArray &buffer, MockRequest &request)
+	{
+		qsizetype headerEnd = buffer.indexOf("\r\n\r\n");
+		if (headerEnd < 0)
+			return false;
+
+		QList<QByteArray> lines = buffer.left(headerEnd).split('\n');
+		QList<QByteArray> requestLine = lines.first().trimmed().split(' ');
+		if (requestLine.size() < 2)
+			return false;
+
+		request = MockRequest();
+		request.method = requestLine.at(0);
+		request.path = requestLine.at(1);
+		qsizetype queryStart = request.path.indexOf('?');
+		if (queryStart >= 0)
+			request.path.truncate(queryStart);
+
+		for (qsizetype i = 1; i < lines.size(); ++i) {
+			qsizetype colon = lines.at(i).indexOf(':');
+			if (colon > 0)
+				request.headers.insert(lines.at(i).left(colon).trimmed().toLower(),
+						       lines.at(i).mid(colon + 1).trimmed());
+		}
+
+		qsizetype contentLength = request.headers.value("content-length", "0").toLongLong();
+		qsizetype total = headerEnd + 4 + contentLength;
+		if (buffer.size() < total)
+			return false;
+
+		request.body = buffer.mid(headerEnd + 4, contentLength);
+		request.keepAlive = request.headers.value("connection").toLower() != "close";
+		buffer.remove(0, total);
+		return true;
+	}
+
+	void ProcessBuffer(QTcpSocket *socket)
+	{
+		Connection &connection = connections[socket];
+		if (connection.busy)
+			return;
+
+		MockRequest request;
+		if (!TakeRequest(connection.buffer, request))
+			return;
+
+		connection.busy = true;
+		Dispatch(socket, request);
+	}
+
+	Fault PickFault(const MockRequest &request)
+	{
+		Fault fault;
+		QByteArray spec = request.headers.value("x-mock-fault");
+		if (spec.isEmpty() && !nextFaults.empty()) {
+			spec = nextFaults.front();
+			nextFaults.pop_front();
+		}
+
+		if (!spec.isEmpty()) {
+			if (spec == "truncate") {
+				fault.kind = FaultKind::Truncate;
+			} else if (spec == "stall") {
+				fault.kind = FaultKind::Stall;
+			} else if (spec.startsWith("latency=")) {
+				fault.latencyMs = spec.mid(8).toInt();
+			} else if (spec.toInt() >= 400) {
+				fault.kind = FaultKind::Status;
+				fault.status = spec.toInt();
+			}
+			return fault;
+		}
+
+		QRandomGenerator *rng = QRandomGenerator::global();
+		double roll = rng->generateDouble();
+		if (roll < faults.stallRate) {
+			fault.kind = FaultKind::Stall;
+		} else if (roll < faults.stallRate + faults.truncateRate) {
+			fault.kind = FaultKind::Truncate;
+		} else if (roll < faults.stallRate + faults.truncateRate + faults.errorRate && !faults.errorStatus.isEmpty()) {
+			fault.kind = FaultKind::Status;
+			fault.status = faults.errorStatus.at(rng->bounded(static_cast<int>(faults.errorStatus.size())));
+		}
+		return fault;
+	}
+
+	void Dispatch(QTcpSocket *socket, const MockRequest &request)
+	{
+		const bool control = request.path.startsWith("/__mock/");
+		Fault fault = control ? Fault() : PickFault(request);
+		requestCounts[QString::fromLatin1(request.method + " " + RoutePattern(request.path))]++;
+
+		if (fault.kind == FaultKind::Stall) {
+			qInfo("%s %s -> stalled", request.method.constData(), request.path.constData());
+			stalledRequests++;
+			// A conexão fica aberta sem resposta até o cliente desistir.
+			return;
+		}
+
+		if (request.path == "/events" && request.method == "GET" && fault.kind != FaultKind::Status &&
+		    IsAuthorized(request)) {
+			OpenEventStream(socket);
+			return;
+		}
+
+		MockReply reply;
+		if (fault.kind == FaultKind::Status) {
+			reply = ErrorReply(fault.status, QStringLiteral("Injected %1").arg(fault.status));
+			if (fault.status == 429)
+				reply.headers.append({"Retry-After", "2"});
+		} else {
+			reply = Route(request);
+		}
+		statusCounts[reply.status]++;
+
+		// Toda alteração bem-sucedida vira um evento para quem está inscrito em /events.
+		if (request.path.startsWith("/1/") && request.method != "GET" && reply.status < 300)
+			BroadcastChange(request.method + " " + RoutePattern(request.path));
+
+		int delay = fault.latencyMs;
+		if (delay < 0 && !control)
+			delay = faults.latencyMs + (faults.jitterMs > 0 ? QRandomGenerator::global()->bounded(faults.jitterMs + 1) : 0);
+		delay = std::max(delay, 0);
+
+		const bool truncate = fault.kind == FaultKind::Truncate;
+		qInfo("%s %s -> %d%s (%d ms)", request.method.constData(), request.path.constData(), reply.status,
+		      truncate ? " truncated" : "", delay);
+
+		QPointer<QTcpSocket> target(socket);
+		bool keepAlive = request.keepAlive && !truncate;
+		QTimer::singleShot(delay, socket, [this, target, reply, truncate, keepAlive]() {
+			if (target)
+				WriteReply(target, reply, truncate, keepAlive);
+		});
+	}
+
+	void WriteReply(QTcpSocket *socket, const MockReply &reply, bool truncate, bool keepAlive)
+	{
+		QByteArray head = "HTTP/1.1 " + QByteArray::number(reply.status) + " " + StatusText(reply.status) + "\r\n";
+		for (const auto &header : reply.headers)
+			head += header.first + ": " + header.second + "\r\n";
+		head += "Content-Length: " + QByteArray::number(reply.body.size()) + "\r\n";
+		head += keepAlive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n";
+
+		socket->write(head);
+		socket->write(truncate ? reply.body.left(reply.body.size() / 2) : reply.body);
+
+		if (!keepAlive) {
+			socket->disconnectFromHost();
+			return;
+		}
+
+		connections[socket].busy = false;
+		ProcessBuffer(socket);
+	}
+
+	void OpenEventStream(QTcpSocket *socket)
+	{
+		qInfo("GET /events -> stream (%d subscriber(s))", static_cast<int>(subscribers.size()) + 1);
+		statusCounts[200]++;
+		subscribers.insert(socket);
+		// A conexão continua "ocupada": nada mais é lido dela até o cliente desconectar.
+		socket->write("HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\nCache-Control: no-cache\r\n"
+			      "Connection: keep-alive\r\n\r\n");
+		socket->write("retry: 2000\n\n");
+	}
+
+	void BroadcastChange(const QByteArray &reason)
+	{
+		if (subscribers.isEmpty())
+			return;
+
+		QJsonObject data;
+		data["reason"] = QString::fromLatin1(reason);
+		data["total"] = static_cast<int>(queue.size());
+		QByteArray event = "id: " + QByteArray::number(++eventId) + "\nevent: queue\ndata: " +
+				   QJsonDocument(data).toJson(QJsonDocument::Compact) + "\n\n";
+		for (QTcpSocket *subscriber : std::as_const(subscribers))
+			subscriber->write(event);
+	}
+
+	static QByteArray RoutePattern(const QByteArray &path)
+	{
+		QList<QByteArray> parts = path.split('/');
+		// /1/song_requests/queue/<id>[/promote]
+		if (parts.size() >= 5 && parts.at(3) == "queue" && parts.at(4) != "play" && parts.at(4) != "pause" &&
+		    parts.at(4) != "skip")
+			parts[4] = ":id";
+		return parts.join('/');
+	}
+
+	bool IsAuthorized(const MockRequest &request)
+	{
+		QByteArray auth = request.headers.value("authorization");
+		if (!auth.startsWith("Bearer ") || auth.size() <= 7)
+			return false;
+
+		if (tokenTtl > 0 && QDateTime::currentSecsSinceEpoch() - tokenIssuedAt > tokenTtl)
+			return false;
+
+		// Antes do primeiro refresh aceita qualquer token; depois, só o emitido por último.
+		return accessToken.isEmpty() || auth.mid(7) == accessToken.toUtf8();
+	}
+
+	MockSong MakeSong(const QString &title, const QString &user)
+	{
+		MockSong song;
+		song.id = QStringLiteral("mock%1").arg(nextId++, 6, 10, QLatin1Char('0'));
+		song.title = title;
+		song.artist = QStringLiteral("Mock Artist");
+		song.user = user;
+		song.providerId = QStringLiteral("dQw4w9WgXc%1").arg(nextId % 10);
+		song.duration = 150 + QRandomGenerator::global()->bounded(180);
+		song.createdAt = QDateTime::currentMSecsSinceEpoch();
+		return song;
+	}
+
+	static QJsonObject SongJson(const MockSong &song, int position)
+	{
+		QJsonObject track;
+		track["providerId"] = song.providerId;
+		track["provider"] = "youtube";
+		track["duration"] = song.duration;
+		track["title"] = song.title;
+		track["artist"] = song.artist;
+		track["url"] = "https://youtu.be/" + song.providerId;
+
+		QJsonObject user;
+		user["name"] = song.user.toLower();
+		user["displayName"] = song.user;
+		user["provider"] = "twitch";
+		user["providerId"] = song.user.toLower();
+
+		QJsonObject object;
+		object["_id"] = song.id;
+		object["createdAt"] = QDateTime::fromMSecsSinceEpoch(song.createdAt).toString(Qt::ISODate);
+		object["track"] = track;
+		object["user"] = user;
+		object["_position"] = position;
+		return object;
+	}
+
+	QJsonObject QueueJson() const
+	{
+		QJsonArray items;
+		for (qsizetype i = 0; i < queue.size(); ++i)
+			items.append(SongJson(queue.at(i), static_cast<int>(i) + 1));
+
+		QJsonObject root;
+		root["status"] = 200;
+		root["_total"] = static_cast<int>(queue.size());
+		root["_requestsEnabled"] = requestsEnabled;
+		root["_searchProvider"] = "youtube";
+		root["_currentSong"] = current ? QJsonValue(SongJson(*current, 0)) : QJsonValue();
+		root["queue"] = items;
+		return root;
+	}
+
+	QJsonObject StateJson() const
+	{
+		QJsonObject counts;
+		for (auto it = requestCounts.cbegin(); it != requestCounts.cend(); ++it)
+			counts[it.key()] = it.value();
+
+		QJsonObject statuses;
+		for (auto it = statusCounts.cbegin(); it != statusCounts.cend(); ++it)
+			statuses[QString::number(it.key())] = it.value();
+
+		QJsonObject root = QueueJson();
+		root["playing"] = playing;
+		root["volume"] = volume;
+		root["accessToken"] = accessToken;
+		root["refreshCount"] = refreshCount;
+		root["stalledRequests"] = stalledRequests;
+		root["subscribers"] = static_cast<int>(subscribers.size());
+		root["requests"] = counts;
+		root["statuses"] = statuses;
+		return root;
+	}
+
+	MockReply RouteControl(const MockRequest &request)
+	{
+		QJsonObject body = QJsonDocument::fromJson(request.body).object();
+
+		if (request.path == "/__mock/state")
+			return JsonReply(200, StateJson());
+
+		if (request.path == "/__mock/reset" && request.method == "POST") {
+			queue.clear();
+			current.reset();
+			nextFaults.clear();
+			requestCounts.clear();
+			statusCounts.clear();
+			accessToken.clear();
+			tokenIssuedAt = QDateTime::currentSecsSinceEpoch();
+			requestsEnabled = true;
+			playing = false;
+			volume = 50;
+			BroadcastChange("reset");
+			return JsonReply(200, StateJson());
+		}
+
+		if (request.path == "/__mock/seed" && request.method == "POST") {
+			Seed(body.value("count").toInt(10));
+			BroadcastChange("seed");
+			return JsonReply(200, QueueJson());
+		}
+
+		// Derruba os streams de /events para testar a volta ao polling e a reconexão.
+		if (request.path == "/__mock/events/drop" && request.method == "POST") {
+			const QSet<QTcpSocket *> dropped = subscribers;
+			for (QTcpSocket *subscriber : dropped)
+				subscriber->disconnectFromHost();
+			return JsonReply(200, QJsonObject{{"dropped", static_cast<int>(dropped.size())}});
+		}
+
+		if (request.path == "/__mock/faults" && request.method == "POST") {
+			if (body.contains("latencyMs"))
+				faults.latencyMs = body["latencyMs"].toInt();
+			if (body.contains("jitterMs"))
+				faults.jitterMs = body["jitterMs"].toInt();
+			if (body.contains("errorRate"))
+				faults.errorRate = body["errorRate"].toDouble();
+			if (body.contains("truncateRate"))
+				faults.truncateRate = body["truncateRate"].toDouble();
+			if (body.contains("stallRate"))
+				faults.stallRate = body["stallRate"].toDouble();
+			if (body.contains("errorStatus")) {
+				faults.errorStatus.clear();
+				for (const QJsonValue value : body["errorStatus"].toArray())
+					faults.errorStatus.append(value.toInt());
+			}
+			for (const QJsonValue value : body["next"].toArray())
+				nextFaults.push_back(value.toString().toUtf8());
+			return JsonReply(200, QJsonObject{{"queuedFaults", static_cast<int>(nextFaults.size())}});
+		}
+
+		return ErrorReply(404, "Unknown control endpoint");
+	}
+
+	MockReply Route(const MockRequest &request)
+	{
+		if (request.path.startsWith("/__mock/"))
+			return RouteControl(request);
+
+		if (request.path == "/refresh-token" && request.method == "POST") {
+			QJsonObject body = QJsonDocument::fromJson(request.body).object();
+			if (body["refresh_token"].toString().isEmpty())
+				return ErrorReply(400, "Missing refresh_token");
+
+			refreshCount++;
+			accessToken = QStringLiteral("mock-access-%1").arg(refreshCount);
+			tokenIssuedAt = QDateTime::currentSecsSinceEpoch();
+			QJsonObject reply;
+			reply["access_token"] = accessToken;
+			reply["refresh_token"] = QStringLiteral("mock-refresh-%1").arg(refreshCount);
+			reply["expires_in"] = tokenTtl > 0 ? tokenTtl : 2592000;
+			return JsonReply(200, reply);
+		}
+
+		// Só chega aqui quando o stream foi recusado (token inválido).
+		if (request.path == "/events")
+			return ErrorReply(401, "Unauthorized");
+
+		if (!request.path.startsWith("/1/"))
+			return ErrorReply(404, "Not Found");
+
+		if (!IsAuthorized(request))
+			return ErrorReply(401, "Unauthorized");
+
+		const QByteArray &method = request.method;
+		const QByteArray &path = request.path;
+		QJsonObject body = QJsonDocument::fromJson(request.body).object();
+
+		if (path == "/1/me" && method == "GET") {
+			QJsonObject user;
+			user["_id"] = "mock-user";
+			user["name"] = "mockchannel";
+			user["displayName"] = "Mock Channel";
+			user["provider"] = "twitch";
+			QJsonObject root;
+			root["status"] = 200;
+			root["user"] = user;
+			return JsonReply(200, root);
+		}
+
+		if (path == "/1/song_requests") {
+			if (method == "PUT") {
+				if (body.contains("volume"))
+					volume = std::clamp(body["volume"].toInt(), 0, 100);
+				if (body.contains("enabled"))
+					requestsEnabled = body["enabled"].toBool();
+			} else if (method != "GET") {
+				return ErrorReply(404, "Not Found");
+			}
+
+			QJsonObject settings;
+			settings["enabled"] = requestsEnabled;
+			settings["volume"] = volume;
+			settings["limit"] = 20;
+			settings["userLimit"] = 5;
+			return JsonReply(200, QJsonObject{{"status", 200}, {"settings", settings}});
+		}
+
+		if (path == "/1/song_requests/queue") {
+			if (method == "GET")
+				return JsonReply(200, QueueJson());
+
+			if (method == "POST") {
+				QString query = body["q"].toString().trimmed();
+				if (query.isEmpty())
+					return ErrorReply(400, "You must provide a song query.");
+				if (query.contains("reject", Qt::CaseInsensitive))
+					return ErrorReply(400, "That song was rejected by the mock server.");
+
+				MockSong song = MakeSong(query, "Mock Channel");
+				queue.append(song);
+				if (!current)
+					current = queue.takeFirst();
+				return JsonReply(200, QJsonObject{{"status", 200}, {"item", SongJson(song, static_cast<int>(queue.size()))}});
+			}
+		}
+
+		if (method == "POST" && path == "/1/song_requests/queue/play") {
+			playing = true;
+			return JsonReply(200, QJsonObject{{"status", 200}});
+		}
+
+		if (method == "POST" && path == "/1/song_requests/queue/pause") {
+			playing = false;
+			return JsonReply(200, QJsonObject{{"status", 200}});
+		}
+
+		if (method == "POST" && path == "/1/song_requests/queue/skip") {
+			if (queue.isEmpty())
+				current.reset();
+			else
+				current = queue.takeFirst();
+			return JsonReply(200, QJsonObject{{"status", 200}});
+		}
+
+		QList<QByteArray> parts = path.split('/');
+		if (parts.size() >= 5 && parts.at(3) == "queue") {
+			const QString id = QString::fromUtf8(parts.at(4));
+			qsizetype index = -1;
+			for (qsizetype i = 0; i < queue.size(); ++i) {
+				if (queue.at(i).id == id) {
+					index = i;
+					break;
+				}
+			}
+
+			if (index < 0)
+				return ErrorReply(404, "Song not found in queue.");
+
+			if (method == "DELETE" && parts.size() == 5) {
+				queue.removeAt(index);
+				return JsonReply(200, QJsonObject{{"status", 200}});
+			}
+
+			if (method == "POST" && parts.size() == 6 && parts.at(5) == "promote") {
+				queue.move(index, 0);
+				return JsonReply(200, QJsonObject{{"status", 200}});
+			}
+		}
+
+		return ErrorReply(404, "Not Found");
+	}
+
+	QTcpServer server;
+	QHash<QTcpSocket *, Connection> connections;
+	QSet<QTcpSocket *> subscribers;
+	QTimer heartbeat;
+	int eventId = 0;
+
+	FaultConfig faults;
+	std::deque<QByteArray> nextFaults;
+	int stalledRequests = 0;
+
+	QList<MockSong> queue;
+	std::optional<MockSong> current;
+	bool requestsEnabled = true;
+	bool playing = false;
+	int volume = 50;
+	int nextId = 1;
+
+	int tokenTtl = 0;
+	qint64 tokenIssuedAt = 0;
+	QString accessToken;
+	int refreshCount = 0;
+
+	QMap<QString, int> requestCounts;
+	QMap<int, int> statusCounts;
+};
+
+int main(int argc, char **argv)
+{
+	QCoreApplication app(argc, argv);
+	QCoreApplication::setApplicationName("nightbot-mock-server");
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription("Local stand-in for the Nightbot API with fault injection.");
+	parser.addHelpOption();
+	parser.addOptions({
+		{"port", "Port to listen on (127.0.0.1).", "port", "8930"},
+		{"seed-songs", "Number of songs to put in the queue at start.", "count", "10"},
+		{"latency", "Base response latency in ms.", "ms", "0"},
+		{"jitter", "Random extra latency in ms.", "ms", "0"},
+		{"error-rate", "Probability (0..1) of answering with an error status.", "rate", "0"},
+		{"error-status", "Comma separated statuses used by --error-rate.", "list", "500"},
+		{"truncate-rate", "Probability (0..1) of truncating the response body.", "rate", "0"},
+		{"stall-rate", "Probability (0..1) of never answering.", "rate", "0"},
+		{"token-ttl", "Access token lifetime in seconds (0 = never expires).", "seconds", "0"},
+	});
+	parser.process(app);
+
+	FaultConfig faults;
+	faults.latencyMs = parser.value("latency").toInt();
+	faults.jitterMs = parser.value("jitter").toInt();
+	faults.errorRate = parser.value("error-rate").toDouble();
+	faults.truncateRate = parser.value("truncate-rate").toDouble();
+	faults.stallRate = parser.value("stall-rate").toDouble();
+	faults.errorStatus.clear();
+	for (const QString &status : parser.value("error-status").split(',', Qt::SkipEmptyParts))
+		faults.errorStatus.append(status.trimmed().toInt());
+
+	MockServer server(faults, parser.value("token-ttl").toInt());
+	if (!server.Listen(static_cast<quint16>(parser.value("port").toUInt()))) {
+		qCritical("Failed to listen on port %s.", qPrintable(parser.value("port")));
+		return 1;
+	}
+
+	server.Seed(parser.value("seed-songs").toInt());
+	qInfo("Nightbot mock server listening on http://127.0.0.1:%u", server.Port());
+
+	return app.exec();
+}